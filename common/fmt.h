@@ -0,0 +1,472 @@
+/**----------------------------------------------------------------------------
+ *
+ *            \file fmt.h
+--                                                                           --
+--              ECEN 5803 Mastering Embedded System Architecture             --
+--                  Project 1 Modules 2 to 4                                 --
+--                Microcontroller Firmware, shared                           --
+--                      common/fmt.h                                         --
+--                                                                           --
+-------------------------------------------------------------------------------
+--
+--  Designed for:  University of Colorado at Boulder
+--
+--
+--  Designed by:  Tristan Lennertz, Subhradeep Dutta, & Omkar Prabhu
+--
+-- Version: 2.1
+-- Date of current revision:  2018-02
+-- Target Microcontroller: Freescale MKL25ZVMT4
+-- Tools used:  ARM mbed compiler
+--              ARM mbed SDK
+--              Freescale FRDM-KL25Z Freedom Board
+--
+--
+--   Functional Description:
+--   Type safe formatted output in place of printf, for C++03. Each item is
+--   written with <<, and the conversion is picked by the compiler from the
+--   item's type, so there is no format string to get wrong at run time and
+--   only the conversions a program uses are instantiated. host/fmt_compare
+--   (module4) checks the output against snprintf and times the two.
+--
+--     fmt::Format<Sink> out(sink);
+--     out << "ADC " << count << " at 0x" << fmt::hex << addr << fmt::dec
+--         << ", " << fmt::fixed(2) << volts << " V\r\n";
+--
+--   Integers go to the sink most significant digit first, straight from
+--   the value, with no buffer and no divide: the Cortex-M0+ has no divide
+--   instruction, and a software divide per digit is most of what printf
+--   spends on a number. A 32-bit value is split at 10^8, 10^4 and 100 by
+--   multiplying by their reciprocals, two 32x32->64 multiplies at most,
+--   and each pair of digits at 10 the same way. Only the digits of a
+--   64-bit value above 10^9 are found by subtracting powers of ten.
+--
+--   This is the one copy: module4, ADC_module4, module3 and
+--   module2/accelerometer all include it from common/. It needs no .c
+--   file, so the projects without module4's numfmt.c, which converts into
+--   a caller's buffer for the monitor, can use it as it is.
+--
+--   A Sink is any type with
+--     void put(char c);       one character out
+--     void flush(void);       called once the Format is destroyed
+--   PutcSink<Port> makes one of anything with putc(), an mbed Serial say.
+--
+--   Manipulators:
+--     fmt::hex, fmt::dec      base for the integers after it (default dec)
+--     fmt::width(n)           minimum width of the next item, right aligned
+--     fmt::fill(c)            padding character, ' ' or '0' (default ' ')
+--     fmt::fixed(n)           digits after the point for floating point,
+--                             default FMT_PRECISION as for printf's %f
+--
+--   char prints as a character; every other integer type, unsigned char
+--   included, prints as a number. float is converted in float arithmetic,
+--   so past its 7 significant digits the output can differ from printf's,
+--   which always works in double.
+--
+*/
+
+#ifndef FMT_H
+#define FMT_H
+
+#include <stdint.h>
+
+/**
+ * @brief Digits after the point when no fmt::fixed() is given
+ */
+#ifndef FMT_PRECISION
+#define FMT_PRECISION (6)
+#endif
+
+namespace fmt
+{
+
+struct Base { uint8_t base; };
+struct Width { uint8_t width; };
+struct Fill { char fill; };
+struct Fixed { uint8_t digits; };
+
+static const Base hex = { 16 };
+static const Base dec = { 10 };
+
+inline Width width(uint8_t n) { Width w = { n }; return w; }
+inline Fill fill(char c) { Fill f = { c }; return f; }
+inline Fixed fixed(uint8_t n) { Fixed f = { n }; return f; }
+
+template <typename Sink>
+class Format
+{
+public:
+	explicit Format(Sink & sink)
+		: sink_(sink), base_(10), width_(0), fill_(' '), precision_(FMT_PRECISION)
+	{
+	}
+
+	~Format()
+	{
+		sink_.flush();
+	}
+
+	Format & operator<<(const char * str)
+	{
+		const char * end = str;
+
+		while (*end != '\0')
+			end++;
+
+		pad((uint8_t)(end - str), 0);
+		while (str != end)
+			sink_.put(*str++);
+
+		return *this;
+	}
+
+	Format & operator<<(char c)
+	{
+		pad(1, 0);
+		sink_.put(c);
+		return *this;
+	}
+
+	Format & operator<<(unsigned int v)       { putUnsigned((uint32_t)v, 0); return *this; }
+	Format & operator<<(int v)                { putSigned((int32_t)v); return *this; }
+	Format & operator<<(unsigned short v)     { putUnsigned(v, 0); return *this; }
+	Format & operator<<(short v)              { putSigned(v); return *this; }
+	Format & operator<<(unsigned char v)      { putUnsigned(v, 0); return *this; }
+	Format & operator<<(signed char v)        { putSigned(v); return *this; }
+
+	/* long is 32 bits on the target, 64 on most hosts */
+	Format & operator<<(unsigned long v)
+	{
+		if (sizeof(long) > 4)
+			putUnsigned64((uint64_t)v, 0);
+		else
+			putUnsigned((uint32_t)v, 0);
+		return *this;
+	}
+
+	Format & operator<<(long v)
+	{
+		if (sizeof(long) > 4)
+			putSigned64((int64_t)v);
+		else
+			putSigned((int32_t)v);
+		return *this;
+	}
+
+	Format & operator<<(unsigned long long v) { putUnsigned64(v, 0); return *this; }
+	Format & operator<<(long long v)          { putSigned64(v); return *this; }
+
+	Format & operator<<(float v)              { putFloat(v); return *this; }
+	Format & operator<<(double v)             { putFloat(v); return *this; }
+
+	Format & operator<<(Base b)               { base_ = b.base; return *this; }
+	Format & operator<<(Width w)              { width_ = w.width; return *this; }
+	Format & operator<<(Fill f)               { fill_ = f.fill; return *this; }
+	Format & operator<<(Fixed f)              { precision_ = f.digits; return *this; }
+
+private:
+	/**
+	 * @brief Pads an item of len characters out to the width, then clears
+	 * the width as it only ever applies to one item. With '0' fill the
+	 * sign goes before the padding, as printf puts it.
+	 */
+	void pad(uint8_t len, uint8_t negative)
+	{
+		uint8_t total = len + negative;
+
+		if (negative && fill_ == '0')
+			sink_.put('-');
+
+		while (width_ > total)
+		{
+			sink_.put(fill_);
+			width_--;
+		}
+		width_ = 0;
+
+		if (negative && fill_ != '0')
+			sink_.put('-');
+	}
+
+	void putSigned(int32_t v)
+	{
+		/* Negated unsigned, so the most negative value comes out right */
+		if (v < 0)
+			putUnsigned(0u - (uint32_t)v, 1);
+		else
+			putUnsigned((uint32_t)v, 0);
+	}
+
+	void putSigned64(int64_t v)
+	{
+		if (v < 0)
+			putUnsigned64(0u - (uint64_t)v, 1);
+		else
+			putUnsigned64((uint64_t)v, 0);
+	}
+
+	void putUnsigned(uint32_t v, uint8_t negative)
+	{
+		uint8_t len;
+
+		if (base_ == 16)
+		{
+			len = hexLength(v);
+			pad(len, negative);
+			putHexDigits(v, len);
+			return;
+		}
+
+		len = decimalLength(v);
+		pad(len, negative);
+		putDecimalDigits(v, len);
+	}
+
+	void putUnsigned64(uint64_t v, uint8_t negative)
+	{
+		/* Only values past 32 bits get here, so from 10^9 up */
+		static const uint64_t pow10[20] =
+		{
+			1ull, 10ull, 100ull, 1000ull, 10000ull, 100000ull, 1000000ull,
+			10000000ull, 100000000ull, 1000000000ull, 10000000000ull,
+			100000000000ull, 1000000000000ull, 10000000000000ull,
+			100000000000000ull, 1000000000000000ull, 10000000000000000ull,
+			100000000000000000ull, 1000000000000000000ull,
+			10000000000000000000ull
+		};
+		uint8_t digits = 10;
+		uint8_t high;
+		char d;
+
+		/* Anything that fits 32 bits takes the cheaper path */
+		if ((v >> 32) == 0)
+		{
+			putUnsigned((uint32_t)v, negative);
+			return;
+		}
+
+		if (base_ == 16)
+		{
+			high = hexLength((uint32_t)(v >> 32));
+			pad((uint8_t)(high + 8), negative);
+			putHexDigits((uint32_t)(v >> 32), high);
+			putHexDigits((uint32_t)v, 8);
+			return;
+		}
+
+		while (digits < 20 && v >= pow10[digits])
+			digits++;
+
+		pad(digits, negative);
+
+		/* Digits above 10^9 by subtraction, 11 at most, then the low nine */
+		while (digits-- > 9)
+		{
+			for (d = '0'; v >= pow10[digits]; d++)
+				v -= pow10[digits];
+			sink_.put(d);
+		}
+
+		putDecimalDigits((uint32_t)v, 9);
+	}
+
+	/**
+	 * @brief Number of decimal digits in v, at least one
+	 */
+	static uint8_t decimalLength(uint32_t v)
+	{
+		uint8_t len = 1;
+		uint32_t limit = 10;
+
+		while (len < 10 && v >= limit)
+		{
+			len++;
+			limit *= 10;
+		}
+
+		return len;
+	}
+
+	static uint8_t hexLength(uint32_t v)
+	{
+		uint8_t len = 1;
+
+		while (len < 8 && (v >> (4 * len)) != 0)
+			len++;
+
+		return len;
+	}
+
+	/**
+	 * @brief v as exactly digits decimal digits, zero padded, for
+	 * v < 10^digits. Each split is exact over the range it is used on.
+	 */
+	void putDecimalDigits(uint32_t v, uint8_t digits)
+	{
+		uint32_t high;
+
+		if (digits > 8)
+		{
+			high = (uint32_t)(((uint64_t)v * 2882303762u) >> 58);   /* v / 10^8 */
+			v -= high * 100000000u;
+			putPair(high, (uint8_t)(digits - 8));
+			digits = 8;
+		}
+
+		if (digits > 4)
+		{
+			high = (uint32_t)(((uint64_t)v * 3518437209u) >> 45);   /* v / 10^4 */
+			v -= high * 10000u;
+			putQuad(high, (uint8_t)(digits - 4));
+			digits = 4;
+		}
+
+		putQuad(v, digits);
+	}
+
+	/**
+	 * @brief Up to four digits of v < 10^4
+	 */
+	void putQuad(uint32_t v, uint8_t digits)
+	{
+		uint32_t high;
+
+		if (digits > 2)
+		{
+			high = (v * 5243u) >> 19;                                /* v / 100 */
+			v -= high * 100u;
+			putPair(high, (uint8_t)(digits - 2));
+			digits = 2;
+		}
+
+		putPair(v, digits);
+	}
+
+	/**
+	 * @brief One or two digits of v < 100
+	 */
+	void putPair(uint32_t v, uint8_t digits)
+	{
+		uint32_t tens = (v * 205u) >> 11;                              /* v / 10 */
+
+		if (digits > 1)
+			sink_.put((char)('0' + tens));
+		sink_.put((char)('0' + v - tens * 10u));
+	}
+
+	/**
+	 * @brief v as exactly digits hex digits, upper case
+	 */
+	void putHexDigits(uint32_t v, uint8_t digits)
+	{
+		uint8_t nibble;
+
+		while (digits-- > 0)
+		{
+			nibble = (uint8_t)((v >> (4 * digits)) & 0xF);
+			sink_.put((char)((nibble < 10) ? '0' + nibble : 'A' + nibble - 10));
+		}
+	}
+
+	/**
+	 * @brief Fixed point with precision_ digits after the point, rounded
+	 * half away from zero as printf does
+	 */
+	template <typename F>
+	void putFloat(F v)
+	{
+		uint8_t negative = 0;
+		F half = (F)0.5;
+		F frac;
+		uint32_t whole;
+		uint8_t itemWidth = width_;
+		uint8_t point = (precision_ != 0) ? 1 : 0;
+		uint8_t i;
+		char d;
+
+		if (v != v)
+		{
+			*this << "nan";
+			return;
+		}
+
+		if (v < 0)
+		{
+			negative = 1;
+			v = -v;
+		}
+
+		for (i = 0; i < precision_; i++)
+			half /= 10;
+		v += half;
+
+		if (v >= (F)4294967296.0)
+		{
+			width_ = 0;
+			*this << (negative ? "-ovf" : "ovf");
+			return;
+		}
+
+		whole = (uint32_t)v;
+		frac = v - (F)whole;
+
+		/* The whole part carries the padding for the full item */
+		width_ = (itemWidth > precision_ + point) ? (uint8_t)(itemWidth - precision_ - point) : 0;
+		putDecimal(whole, negative);
+
+		if (point)
+			sink_.put('.');
+		for (i = 0; i < precision_; i++)
+		{
+			frac *= 10;
+			d = (char)frac;
+			frac -= (F)d;
+			sink_.put((char)('0' + d));
+		}
+	}
+
+	/**
+	 * @brief Decimal whatever the current base, for floating point
+	 */
+	void putDecimal(uint32_t v, uint8_t negative)
+	{
+		uint8_t base = base_;
+
+		base_ = 10;
+		putUnsigned(v, negative);
+		base_ = base;
+	}
+
+	Sink & sink_;
+	uint8_t base_;
+	uint8_t width_;
+	char fill_;
+	uint8_t precision_;
+};
+
+/**
+ * @brief Sink for a port with putc(), such as mbed's Serial:
+ *
+ *   fmt::PutcSink<Serial> sink(pc);
+ *   fmt::Format<fmt::PutcSink<Serial> >(sink) << "X: " << x << "\r\n";
+ */
+template <typename Port>
+struct PutcSink
+{
+	explicit PutcSink(Port & p) : port(p) {}
+
+	void put(char c)
+	{
+		port.putc(c);
+	}
+
+	void flush(void)
+	{
+	}
+
+	Port & port;
+};
+
+} /* namespace fmt */
+
+#endif /* FMT_H */
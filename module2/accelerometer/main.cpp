@@ -6,6 +6,7 @@ https://os.mbed.com/users/emilmont/code/MMA8451Q/
 
 #include "mbed.h"
 #include "MMA8451Q.h"
+#include "../../common/fmt.h"   /* no project file to carry an include path */
 
 /*MMA8451Q device address*/
 #define MMA8451_I2C_ADDRESS (0x1d<<1)
@@ -23,11 +24,17 @@ typedef struct
 
 xyz_data xyz_on_off;
 
+/*Serial port to the PC, written with fmt.h*/
+Serial pc(USBTX, USBRX);
+typedef fmt::PutcSink<Serial> pcSink_t;
+typedef fmt::Format<pcSink_t> pcFormat_t;
+pcSink_t pcSink(pc);
+
 int main() 
 {
     
     MMA8451Q acc(SDA, SCL, MMA8451_I2C_ADDRESS);
-    printf("MMA8451 ID: %d\n", acc.getWhoAmI());
+    pcFormat_t(pcSink) << "MMA8451 ID: " << (int)acc.getWhoAmI() << "\n";
     
     while(1)
     {
@@ -35,6 +42,7 @@ int main()
     xyz_on_off.y_acc = abs(acc.getAccY());
     xyz_on_off.z_acc = abs(acc.getAccZ());
     wait(0.5f);//Wait before printing the value
-    printf("\n\rX: %1.1f, Y: %1.1f, Z: %1.1f", xyz_on_off.x_acc, xyz_on_off.y_acc, xyz_on_off.z_acc);
+    pcFormat_t(pcSink) << fmt::fixed(1) << "\n\rX: " << xyz_on_off.x_acc
+                       << ", Y: " << xyz_on_off.y_acc << ", Z: " << xyz_on_off.z_acc;
     }
 }
@@ -54,18 +54,23 @@
 
 #include "mbed.h"
 #include "dhry.h"
+#include "fmt.h"
  
 Timer timer;
 
 Serial pc(USBTX, USBRX);  //serial channel over HDK USB interface
+
+typedef fmt::PutcSink<Serial> pcSink_t;   //formatted output to pc, see fmt.h
+typedef fmt::Format<pcSink_t> pcFormat_t;
+pcSink_t pcSink(pc);
  
 int main() {
     double btime, dps;
-    unsigned long iterations;
+    unsigned long iterations = 0;
     
     pc.baud(9600);
-    pc.printf("DMIPS Calculation Program \r\n");
-    pc.printf("Please Wait for a minute... \r\n");
+    pcFormat_t(pcSink) << "DMIPS Calculation Program \r\n"
+                       << "Please Wait for a minute... \r\n";
     
     timer.start();
         do {
@@ -75,10 +80,15 @@ int main() {
             btime = timer.read();
         } while (btime <= 60.000);
         dps = (double)iterations / btime;
-        printf("Dhrystone time for %ld passes = %.3f sec\r\n", iterations, btime);
-        printf("benchmark is at %0.f dhrystones/second\r\n", dps);
-        printf("DMIPS is: %f\n\r", (dps/1757.0));
-        printf("End of the Program");
+        {
+            pcFormat_t out(pcSink);
+
+            out << "Dhrystone time for " << iterations << " passes = "
+                << fmt::fixed(3) << btime << " sec\r\n";
+            out << "benchmark is at " << fmt::fixed(0) << dps << " dhrystones/second\r\n";
+            out << "DMIPS is: " << fmt::fixed(6) << (dps/1757.0) << "\n\r";
+            out << "End of the Program";
+        }
         wait(1.0);
     
 }
@@ -4,6 +4,7 @@
 #include "mbed.h"
 #include "core_cm0plus.h"
 #include "stdlib.h"
+#include "fmt.h"
 
 #define MSB_16BIT (1 << 15)
 #define TEMP_SENSOR_CHANNEL_INPUT (26)
@@ -11,21 +12,64 @@
 #define J10_4_CHANNEL_INPUT (9)
 #define V_TEMP25 (716)
 
+/*Supply voltage in mV, the full scale of a single ended conversion*/
+#define VDD_MV (3300)
+
+/*Sequencer tick rate, the fastest any channel can be sampled*/
+#define SEQ_TICK_HZ (10000)
+
+/*Number of channels in the scan table*/
+#define SEQ_CHANNEL_COUNT (3)
+
+/*activeChannel value when no conversion is running*/
+#define SEQ_IDLE (0xFF)
+
+/*Scan table indices. Channels due on the same tick convert in this order.*/
+#define ADC_SEQ_VORTEX (0)
+#define ADC_SEQ_VREFSL (1)
+#define ADC_SEQ_TEMP   (2)
+
 
 Serial pc(USBTX, USBRX);
 
-/*Initialize pins to read analog input*/
-AnalogIn analog0(PTB0);//VREFL
-AnalogIn analog1(PTB1);//J10_4
-AnalogIn analog2(PTB2);//Temperature
+/*Formatted output to pc, see fmt.h*/
+typedef fmt::PutcSink<Serial> pcSink_t;
+typedef fmt::Format<pcSink_t> pcFormat_t;
+pcSink_t pcSink(pc);
+
+/*Sequencer tick*/
+Ticker adcTick;
+
+/*One channel of the scan sequence*/
+typedef struct
+{
+	uint8_t adch;              /*ADC0 input channel*/
+	uint16_t periodTicks;      /*sequencer ticks between conversions*/
+	uint16_t countdown;        /*ticks until the next conversion is due*/
+	volatile uint16_t latest;  /*most recent conversion result*/
+	volatile uint32_t samples; /*conversions completed*/
+	volatile uint32_t overruns;/*times it fell due before the last one ran*/
+} ADC_Channel;
+
+/*Scan table: vortex sensor at 10 kHz, VREFSL and temperature at 4 Hz.
+  The slow channels start half a period apart so they never share a tick.*/
+static ADC_Channel adcChannels[SEQ_CHANNEL_COUNT] =
+{
+	{ J10_4_CHANNEL_INPUT,       1,    1,    0, 0, 0 },
+	{ VREFSL_CHANNEL_INPUT,      2500, 1,    0, 0, 0 },
+	{ TEMP_SENSOR_CHANNEL_INPUT, 2500, 1250, 0, 0, 0 },
+};
+
+/*Channels due but not yet started, one bit per scan table index*/
+static volatile uint8_t pendingMask = 0;
+
+/*Channel being converted, or SEQ_IDLE*/
+static volatile uint8_t activeChannel = SEQ_IDLE;
 
-/*Variables to store ADC values*/
-float ADC_val_channel_0, ADC_val_channel_1, ADC_val_channel_2; 
- 
 /****************************************
 Description: This function performs
 			 calibration for the ADC
-			 and returns a value 
+			 and returns a value
 			 indicating if the process
 			 was successful
 
@@ -39,22 +83,22 @@ Output: The function returns 0 if the
 int ADC_Calibrate()
 {
 	uint16_t calibration = 0;
-	
+
 	/*Maximum hardware averaging for better calibration results*/
 	ADC0->SC3 |= (ADC_SC3_AVGE_MASK | ADC_SC3_AVGS_MASK);
-	
+
 	/*Select software trigger for initiating conversion*/
 	ADC0->SC2 &= ~(ADC_SC2_ADTRG_MASK);
-	
+
 	/*Starts the calibration sequence*/
 	ADC0->SC3 |= ADC_SC3_CAL_MASK;
-	
-	/*Wait until COCO is set to indicate the calibration is complete*/
-	while( ADC0->SC1[0] & ADC_SC1_COCO_MASK) ;
-	
+
+	/*Wait until CAL clears itself to indicate the calibration is complete*/
+	while( ADC0->SC3 & ADC_SC3_CAL_MASK) ;
+
 	/*Check the status of calibration by reading CALF mask*/
 	int calibration_failure = (ADC0->SC3 & ADC_SC3_CALF_MASK) >> ADC_SC3_CALF_SHIFT;
-	
+
 	/*Sum the plus side calibration registers*/
 	calibration += ADC0->CLP0;
 	calibration += ADC0->CLP1;
@@ -62,13 +106,13 @@ int ADC_Calibrate()
 	calibration += ADC0->CLP3;
 	calibration += ADC0->CLP4;
 	calibration += ADC0->CLPS;
-	
+
 	/*Divide the calibration variable by 2*/
 	calibration = calibration/2;
-	
+
 	/*Set the MSB for the calibration variable*/
 	calibration |= (MSB_16BIT);
-	
+
 	/*Store the values in plus side gain calibration register*/
 	ADC0->PG = calibration;
 
@@ -83,15 +127,15 @@ int ADC_Calibrate()
 	calibration += ADC0->CLMS;
 	/*Divide the calibration variable by 2*/
 	calibration = calibration/2;
-	
+
 	/*Set the MSB for the calibration variable*/
-	calibration |= (MSB_16BIT);  
+	calibration |= (MSB_16BIT);
 
 	/*Store the values in minus side gain calibration register*/
 	ADC0->MG = calibration;
 
-	/*Clear SC*/
-	ADC0->SC3 &= ~(ADC_SC3_CAL_MASK);
+	/*Clear the calibration failed flag, if set, by writing it*/
+	ADC0->SC3 |= ADC_SC3_CALF_MASK;
 
 	return (calibration_failure);
 }
@@ -99,8 +143,11 @@ int ADC_Calibrate()
 
 /****************************************
 Description: This function initializes the
-			 ADC and checks if the 
-			 calibration was successful
+			 ADC and checks if the
+			 calibration was successful.
+			 It is called once at start up;
+			 the sequencer leaves the
+			 configuration alone afterwards.
 
 Input: N/A
 
@@ -117,108 +164,231 @@ int ADC_Init()
 	/*Enable clock to Port B*/
 	SIM->SCGC5 |= SIM_SCGC5_PORTB_MASK;
 
-	/*PTB0 = ADC0_SE8*/
-	PORTB->PCR[0]=PORT_PCR_MUX(0);
+	/*PTB1 = ADC0_SE9, J10_4*/
+	PORTB->PCR[1] = PORT_PCR_MUX(0);
 
-	/*PTB2 = ADC0SE12*/
-	PORTB->PCR[2]= PORT_PCR_MUX(0);
+	/*Single ended, module disabled (ADCH = 31) until the sequencer starts*/
+	ADC0->SC1[0] = ADC_SC1_ADCH(31);
 
-	/*Enable single ended conversions*/
-	ADC0->SC1[0] &= ~(ADC_SC1_DIFF_MASK);
-
-	ADC0->CFG1 &= ~(ADC_CFG1_ADLPC_MASK);//No low power mode
-
-	ADC0->CFG1 |= ADC_CFG1_ADLSMP_MASK | //Long sample time, clock div = 1
-								ADC_CFG1_MODE(3);		//16 bit conversion, input bus clk 
+	ADC0->CFG1 = ADC_CFG1_ADLSMP_MASK |	//Long sample time, no low power mode
+				 ADC_CFG1_ADIV(1) |		//Bus clk / 2 = 12 MHz, the 16 bit maximum
+				 ADC_CFG1_MODE(3);		//16 bit conversion, input bus clk
 
 	/*Default long sample time*/
-	ADC0->CFG2 |= ADC_CFG2_ADLSTS(0);
-	
-	ADC0->SC3  |= (ADC_SC3_ADCO_MASK | //Continuous Conversion for channel 2
-								 ADC_SC3_AVGE_MASK); //Hardware averaging enabled
-	
-	/* 4 samples averaged*/
-	ADC0->SC3  &= ~(ADC_SC3_AVGS_MASK);
-	
+	ADC0->CFG2 = ADC_CFG2_ADLSTS(0);
+
 	int calibration_status = ADC_Calibrate();
-	
+
+	/*Single conversions, 4 samples hardware averaged, about 15 us each*/
+	ADC0->SC3 = ADC_SC3_AVGE_MASK | ADC_SC3_AVGS(0);
+
 	return (calibration_status);
 }
 
 /****************************************
-Description: This function accepts the 
-			 channel number as input and
-			 performs a read from the ADC
-			 for the corresponding channel
-			 by setting the channel values
-
-Input: ADC channel whose value is to be
-	   read
-
-Output: The function returns the value of
-		the conversion by reading it from
-		the corresponding data register or
-		returns 0 if invalid channel
-		number has been passed
-****************************************/
+Description: Starts a conversion of the
+			 highest priority pending
+			 channel, or marks the ADC
+			 idle if none is pending.
+			 Called from interrupt context
+			 only.
 
+Input: N/A
 
-uint16_t ADC_Read(int channel)
+Output: N/A
+****************************************/
+static void ADC_Seq_StartNext(void)
 {
-	/*Set the channel selection value by configuring the value of ADCH in SC1[0]*/
-	if(channel == 0)
-	{
-		ADC0->SC1[0] &= ~(ADC_SC1_ADCH_MASK); 
-		ADC0->SC1[0] |= ADC_SC1_ADCH(VREFSL_CHANNEL_INPUT);
-	}
-	else if(channel == 1)
+	uint8_t i;
+
+	for (i = 0; i < SEQ_CHANNEL_COUNT; i++)
 	{
-		ADC0->SC1[0] &= ~(ADC_SC1_ADCH_MASK); 
-		ADC0->SC1[0] |= ADC_SC1_ADCH(J10_4_CHANNEL_INPUT);
+		if (pendingMask & (1 << i))
+		{
+			pendingMask &= ~(1 << i);
+			activeChannel = i;
+
+			/*Writing SC1A with software trigger starts the conversion*/
+			ADC0->SC1[0] = ADC_SC1_AIEN_MASK | ADC_SC1_ADCH(adcChannels[i].adch);
+			return;
+		}
 	}
-	else if(channel == 2)
+
+	activeChannel = SEQ_IDLE;
+}
+
+/****************************************
+Description: Sequencer tick, every
+			 1/SEQ_TICK_HZ seconds. Marks
+			 the channels that are due and
+			 starts the ADC if it is idle.
+
+			 The Ticker and ADC0 interrupts
+			 share the default priority and
+			 cannot preempt each other, so
+			 the sequencer state needs no
+			 further protection.
+
+Input: N/A
+
+Output: N/A
+****************************************/
+static void ADC_Seq_Tick(void)
+{
+	uint8_t i;
+
+	for (i = 0; i < SEQ_CHANNEL_COUNT; i++)
 	{
-		ADC0->SC1[0] &= ~(ADC_SC1_ADCH_MASK); 
-		ADC0->SC1[0] |= ADC_SC1_ADCH(TEMP_SENSOR_CHANNEL_INPUT);
+		if (--adcChannels[i].countdown == 0)
+		{
+			adcChannels[i].countdown = adcChannels[i].periodTicks;
+
+			/*Still waiting or converting from last time: count it, don't queue twice*/
+			if ((pendingMask & (1 << i)) || (activeChannel == i))
+				adcChannels[i].overruns++;
+			else
+				pendingMask |= (1 << i);
+		}
 	}
-	else
+
+	if (activeChannel == SEQ_IDLE)
+		ADC_Seq_StartNext();
+}
+
+/****************************************
+Description: ADC0 conversion complete
+			 interrupt. Stores the result
+			 and starts the next pending
+			 channel.
+
+Input: N/A
+
+Output: N/A
+****************************************/
+static void ADC_Seq_Isr(void)
+{
+	/*COCO is cleared automatically after the data register is read*/
+	uint16_t result = ADC0->R[0];
+
+	if (activeChannel < SEQ_CHANNEL_COUNT)
 	{
-		return (0x0000);
+		adcChannels[activeChannel].latest = result;
+		adcChannels[activeChannel].samples++;
 	}
-	
-	/*Block until conversion is complete*/
-	while((ADC0->SC1[0] & ADC_SC1_COCO_MASK)==0);
-	
-	/*COCO is cleared automatically after the respective data register is read*/
-	return (ADC0->R[0]);
+
+	ADC_Seq_StartNext();
+}
+
+/****************************************
+Description: Sets how often a channel is
+			 converted. Rates above the
+			 sequencer tick run every tick.
+
+Input: Scan table index and the rate
+	   in conversions per second
+
+Output: N/A
+****************************************/
+void ADC_Seq_SetRate(uint8_t channel, uint32_t rateHz)
+{
+	uint32_t period;
+
+	if (channel >= SEQ_CHANNEL_COUNT || rateHz == 0)
+		return;
+
+	period = SEQ_TICK_HZ / rateHz;
+	if (period == 0)
+		period = 1;
+	else if (period > 0xFFFF)
+		period = 0xFFFF;
+
+	__disable_irq();
+	adcChannels[channel].periodTicks = period;
+	adcChannels[channel].countdown = period;
+	__enable_irq();
+}
+
+/****************************************
+Description: Starts the background scan.
+			 ADC_Init() must have been
+			 called first.
+
+Input: N/A
+
+Output: N/A
+****************************************/
+void ADC_Seq_Start(void)
+{
+	NVIC_SetVector(ADC0_IRQn, (uint32_t)&ADC_Seq_Isr);
+	NVIC_EnableIRQ(ADC0_IRQn);
+
+	adcTick.attach_us(&ADC_Seq_Tick, 1000000 / SEQ_TICK_HZ);
+}
+
+/****************************************
+Description: Latest conversion result of
+			 a channel. Never blocks.
+
+Input: Scan table index
+
+Output: The 16 bit result, 0 until the
+		first conversion completes
+****************************************/
+uint16_t ADC_Seq_Latest(uint8_t channel)
+{
+	return adcChannels[channel].latest;
+}
+
+/****************************************
+Description: Number of conversions a
+			 channel has completed, for
+			 telling when a new value
+			 has arrived
+
+Input: Scan table index
+
+Output: Conversion count
+****************************************/
+uint32_t ADC_Seq_Count(uint8_t channel)
+{
+	return adcChannels[channel].samples;
 }
 
 
 int main()
 {
-	volatile unsigned int temperature;
-	float temp_val=0;
+	int temperature;
+	float temp_mv;
 	float m;
+	uint32_t lastTempCount = 0;
+	uint32_t tempCount;
+
+	/*Calibrate once, then sample in the background*/
+	if (ADC_Init())
+		pcFormat_t(pcSink) << "ADC calibration failed\n\r";
+
+	ADC_Seq_Start();
+
 	while(1)
-    {     
-		/*Check if calibration was successful*/
-		if(!(ADC_Init()))
-		{
-			temp_val = (ADC_Read(0)/65535);
-			ADC_val_channel_0 = (temp_val);
-			/*Virtual value so conversion is not needed*/
-			ADC_val_channel_1 = ADC_Read(1);
-			temp_val = (ADC_Read(2)/65535);
-			ADC_val_channel_2 = (temp_val);
-		}
+    {
+		/*Report each time a new temperature reading arrives*/
+		tempCount = ADC_Seq_Count(ADC_SEQ_TEMP);
+		if (tempCount == lastTempCount)
+			continue;
+		lastTempCount = tempCount;
+
 		/*Convert ADC value to Celsius based on formula */
-		if ((ADC_val_channel_2 - 0.716)>0) 
+		temp_mv = (ADC_Seq_Latest(ADC_SEQ_TEMP) * (float)VDD_MV) / 65535;
+		if ((temp_mv - V_TEMP25) > 0)
              m = 1.646;
         else m = 1.769;
-        temperature =  25 - (abs(ADC_val_channel_2 - 0.716) / m) ;
-		
-		
+        temperature = (int)(25 - ((temp_mv - V_TEMP25) / m));
+
 		/* Print ADC values to Terminal */
-		pc.printf("%d, %d, %d,  %d\n\r", ADC_val_channel_0, ADC_val_channel_1, ADC_val_channel_2, temperature);
+		pcFormat_t(pcSink) << ADC_Seq_Latest(ADC_SEQ_VREFSL) << ", "
+		                   << ADC_Seq_Latest(ADC_SEQ_VORTEX) << ", "
+		                   << ADC_Seq_Latest(ADC_SEQ_TEMP) << ",  "
+		                   << temperature << ", overruns "
+		                   << adcChannels[ADC_SEQ_VORTEX].overruns << "\n\r";
     }
 }
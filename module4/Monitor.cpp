@@ -30,17 +30,34 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "shared.h"
+#include "pt.h"
+#include "numfmt_bench.h"
 
-/* Function to print ARM registers */
-void printRegs();
+/* Long running output, sent a line per loop pass as the UART takes it */
+#define JOB_NONE    (0)   /* nothing running */
+#define JOB_REGS    (1)   /* R: print the ARM registers */
+#define JOB_STACK   (2)   /* S: print the top 16 words of the stack */
+#define JOB_MEM     (3)   /* M: read an address, print 32 words from it */
+#define JOB_STATUS  (4)   /* DEBUG mode periodic status */
+#define JOB_PROFILE (5)   /* T: execution time profile */
+#define JOB_CAL     (6)   /* C: recalibrate the ADC and report */
+#define JOB_MENU    (7)   /* the mode and command menu */
+#define JOB_BENCH   (8)   /* F: number formatting benchmark */
+#define JOB_TRACE   (9)   /* L: trace log dump, binary frames */
+#define JOB_BANNER  (10)  /* start up banner, then the menu */
+#define JOB_COUNT   (11)
 
-/* Function for collecting hex value from terminal */
-uint32_t collectHex(); 
+/* Function to start a long running command */
+void monitor_job_start(uint8_t kind);
 
-/* Function to print a section of memory */
-void print_mem(uint8_t * start, uint32_t length);
+/* Function to run the current command until it has to wait */
+char monitor_job(void);
+
+/* Function to hand typed characters to a command reading input */
+uint8_t monitor_job_input(void);
 
 /* Forward declaration of register access functions */
 uint32_t read_gpr_0();
@@ -66,34 +83,15 @@ uint8_t my_itoa(int32_t data, uint8_t * ptr, uint32_t base);
 /* Custom ascii-to-integer function for ease of input */
 int32_t my_atoi(uint8_t * ptr, uint32_t base); 
 
-/*******************************************************************************
-* Set Display Mode Function
-* Function determines the correct display mode.  The 3 display modes operate as 
-*   follows:
-*
-*  NORMAL MODE       Outputs only mode and state information changes   
-*                     and calculated outputs
-*
-*  QUIET MODE        No Outputs
-*
-*  DEBUG MODE        Outputs mode and state information, error counts,
-*                    register displays, sensor states, and calculated output
-*
-*
-* There is deliberate delay in switching between modes to allow the RS-232 cable 
-* to be plugged into the header without causing problems. 
-*******************************************************************************/
-void set_display_mode(void)   
+/**
+ * @brief Editing echoes and complaints meant for a person at a terminal.
+ * In BINARY mode the port carries frames for a program, and text would
+ * run into the next record, so they are left out.
+ */
+static void monitor_reply(const char * msg)
 {
-  UART_direct_msg_put("\r\nSelect Mode");
-  UART_direct_msg_put("\r\n Hit NOR - Normal");
-  UART_direct_msg_put("\r\n Hit QUI - Quiet");
-  UART_direct_msg_put("\r\n Hit DEB - Debug" );
-  UART_direct_msg_put("\r\n Hit V - Version #");
-	UART_direct_msg_put("\r\n Hit P - Toggle Auto output in Normal/Debug mode");
-	UART_direct_msg_put("\r\n Hit S - List top 16 words of stack");
-	UART_direct_msg_put("\r\n Hit R - List ARM Registers");
-	UART_direct_msg_put("\r\n Hit M - List 32 word block of memory\r\n");
+	if (display_mode != BINARY)
+		UART_msg_put(msg);
 }
 
 //*****************************************************************************/
@@ -103,18 +101,24 @@ void set_display_mode(void)
 void chk_UART_msg(void)    
 {
    UCHAR j;
+   
+   if (monitor_job_input())   // an M command is reading its address
+      return;
+   
    while( UART_input() )      // becomes true only when a byte has been received
    {                                    // skip if no characters pending
       j = UART_get();                 // get next character
 
       if( j == '\r' )          // on a enter (return) key press
       {                // complete message (all messages end in carriage return)
-        UART_direct_msg_put("\r\n");  
+        if (display_mode != QUIET && display_mode != BINARY)
+          UART_msg_put("\r\n");  
 				UART_msg_process();
       }
       else 
       {
-         if ((j != 0x02) )         // if not ^B
+         if ((j != 0x02) && (display_mode != QUIET) &&
+             (display_mode != BINARY))  // if not ^B, nor in a silent mode
          {                             // if not command, then   
             UART_put(j);              // echo the character   
          }
@@ -127,23 +131,28 @@ void chk_UART_msg(void)
          {                             // backspace editor
             if( msg_buf_idx != 0) 
             {                       // if not 1st character then destructive 
-               UART_msg_put(" \b");// backspace
+               monitor_reply(" \b");// backspace
                msg_buf_idx--;
             }
          }
          else if( msg_buf_idx >= MSG_BUF_SIZE )  
          {                                // check message length too large
-            UART_msg_put("\r\nToo Long!");
+            monitor_reply("\r\nToo Long!");
             msg_buf_idx = 0;
          }
          else if ((display_mode == QUIET) && (msg_buf[0] != 0x02) && 
                   (msg_buf[0] != 'D') && (msg_buf[0] != 'N') && 
                   (msg_buf[0] != 'V') && (msg_buf[0] != 'R') &&
 									(msg_buf[0] != 'S') && (msg_buf[0] != 'M') &&
+									(msg_buf[0] != 'C') && (msg_buf[0] != 'c') &&
+									(msg_buf[0] != 'T') && (msg_buf[0] != 't') &&
+									(msg_buf[0] != 'F') && (msg_buf[0] != 'f') &&
+									(msg_buf[0] != 'L') && (msg_buf[0] != 'l') &&
 				          (msg_buf[0] != 'd') && (msg_buf[0] != 'n') && 
                   (msg_buf[0] != 'v') && (msg_buf[0] != 'r') &&
 									(msg_buf[0] != 's') && (msg_buf[0] != 'm') &&
 				 					(msg_buf[0] != 'p') && (msg_buf[0] != 'P') &&
+									(msg_buf[0] != 'B') && (msg_buf[0] != 'b') &&
                   (msg_buf_idx != 0))
          {                          // if first character is bad in Quiet mode
             msg_buf_idx = 0;        // then start over
@@ -178,7 +187,7 @@ void UART_msg_process(void)
             {
                display_mode = DEBUG;
                UART_msg_put("\r\nMode=DEBUG\n");
-               display_timer = 0;
+               display_restart();
             }
             else
                err = 1;
@@ -189,7 +198,7 @@ void UART_msg_process(void)
             {
                display_mode = NORMAL;
                UART_msg_put("\r\nMode=NORMAL\n");
-               display_timer = 0;
+               display_restart();
             }
             else
                err = 1;
@@ -200,7 +209,19 @@ void UART_msg_process(void)
             {
                display_mode = QUIET;
                UART_msg_put("\r\nMode=QUIET\n");
-               display_timer = 0;
+               display_restart();
+            }
+            else
+               err = 1;
+            break;
+
+         case 'B':
+            if((msg_buf[1] == 'I') && (msg_buf[2] == 'N') && (msg_buf_idx == 3)) 
+            {
+               display_mode = BINARY;
+               UART_msg_put("\r\nMode=BINARY\n");
+               UART_put(0);          // frame delimiter: the text ends here
+               display_restart();
             }
             else
                err = 1;
@@ -211,7 +232,7 @@ void UART_msg_process(void)
             UART_msg_put("\r\n");
             UART_msg_put( CODE_VERSION ); 
             UART_msg_put("\r\nSelect  ");
-            display_timer = 0;
+            display_restart();
             break;
 				 
 				 case 'R':
@@ -221,8 +242,8 @@ void UART_msg_process(void)
 						}
 						else
 						{
-							printRegs();
-							display_timer = 0;
+							monitor_job_start(JOB_REGS);
+							display_restart();
 						}
             break;
 						
@@ -233,9 +254,8 @@ void UART_msg_process(void)
 						}
 						else
 						{
-							UART_direct_msg_put("\r\n*** Top 16 words of Stack ***\r\n"); 
-							print_mem((uint8_t *) read_sp(), 16); 
-							display_timer = 0;
+							monitor_job_start(JOB_STACK);
+							display_restart();
 						}
 						break;
 						
@@ -246,19 +266,47 @@ void UART_msg_process(void)
 						}
 						else
 						{
-							UART_direct_msg_put("\r\nInput memory location in hex: ");
-							uint32_t result = collectHex(); 
-							
-							if (result == 0)
-								UART_direct_msg_put("\r\nInvalid input.\r\n");
-							else
-								print_mem((uint8_t *) result, 32); 
-							
-							
-							display_timer = 0;
+							monitor_job_start(JOB_MEM);
+							display_restart();
+						}
+						break;
+						
+				 case 'T':
+					 /* Available in every mode, for checking a unit in service */
+						monitor_job_start(JOB_PROFILE);
+						display_restart();
+						break;
+						
+				 case 'C':
+					 /* Only recalibrate in debug mode, sampling pauses while it runs */
+						if (display_mode != DEBUG) {
+							err = 2;
+						}
+						else
+						{
+							monitor_job_start(JOB_CAL);
+							display_restart();
+						}
+						break;
+						
+				 case 'F':
+					 /* Only benchmark in debug mode, it holds the loop for a few ms */
+						if (display_mode != DEBUG) {
+							err = 2;
+						}
+						else
+						{
+							monitor_job_start(JOB_BENCH);
+							display_restart();
 						}
 						break;
 						
+				 case 'L':
+					 /* Available in every mode; the frames start after a zero byte */
+						monitor_job_start(JOB_TRACE);
+						display_restart();
+						break;
+						
 				 case 'P':
 						pause_flag = !pause_flag; 
 						break; 
@@ -278,7 +326,7 @@ void UART_msg_process(void)
             {
                display_mode = DEBUG;
                UART_msg_put("\r\nMode=DEBUG\n");
-               display_timer = 0;
+               display_restart();
             }
             else
                err = 1;
@@ -289,7 +337,7 @@ void UART_msg_process(void)
             {
                display_mode = NORMAL;
                UART_msg_put("\r\nMode=NORMAL\n");
-               display_timer = 0;
+               display_restart();
             }
             else
                err = 1;
@@ -300,7 +348,19 @@ void UART_msg_process(void)
             {
                display_mode = QUIET;
                UART_msg_put("\r\nMode=QUIET\n");
-               display_timer = 0;
+               display_restart();
+            }
+            else
+               err = 1;
+            break;
+
+         case 'b':
+            if((msg_buf[1] == 'i') && (msg_buf[2] == 'n') && (msg_buf_idx == 3)) 
+            {
+               display_mode = BINARY;
+               UART_msg_put("\r\nMode=BINARY\n");
+               UART_put(0);          // frame delimiter: the text ends here
+               display_restart();
             }
             else
                err = 1;
@@ -311,7 +371,7 @@ void UART_msg_process(void)
             UART_msg_put("\r\n");
             UART_msg_put( CODE_VERSION ); 
             UART_msg_put("\r\nSelect  ");
-            display_timer = 0;
+            display_restart();
             break;
 				 
 				 case 'r':
@@ -321,8 +381,8 @@ void UART_msg_process(void)
 						}
 						else
 						{
-							printRegs();
-							display_timer = 0;
+							monitor_job_start(JOB_REGS);
+							display_restart();
 						}
             break;
 						
@@ -333,9 +393,8 @@ void UART_msg_process(void)
 						}
 						else
 						{
-							UART_direct_msg_put("\r\n*** Top 16 words of Stack ***\r\n"); 
-							print_mem((uint8_t *) read_sp(), 16); 
-							display_timer = 0;
+							monitor_job_start(JOB_STACK);
+							display_restart();
 						}
             break;
 					
@@ -346,19 +405,46 @@ void UART_msg_process(void)
 						}
 						else
 						{
-							UART_direct_msg_put("\r\nInput memory location in hex: ");
-							uint32_t result = collectHex(); 
-							
-							if (result == 0)
-								UART_direct_msg_put("\r\nInvalid input.\r\n");
-							else
-								print_mem((uint8_t *) result, 32); 
-							
-							
-							display_timer = 0;
+							monitor_job_start(JOB_MEM);
+							display_restart();
 						}
 						break;
 						
+				 case 't':
+					 /* Available in every mode, for checking a unit in service */
+						monitor_job_start(JOB_PROFILE);
+						display_restart();
+						break;
+						
+				 case 'c':
+					 /* Only recalibrate in debug mode, sampling pauses while it runs */
+						if (display_mode != DEBUG) {
+							err = 2;
+						}
+						else
+						{
+							monitor_job_start(JOB_CAL);
+							display_restart();
+						}
+						break;
+						
+				 case 'f':
+					 /* Only benchmark in debug mode, it holds the loop for a few ms */
+						if (display_mode != DEBUG) {
+							err = 2;
+						}
+						else
+						{
+							monitor_job_start(JOB_BENCH);
+							display_restart();
+						}
+						break;
+						
+				 case 'l':
+						monitor_job_start(JOB_TRACE);
+						display_restart();
+						break;
+						
 				 case 'p':
 						pause_flag = !pause_flag; 
 						break; 
@@ -371,11 +457,11 @@ void UART_msg_process(void)
 
    if( err == 1 )
    {
-      UART_msg_put("\n\rError!");
+      monitor_reply("\n\rError!");
    }   
    else if( err == 2 )
    {
-      UART_direct_msg_put("\n\rNot in DEBUG Mode!");
+      monitor_reply("\n\rNot in DEBUG Mode!");
    }   
    
 	 msg_buf_idx = 0;          // put index to start of buffer for next message
@@ -404,13 +490,14 @@ void monitor(void)
 	/**********************************/
 	/*     Spew outputs               */
 	/**********************************/
-	char tempBuff[TX_BUF_SIZE]; 
+	/* A running command or report has the port until it is done */
+	if (PT_RUNNING(monitor_job()))
+		return;
 	
 	switch(display_mode)
 	{
 		case(QUIET):
 			{
-				UART_msg_put("\r\n ");
 				display_flag = 0;
 			}  
 				break;
@@ -421,6 +508,12 @@ void monitor(void)
 			}  
 			break;         
 		
+		case(BINARY):
+			{
+				display_flag = 0;     /* records go out as blocks complete */
+			}  
+			break;         
+		
 		case(NORMAL):
 			{
 				if (display_flag == 1 && !pause_flag)
@@ -450,30 +543,8 @@ void monitor(void)
 			{
 				if (display_flag == 1 && !pause_flag)
 				{
-					UART_msg_put("\r\nDEBUG ");
-					
-					UART_msg_put(" Flow: ");
-					// ECEN 5803 add code as indicated               
-					//  add flow data output here, use UART_hex_put or similar for 
-					// numbers. DONT NEED FOR MODULE 3. 
-					
-					UART_msg_put(" Temp: ");
-					//  add flow data output here, use UART_hex_put or similar for 
-					// numbers. DONT NEED FOR MODULE 3. 
-					
-					UART_msg_put(" Freq: ");
-					UART_msg_put("\r\n");
-					//  add flow data output here, use UART_hex_put or similar for 
-					// numbers. DONT NEED FOR MODULE 3. 
-
-					/* Display ARM Regs */
-					printRegs();
-
-					/* Display Error Count From UART */
-					UART_direct_msg_put("\r\nUART Transmission Error Count:\t"); 
-					my_itoa(error_count, (uint8_t *)tempBuff, 10);
-					UART_direct_msg_put(tempBuff); 
-					UART_direct_msg_put("\r\n"); 
+					/* Streamed out a line at a time, see job_status */
+					monitor_job_start(JOB_STATUS);
 
 					// clear flag from timer0    
 					display_flag = 0;
@@ -489,125 +560,728 @@ void monitor(void)
 	}
 }  
 
-void printRegs()
+/*********************************/
+/*     Long running output       */
+/*********************************/
+
+/**
+ * @brief State of the command or report being sent, kept across loop passes
+ */
+static struct
+{
+	pt_t pt;
+	uint8_t kind;             /* JOB_ value, JOB_NONE when idle */
+	uint8_t collecting;       /* 1 while M is reading its address */
+	uint32_t addr;            /* next word to print */
+	uint8_t words;            /* words to print */
+	uint8_t i, j;
+	uint32_t regs[16];        /* registers as they were when the job started */
+	char input[12];           /* address typed for M */
+	uint8_t inputLen;
+	char line[TX_BUF_SIZE];   /* text waiting for room in the tx ring */
+	uint16_t lineLen;         /* length of line when it holds a binary frame */
+} job;
+
+/**
+ * @brief fmt.h sink building job.line, for a job to send with JOB_SEND.
+ * Anything past the end of the line is dropped.
+ */
+struct JobLineSink
+{
+	JobLineSink(char * line, uint16_t size) : at(line), end(line + size - 1)
+	{
+		*at = '\0';
+	}
+
+	void put(char c)
+	{
+		if (at != end)
+		{
+			*at++ = c;
+			*at = '\0';
+		}
+	}
+
+	void flush(void)
+	{
+	}
+
+	char * at;
+	char * end;
+};
+
+typedef fmt::Format<JobLineSink> jobFormat_t;
+
+/**
+ * @brief Binary telemetry state, see monitor_telemetry()
+ */
+static uint16_t telemSeq = 0;         /* sequence number of the next record */
+static uint8_t telemBlocks = 0;       /* blocks since the last record */
+static uint32_t telemSent = 0;
+static uint32_t telemDropped = 0;
+
+/**
+ * @brief Results of the last F command
+ */
+static cycleStats_t benchStats[NUMFMT_BENCH_COUNT];
+
+static const char * const regNames[16] =
+{
+	"r0", "r1", "r2", "r3", "r4", "r5", "r6", "r7",
+	"r8", "r9", "r10", "r11", "r12", "sp", "lr", "pc"
+};
+
+static const char * const bannerLines[] =
+{
+	"Hello World!\n",
+	"\r\n*************************************\r\r",
+	"\r\nProject by Tristan, Subhradeep, Omkar\r\r",
+	"\r\n*************************************\r\r"
+};
+
+static const char * const menuLines[] =
+{
+	"\r\nSelect Mode",
+	"\r\n Hit NOR - Normal",
+	"\r\n Hit QUI - Quiet",
+	"\r\n Hit DEB - Debug",
+	"\r\n Hit BIN - Binary telemetry, a record per ADC block",
+	"\r\n Hit V - Version #",
+	"\r\n Hit P - Toggle Auto output in Normal/Debug mode",
+	"\r\n Hit S - List top 16 words of stack",
+	"\r\n Hit R - List ARM Registers",
+	"\r\n Hit M - List 32 word block of memory",
+	"\r\n Hit C - Recalibrate ADC and store in flash",
+	"\r\n Hit T - Execution time profile",
+	"\r\n Hit F - Number formatting benchmark",
+	"\r\n Hit L - Send the trace log, binary (host/trace_decode)\r\n"
+};
+
+/**
+ * @brief Line building helpers, each returning the new end of the line
+ */
+static char * job_str(char * out, const char * str)
+{
+	while (*str != '\0')
+		*out++ = *str++;
+	*out = '\0';
+	
+	return out;
+}
+
+static char * job_num(char * out, uint32_t value)
+{
+	return out + fmtU32(value, out);
+}
+
+/**
+ * @brief Appends "a/b/c", the layout of most status lines
+ */
+static char * job_triple(char * out, uint32_t a, uint32_t b, uint32_t c)
+{
+	out = job_num(out, a);
+	out = job_str(out, "/");
+	out = job_num(out, b);
+	out = job_str(out, "/");
+	return job_num(out, c);
+}
+
+/**
+ * @brief Appends a word as 8 hex digits
+ */
+static char * job_hex(char * out, uint32_t value)
+{
+	return out + fmtHex32(value, 8, out);
+}
+
+/**
+ * @brief Builds the line for one captured register
+ */
+static void job_reg_line(uint8_t reg)
+{
+	char * out = job_str(job.line, "\r\n");
+	
+	out = job_str(out, regNames[reg]);
+	out = job_str(out, ":\t");
+	job_hex(out, job.regs[reg]);
+}
+
+static void job_capture_regs(void)
+{
+	job.regs[0] = read_gpr_0();
+	job.regs[1] = read_gpr_1();
+	job.regs[2] = read_gpr_2();
+	job.regs[3] = read_gpr_3();
+	job.regs[4] = read_gpr_4();
+	job.regs[5] = read_gpr_5();
+	job.regs[6] = read_gpr_6();
+	job.regs[7] = read_gpr_7();
+	job.regs[8] = read_gpr_8();
+	job.regs[9] = read_gpr_9();
+	job.regs[10] = read_gpr_10();
+	job.regs[11] = read_gpr_11();
+	job.regs[12] = read_gpr_12();
+	job.regs[13] = read_sp();
+	job.regs[14] = read_lr();
+	job.regs[15] = read_pc();
+}
+
+/**
+ * @brief Queues job.line once the tx ring has room for all of it
+ */
+#define JOB_SEND(pt) PT_WAIT_UNTIL(pt, UART_msg_try(job.line))
+
+/**
+ * @brief R: the registers captured when the command was typed
+ */
+static char job_regs(void)
 {
-	uint32_t temp_reg; 
-	UART_direct_msg_put("\r\n***Register values***");
-	
-	UART_direct_msg_put("\r\nr0:\t");
-	temp_reg = read_gpr_0(); 
-	UART_direct_hex_put(temp_reg >> 24);
-	UART_direct_hex_put((temp_reg >> 16) & 0xFF);
-	UART_direct_hex_put((temp_reg >> 8) & 0xFF);
-	UART_direct_hex_put(temp_reg &0xFF);
-	
-	UART_direct_msg_put("\r\nr1:\t");
-	temp_reg = read_gpr_1(); 
-	UART_direct_hex_put(temp_reg >> 24);
-	UART_direct_hex_put((temp_reg >> 16) & 0xFF);
-	UART_direct_hex_put((temp_reg >> 8) & 0xFF);
-	UART_direct_hex_put(temp_reg &0xFF);
-	
-	UART_direct_msg_put("\r\nr2:\t");
-	temp_reg = read_gpr_2(); 
-	UART_direct_hex_put(temp_reg >> 24);
-	UART_direct_hex_put((temp_reg >> 16) & 0xFF);
-	UART_direct_hex_put((temp_reg >> 8) & 0xFF);
-	UART_direct_hex_put(temp_reg &0xFF);
-	
-	UART_direct_msg_put("\r\nr3:\t");
-	temp_reg = read_gpr_3(); 
-	UART_direct_hex_put(temp_reg >> 24);
-	UART_direct_hex_put((temp_reg >> 16) & 0xFF);
-	UART_direct_hex_put((temp_reg >> 8) & 0xFF);
-	UART_direct_hex_put(temp_reg &0xFF);
-	
-	UART_direct_msg_put("\r\nr4:\t");
-	temp_reg = read_gpr_4(); 
-	UART_direct_hex_put(temp_reg >> 24);
-	UART_direct_hex_put((temp_reg >> 16) & 0xFF);
-	UART_direct_hex_put((temp_reg >> 8) & 0xFF);
-	UART_direct_hex_put(temp_reg &0xFF);
-	
-	UART_direct_msg_put("\r\nr5:\t");
-	temp_reg = read_gpr_5(); 
-	UART_direct_hex_put(temp_reg >> 24);
-	UART_direct_hex_put((temp_reg >> 16) & 0xFF);
-	UART_direct_hex_put((temp_reg >> 8) & 0xFF);
-	UART_direct_hex_put(temp_reg &0xFF);
-	
-	UART_direct_msg_put("\r\nr6:\t");
-	temp_reg = read_gpr_6(); 
-	UART_direct_hex_put(temp_reg >> 24);
-	UART_direct_hex_put((temp_reg >> 16) & 0xFF);
-	UART_direct_hex_put((temp_reg >> 8) & 0xFF);
-	UART_direct_hex_put(temp_reg &0xFF);
-	
-	UART_direct_msg_put("\r\nr7:\t");
-	temp_reg = read_gpr_7(); 
-	UART_direct_hex_put(temp_reg >> 24);
-	UART_direct_hex_put((temp_reg >> 16) & 0xFF);
-	UART_direct_hex_put((temp_reg >> 8) & 0xFF);
-	UART_direct_hex_put(temp_reg &0xFF);
-	
-	UART_direct_msg_put("\r\nr8:\t");
-	temp_reg = read_gpr_8(); 
-	UART_direct_hex_put(temp_reg >> 24);
-	UART_direct_hex_put((temp_reg >> 16) & 0xFF);
-	UART_direct_hex_put((temp_reg >> 8) & 0xFF);
-	UART_direct_hex_put(temp_reg &0xFF);
-	
-	UART_direct_msg_put("\r\nr9:\t");
-	temp_reg = read_gpr_9(); 
-	UART_direct_hex_put(temp_reg >> 24);
-	UART_direct_hex_put((temp_reg >> 16) & 0xFF);
-	UART_direct_hex_put((temp_reg >> 8) & 0xFF);
-	UART_direct_hex_put(temp_reg &0xFF);
-	
-	UART_direct_msg_put("\r\nr10:\t");
-	temp_reg = read_gpr_10(); 
-	UART_direct_hex_put(temp_reg >> 24);
-	UART_direct_hex_put((temp_reg >> 16) & 0xFF);
-	UART_direct_hex_put((temp_reg >> 8) & 0xFF);
-	UART_direct_hex_put(temp_reg &0xFF);
-	
-	UART_direct_msg_put("\r\nr11:\t");
-	temp_reg = read_gpr_11(); 
-	UART_direct_hex_put(temp_reg >> 24);
-	UART_direct_hex_put((temp_reg >> 16) & 0xFF);
-	UART_direct_hex_put((temp_reg >> 8) & 0xFF);
-	UART_direct_hex_put(temp_reg &0xFF);
-	
-	UART_direct_msg_put("\r\nr12:\t");
-	temp_reg = read_gpr_12(); 
-	UART_direct_hex_put(temp_reg >> 24);
-	UART_direct_hex_put((temp_reg >> 16) & 0xFF);
-	UART_direct_hex_put((temp_reg >> 8) & 0xFF);
-	UART_direct_hex_put(temp_reg &0xFF);
-	
-	UART_direct_msg_put("\r\nsp:\t");
-	temp_reg = read_sp(); 
-	UART_direct_hex_put(temp_reg >> 24);
-	UART_direct_hex_put((temp_reg >> 16) & 0xFF);
-	UART_direct_hex_put((temp_reg >> 8) & 0xFF);
-	UART_direct_hex_put(temp_reg &0xFF);
-	
-	UART_direct_msg_put("\r\nlr:\t");
-	temp_reg = read_lr(); 
-	UART_direct_hex_put(temp_reg >> 24);
-	UART_direct_hex_put((temp_reg >> 16) & 0xFF);
-	UART_direct_hex_put((temp_reg >> 8) & 0xFF);
-	UART_direct_hex_put(temp_reg &0xFF);
-	
-	UART_direct_msg_put("\r\npc:\t");
-	temp_reg = read_pc(); 
-	UART_direct_hex_put(temp_reg >> 24);
-	UART_direct_hex_put((temp_reg >> 16) & 0xFF);
-	UART_direct_hex_put((temp_reg >> 8) & 0xFF);
-	UART_direct_hex_put(temp_reg &0xFF);
-	UART_direct_msg_put("\r\n");
+	PT_BEGIN(&job.pt);
+	
+	PT_WAIT_UNTIL(&job.pt, UART_msg_try("\r\n***Register values***"));
+	for (job.i = 0; job.i < 16; job.i++)
+	{
+		job_reg_line(job.i);
+		JOB_SEND(&job.pt);
+	}
+	PT_WAIT_UNTIL(&job.pt, UART_msg_try("\r\n"));
+	
+	PT_END(&job.pt);
+}
+
+/**
+ * @brief S and M: rows of 4 words, each row led by its address. M first
+ * reads the address as it is typed (see monitor_job_input).
+ */
+static char job_dump(void)
+{
+	char * out;
+	
+	PT_BEGIN(&job.pt);
+	
+	if (job.kind == JOB_MEM)
+	{
+		PT_WAIT_UNTIL(&job.pt, UART_msg_try("\r\nInput memory location in hex: "));
+		PT_WAIT_UNTIL(&job.pt, !job.collecting);
+		
+		job.addr = my_atoi((uint8_t *) job.input, 16);
+		if (job.addr == 0)
+		{
+			PT_WAIT_UNTIL(&job.pt, UART_msg_try("\r\nInvalid input.\r\n"));
+			PT_EXIT(&job.pt);
+		}
+		PT_WAIT_UNTIL(&job.pt, UART_msg_try("\r\n"));
+	}
+	else
+	{
+		PT_WAIT_UNTIL(&job.pt, UART_msg_try("\r\n*** Top 16 words of Stack ***\r\n"));
+	}
+	
+#ifdef HOST_SIM
+	/* There is no target memory behind the address in the host simulation,
+	   and read_sp() reports 0 there */
+	PT_WAIT_UNTIL(&job.pt, UART_msg_try("No target memory in the simulation\r\n"));
+	PT_EXIT(&job.pt);
+#endif
+	
+	job.addr &= ~3u;
+	for (job.i = 0; job.i < job.words; job.i++)
+	{
+		out = job.line;
+		if ((job.i & 3) == 0)
+		{
+			if (job.i != 0)
+				out = job_str(out, "\r\n");
+			out = job_hex(out, job.addr);
+			*out++ = ':';
+		}
+		*out++ = ' ';
+		job_hex(out, *(volatile uint32_t *)(uintptr_t) job.addr);
+		JOB_SEND(&job.pt);
+		job.addr += 4;
+	}
+	PT_WAIT_UNTIL(&job.pt, UART_msg_try("\r\n"));
+	
+	PT_END(&job.pt);
+}
+
+/**
+ * @brief DEBUG mode status: registers, UART, estimator, task, event,
+ * idle, timer and ADC figures. Each line is built from the counters as
+ * they are when it is its turn to go out.
+ */
+static char job_status(void)
+{
+	const freqEstimator_t * est = freqActiveEstimator();
+	char * out;
+	
+	PT_BEGIN(&job.pt);
+	
+	PT_WAIT_UNTIL(&job.pt, UART_msg_try("\r\nDEBUG  Flow:  Temp:  Freq: \r\n"));
+	//  add flow data output here, use UART_hex_put or similar for 
+	// numbers. DONT NEED FOR MODULE 3. 
+	
+	/* Display ARM Regs */
+	PT_WAIT_UNTIL(&job.pt, UART_msg_try("\r\n***Register values***"));
+	for (job.i = 0; job.i < 16; job.i++)
+	{
+		job_reg_line(job.i);
+		JOB_SEND(&job.pt);
+	}
+	
+	/* Display Error Count From UART */
+	out = job_str(job.line, "\r\n\r\nUART Transmission Error Count:\t");
+	out = job_num(out, error_count);
+	job_str(out, "\r\n");
+	JOB_SEND(&job.pt);
+	
+	/* Display transmit DMA bursts and bytes lost to a full ring */
+	out = job_str(job.line, "UART DMA bursts/tx/rx dropped:\t");
+	out = job_triple(out, UART_dma_bursts(), tx_ring.dropped(), UART_dma_rx_dropped());
+	job_str(out, "\r\n");
+	JOB_SEND(&job.pt);
+	
+	/* Display frequency estimator cost in core clock cycles */
+	out = job_str(job.line, "Freq estimator ");
+	out = job_str(out, est->name);
+	out = job_str(out, " cycles min/avg/max:\t");
+	out = job_triple(out, est->cycles->min, cycleStatsAverage(est->cycles), est->cycles->max);
+	job_str(out, "\r\n");
+	JOB_SEND(&job.pt);
+	
+	/* Display timer0 task cost against budget */
+	PT_WAIT_UNTIL(&job.pt, UART_msg_try("Task cycles min/avg/max overruns:\r\n"));
+	for (job.i = 0; job.i < schedTaskCount; job.i++)
+	{
+		out = job_str(job.line, "  ");
+		out = job_str(out, schedTasks[job.i].name);
+		out = job_str(out, "\t");
+		out = job_triple(out, schedStats[job.i].min, cycleStatsAverage(&schedStats[job.i]),
+		                 schedStats[job.i].max);
+		out = job_str(out, " ");
+		out = job_num(out, schedOverruns[job.i]);
+		job_str(out, "\r\n");
+		JOB_SEND(&job.pt);
+	}
+	
+	/* Display timer0 to main loop event traffic */
+	out = job_str(job.line, "Events posted/overflowed/coalesced:\t");
+	out = job_triple(out, timer_events.posted, timer_events.overflows, timer_events.coalesced);
+	out = job_str(out, " depth max ");
+	out = job_num(out, timer_events.highWater);
+	out = job_str(out, " latency max ");
+	out = job_num(out, event_latency_max);
+	job_str(out, " ticks\r\n");
+	JOB_SEND(&job.pt);
+	
+	/* Display the time since start up */
+	out = job_str(job.line, "Uptime (s):\t\t\t");
+	out = job_num(out, (uint32_t)(timebaseTicks() / SEC));
+	job_str(out, "\r\n");
+	JOB_SEND(&job.pt);
+	
+	/* Display the share of time the main loop slept */
+	out = job_str(job.line, "Idle (%)/sleeps:\t\t");
+	out += fmtFixed((int32_t)idlePermille(), 1, out);
+	out = job_str(out, "/");
+	out = job_num(out, idleSleepCount());
+	job_str(out, "\r\n");
+	JOB_SEND(&job.pt);
+	
+	/* Display software timer wheel activity */
+	out = job_str(job.line, "Timers armed/fired/cascaded:\t");
+	out = job_triple(out, twArmedCount(), twFiredCount(), twCascadedCount());
+	job_str(out, "\r\n");
+	JOB_SEND(&job.pt);
+	
+	/* Display ADC blocks completed and dropped by a busy loop */
+	out = job_str(job.line, "ADC blocks/dropped/DMA errors:\t");
+	out = job_triple(out, ADC_dma_block_count(), ADC_dma_dropped_blocks(), ADC_dma_error_count());
+	job_str(out, "\r\n");
+	JOB_SEND(&job.pt);
+	
+	/* Display binary telemetry records sent and lost to a full tx ring */
+	out = job_str(job.line, "Telemetry records sent/dropped:\t");
+	out = job_num(out, telemSent);
+	out = job_str(out, "/");
+	out = job_num(out, telemDropped);
+	job_str(out, "\r\n");
+	JOB_SEND(&job.pt);
+	
+	PT_END(&job.pt);
+}
+
+/**
+ * @brief T: execution time of each profiled stage, with its histogram
+ */
+static char job_profile(void)
+{
+	uint32_t cyclesPerUs = SystemCoreClock / 1000000; 
+	const profRecord_t * rec;
+	char * out;
+	
+	/* Locals do not survive a wait, so the record is found again each pass */
+	rec = &profRecords[(job.i < PROF_COUNT) ? job.i : 0];
+	
+	PT_BEGIN(&job.pt);
+	
+	out = job_str(job.line, "\r\n***Execution time, cycles (us)***\r\nTick budget 100 us = ");
+	out = job_num(out, 100 * cyclesPerUs);
+	job_str(out, " cycles\r\n");
+	JOB_SEND(&job.pt);
+	
+	for (job.i = 0; job.i < PROF_COUNT; job.i++)
+	{
+		rec = &profRecords[job.i];
+		out = job_str(job.line, profNames[job.i]);
+		out = job_str(out, " n=");
+		out = job_num(out, rec->stats.count);
+		out = job_str(out, " min/avg/max ");
+		out = job_triple(out, rec->stats.min, cycleStatsAverage(&rec->stats), rec->stats.max);
+		out = job_str(out, " (max ");
+		out = job_num(out, rec->stats.max / cyclesPerUs);
+		job_str(out, " us)\r\n ");
+		JOB_SEND(&job.pt);
+		
+		/* Histogram, non-empty bins only, each labelled by its upper bound */
+		for (job.j = 0; job.j < PROF_HIST_BINS; job.j++)
+		{
+			if (rec->hist[job.j] == 0)
+				continue; 
+			
+			if (profBinLimit(job.j) != 0)
+			{
+				out = job_str(job.line, " <");
+				out = job_num(out, profBinLimit(job.j));
+			}
+			else
+			{
+				out = job_str(job.line, " >=");
+				out = job_num(out, profBinLimit(job.j - 1));
+			}
+			out = job_str(out, ":");
+			job_num(out, rec->hist[job.j]);
+			JOB_SEND(&job.pt);
+		}
+		PT_WAIT_UNTIL(&job.pt, UART_msg_try("\r\n"));
+	}
+	
+	PT_END(&job.pt);
+}
+
+/**
+ * @brief C: the calibration itself still stops sampling while it runs;
+ * only the report is streamed
+ */
+static char job_cal(void)
+{
+	char * out;
+	
+	PT_BEGIN(&job.pt);
+	
+	PT_WAIT_UNTIL(&job.pt, UART_msg_try("\r\nRecalibrating ADC... "));
+	
+	if (ADC_dma_recalibrate() == ADC_CAL_CALIBRATED)
+		out = job_str(job.line, "stored in flash, ");
+	else
+		out = job_str(job.line, "FAILED, ");
+	out = job_num(out, ADC_cal_last_us());
+	out = job_str(out, " us (calibration alone ");
+	out = job_num(out, ADC_cal_full_us());
+	job_str(out, " us)\r\n");
+	JOB_SEND(&job.pt);
+	
+	PT_END(&job.pt);
 }
 
+/**
+ * @brief The start up banner, then the menu. It goes out as a job like
+ * any report, so start up does not wait on the UART and the first ADC
+ * blocks are not dropped behind it. job.j holds the scheduler error.
+ */
+static char job_banner(void)
+{
+	PT_BEGIN(&job.pt);
+	
+	for (job.i = 0; job.i < sizeof(bannerLines) / sizeof(bannerLines[0]); job.i++)
+		PT_WAIT_UNTIL(&job.pt, UART_msg_try(bannerLines[job.i]));
+	
+	/* A bad task table leaves the offending task and any after it unscheduled */
+	if (job.j != 0)
+	{
+		{
+			JobLineSink sink(job.line, sizeof(job.line));
+			jobFormat_t(sink) << "\r\nScheduler table error at task "
+			                  << (unsigned int)(job.j - 1) << "\r\n";
+		}
+		JOB_SEND(&job.pt);
+	}
+	
+	/* Report how the ADC calibration was obtained and what it cost */
+	{
+		JobLineSink sink(job.line, sizeof(job.line));
+		jobFormat_t(sink) << "\r\nADC calibration "
+		                  << ((ADC_cal_last_result() == ADC_CAL_RESTORED) ? "restored from flash" :
+		                      (ADC_cal_last_result() == ADC_CAL_CALIBRATED) ? "run and stored" : "FAILED")
+		                  << " in " << ADC_cal_last_us() << " us (full calibration "
+		                  << ADC_cal_full_us() << " us)\r\n";
+	}
+	JOB_SEND(&job.pt);
+	
+	PT_WAIT_UNTIL(&job.pt, UART_msg_try("\r\nSystem Reset\r\nCode ver. " CODE_VERSION "\r\n"
+	                                    COPYRIGHT "\r\n"));
+	
+	for (job.i = 0; job.i < sizeof(menuLines) / sizeof(menuLines[0]); job.i++)
+		PT_WAIT_UNTIL(&job.pt, UART_msg_try(menuLines[job.i]));
+	
+	PT_END(&job.pt);
+}
+
+static char job_menu(void)
+{
+	PT_BEGIN(&job.pt);
+	
+	for (job.i = 0; job.i < sizeof(menuLines) / sizeof(menuLines[0]); job.i++)
+		PT_WAIT_UNTIL(&job.pt, UART_msg_try(menuLines[job.i]));
+	
+	PT_END(&job.pt);
+}
+
+/**
+ * @brief F: cost of numfmt.c against the my_itoa() it replaced, measured
+ * when the command is typed
+ */
+static char job_bench(void)
+{
+	const cycleStats_t * st;
+	char * out;
+	
+	PT_BEGIN(&job.pt);
+	
+	job.j = numfmtBench(benchStats);
+	PT_WAIT_UNTIL(&job.pt, UART_msg_try("\r\nNumber formatting, cycles per call min/avg/max:\r\n"));
+	
+	for (job.i = 0; job.i < NUMFMT_BENCH_COUNT; job.i++)
+	{
+		st = &benchStats[job.i];
+		out = job_str(job.line, "  ");
+		out = job_str(out, numfmtBenchNames[job.i]);
+		out = job_str(out, "\t");
+		out = job_triple(out, st->min, cycleStatsAverage(st), st->max);
+		job_str(out, "\r\n");
+		JOB_SEND(&job.pt);
+	}
+	
+	out = job_str(job.line, "Old/new results differing:\t");
+	out = job_num(out, job.j);
+	job_str(out, "\r\n");
+	JOB_SEND(&job.pt);
+	
+	PT_END(&job.pt);
+}
+
+/**
+ * @brief L: the trace log as frames (trace.h), the info frame then the
+ * records oldest first. The ring stays frozen until the last frame is
+ * queued, so it cannot move under the dump; events in the meantime are
+ * counted as missed.
+ */
+static char job_trace(void)
+{
+	static const UCHAR delimiter = 0;
+	uint8_t * frame = (uint8_t *)job.line;
+	uint32_t left;
+	
+	PT_BEGIN(&job.pt);
+	
+	traceFreeze(1);
+	job.lineLen = traceFrameInfo(cycleCountRead(), timebaseUs(), frame);
+	
+	/* Ends any text before it, so the first frame arrives whole */
+	PT_WAIT_UNTIL(&job.pt, UART_block_try(&delimiter, 1));
+	PT_WAIT_UNTIL(&job.pt, UART_block_try(frame, job.lineLen));
+	
+	job.addr = (traceLog.head > TRACE_RECORDS) ? traceLog.head - TRACE_RECORDS : 0;
+	while (job.addr != traceLog.head)
+	{
+		left = traceLog.head - job.addr;
+		job.j = (left > TRACE_FRAME_RECORDS) ? TRACE_FRAME_RECORDS : (uint8_t)left;
+		job.lineLen = traceFrameRecords(job.addr, job.j, frame);
+		PT_WAIT_UNTIL(&job.pt, UART_block_try(frame, job.lineLen));
+		job.addr += job.j;
+	}
+	
+	traceFreeze(0);
+	
+	PT_END(&job.pt);
+}
+
+/**
+ * @brief Protothread for each job kind
+ */
+static char (* const jobFns[JOB_COUNT])(void) =
+{
+	NULL, job_regs, job_dump, job_dump, job_status, job_profile, job_cal, job_menu,
+	job_bench, job_trace, job_banner
+};
+
+void monitor_job_start(uint8_t kind)
+{
+	if (job.kind != JOB_NONE)
+	{
+		monitor_reply("\r\nBusy, try again\r\n");
+		return;
+	}
+	
+	job.kind = kind;
+	PT_INIT(&job.pt);
+	
+	if (kind == JOB_REGS || kind == JOB_STATUS)
+		job_capture_regs();
+	else if (kind == JOB_STACK)
+	{
+		job.addr = read_sp();
+		job.words = 16;
+	}
+	else if (kind == JOB_MEM)
+	{
+		job.collecting = 1;
+		job.inputLen = 0;
+		job.words = 32;
+	}
+}
+
+/**
+ * @brief Queues the start up banner and menu, sent while the loop runs
+ *
+ * @param schedError sched_init()'s result, 0 if the task table is good
+ */
+void monitor_banner(uint8_t schedError)
+{
+	monitor_job_start(JOB_BANNER);
+	job.j = schedError;
+}
+
+/**
+ * @brief Takes the characters typed while M is reading its address. Runs
+ * in place of the normal command parser until return is hit.
+ *
+ * @return 1 if the characters were taken
+ */
+uint8_t monitor_job_input(void)
+{
+	UCHAR c;
+	
+	if (!job.collecting)
+		return 0;
+	
+	while (job.collecting && UART_input())
+	{
+		c = UART_get();
+		
+		if (c == '\r')
+		{
+			job.input[job.inputLen] = '\0';
+			job.collecting = 0;
+		}
+		else if (job.inputLen < sizeof(job.input) - 1)
+		{
+			job.input[job.inputLen++] = c;
+			UART_put(c);
+		}
+	}
+	
+	return 1;
+}
+
+/**
+ * @brief Runs the current job until it has to wait for room in the tx
+ * ring, called every monitor() pass. Each wait hands the loop back, so
+ * sampling and the frequency estimate keep running while a report of any
+ * length trickles out or the user types.
+ *
+ * @return PT_EXITED or PT_ENDED when no job is left running
+ */
+char monitor_job(void)
+{
+	char result;
+	
+	if (job.kind == JOB_NONE)
+		return PT_EXITED;
+	
+	result = jobFns[job.kind]();
+	if (!PT_RUNNING(result))
+	{
+		/* A report asked for in BINARY mode ends like the BIN reply, so
+		   the next record frames cleanly */
+		if (display_mode == BINARY && job.kind != JOB_TRACE)
+			UART_put(0);
+		job.kind = JOB_NONE;
+	}
+	
+	return result;
+}
+
+/*********************************/
+/*     Binary telemetry          */
+/*********************************/
+
+/**
+ * @brief Sends the sample record for an ADC block in BINARY mode, called
+ * by the main loop before it releases the block. The frame goes into the
+ * tx ring whole or not at all: a record that does not fit is dropped and
+ * counted, and its sequence number skipped, so the receiver sees the gap
+ * and newer data is never held up behind it. Records are skipped the same
+ * way while a text report (T, C...) is going out, as they would split its
+ * lines and be lost to them anyway.
+ */
+void monitor_telemetry(const uint16_t * block, uint16_t count, uint32_t freqHz,
+                       float flow, float temp)
+{
+	telemSample_t rec;
+	uint8_t frame[TELEM_FRAME_MAX];
+	uint32_t sum = 0;
+	uint16_t lo = 0xFFFF;
+	uint16_t hi = 0;
+	uint16_t i;
+	
+	if (++telemBlocks < TELEM_BLOCKS_PER_RECORD)
+		return;
+	telemBlocks = 0;
+	
+	if (job.kind != JOB_NONE && job.kind != JOB_TRACE)
+	{
+		telemSeq++;
+		telemDropped++;
+		return;
+	}
+	
+	for (i = 0; i < count; i++)
+	{
+		if (block[i] < lo)
+			lo = block[i];
+		if (block[i] > hi)
+			hi = block[i];
+		sum += block[i];
+	}
+	
+	rec.seq = telemSeq++;
+	rec.timeUs = timebaseUs();
+	rec.freqHz = freqHz;
+	rec.flow = flow;
+	rec.temp = temp;
+	rec.adcMin = lo;
+	rec.adcMax = hi;
+	rec.adcMean = (uint16_t)(sum / count);
+	
+	if (UART_block_try(frame, telemFrameSample(&rec, frame)))
+		telemSent++;
+	else
+		telemDropped++;
+}
+
+#ifdef __CC_ARM
+
 __asm uint32_t read_gpr_0()
 {
 	BX    lr
@@ -711,102 +1385,66 @@ __asm uint32_t read_pc()
 	BX    lr
 }
 
+#else
+
+/* Register access needs the ARM compiler's embedded assembler; other
+   builds (the host simulation) report zeros */
+uint32_t read_gpr_0() { return 0; }
+uint32_t read_gpr_1() { return 0; }
+uint32_t read_gpr_2() { return 0; }
+uint32_t read_gpr_3() { return 0; }
+uint32_t read_gpr_4() { return 0; }
+uint32_t read_gpr_5() { return 0; }
+uint32_t read_gpr_6() { return 0; }
+uint32_t read_gpr_7() { return 0; }
+uint32_t read_gpr_8() { return 0; }
+uint32_t read_gpr_9() { return 0; }
+uint32_t read_gpr_10() { return 0; }
+uint32_t read_gpr_11() { return 0; }
+uint32_t read_gpr_12() { return 0; }
+uint32_t read_sp() { return 0; }
+uint32_t read_lr() { return 0; }
+uint32_t read_pc() { return 0; }
+
+#endif /* __CC_ARM */
+
 /* Helper function declarations */
-int64_t toPower(uint32_t base, uint8_t exponent);
-uint8_t digitLookup(int32_t val);
 int32_t multipleLookup(uint8_t digit);
 
+/**
+ * @brief Converts data to a string in any base from 2 to 16, negative
+ * numbers as a sign and magnitude. The work is done by numfmt.c.
+ * @return Length written including the NUL, or 0 if ptr is NULL or the
+ * base is not supported
+ */
 uint8_t my_itoa(int32_t data, uint8_t * ptr, uint32_t base)
 {
-  /* Intermediate string buffer and associated values for building conversion */
-  uint8_t strBuff[TX_BUF_SIZE];
-  uint8_t * strPtr = strBuff; 
-  uint8_t strLen = 0; 
+  uint32_t magnitude = (uint32_t)data;
+  uint8_t strLen = 0;
   
-  /* Ensure the base is within the supported range */
-  if (base >= 2 && base <= 16)
-  {
-    /* One-time check for negative */ 
-    if (data < 0)
-    {
-      /* Insert negative before digits in string, work with data as
-       * a positive for the remaining parts of the algorithm
-       */
-      *strPtr++ = '-'; 
-      strLen++; 
-      data *= -1;
-    }
-    
-    /* Zero is breaking corner case for algorithm, deal with it specially */ 
-    if (data == 0)
-    {
-      *strPtr++ = '0';
-      strLen++; 
-    }
-    else
-    {
-      uint8_t valMagnitude = 0;
-      
-      /* determine the highest power of the base that the data 
-       * contains a multiple of. 
-       */
-      while ((data / toPower(base, valMagnitude)) > 0)
-        valMagnitude++; 
-      
-      /* Deaccumulate the data from the highest power multiple to the 
-       * lowest. Each power's multiple is a digit in the string.
-       */
-      while (valMagnitude-- > 0)
-      {
-        int32_t currMultiple, currPower;
-        
-        /* Multiple calculation and deaccumulation */
-        currPower = (uint32_t) toPower(base, valMagnitude);
-        currMultiple = data / currPower; 
-        data -= currMultiple * currPower;
-        
-        /* Multiple digit lookup and write to conversion string */
-        *strPtr++ = digitLookup(currMultiple);
-        strLen++; 
-      }
-    }
-  }
+  if (ptr == NULL || base < 2 || base > 16)
+    return 0;
   
-  /* Copy the converted string to the receiving buffer, if possible. If the
-   * receiving ptr is NULL, then conversion fails and returns a converted string
-   * length of zero.
-   */
-  if (ptr != NULL && strLen > 0)
-  {
-    size_t ndx; 
-    
-    /* Copy intermediate conversion string to receiving string buffer */
-    for (ndx = 0; ndx < strLen; ndx++)
-    {
-      *ptr++ = *(strBuff + ndx); 
-    }
-    
-    /* Last step is to insert NULL */
-    *ptr = '\0';
-    strLen++; 
-  }
-  else
+  if (data < 0)
   {
-    strLen = 0; 
+    *ptr++ = '-';
+    strLen++;
+    magnitude = 0u - magnitude;
   }
   
-  return strLen; 
+  strLen += fmtBase(magnitude, (uint8_t)base, (char *)ptr);
+  
+  /* Count the NUL, as callers expect */
+  return strLen + 1;
 }
 
 int32_t my_atoi(uint8_t * ptr, uint32_t base)
 {
-  int32_t iAccum = 0; 
+  uint32_t uAccum = 0; 
   uint8_t negFlag = 0;
   
   if (ptr != NULL)
   {
-    uint8_t numDigits, * tmpPtr; 
-    
     /* One-time negative check. Need to raise flag and progress ptr if so */
     if (*ptr == '-')
     {
@@ -814,145 +1452,30 @@ int32_t my_atoi(uint8_t * ptr, uint32_t base)
       ptr++; 
     }
     
-    /* Determine the number of digits in the string */ 
-    tmpPtr = ptr; 
-    numDigits = 0; 
-    while (*tmpPtr++)
-      numDigits++; 
-    
-    /* Accumulate the multiples of each magnitude each digit represents.
-     * Digits descend from highest magnitude to lowest, and are the multiple
-     * multiple of that particular magnitude in the number
+    /* Each digit shifts the total so far up one place and is added in, so
+     * no powers of the base are needed
      */
-    while (numDigits-- > 0)
+    while (*ptr)
     {
-      int32_t currMultiple, currPower; 
+      int32_t currMultiple; 
       
       /* Lookup the integer representation of the current digit and ensure it
        * conforms with passed base 
        */
       currMultiple = multipleLookup(*ptr++);
-      if (currMultiple >= base || currMultiple < 0)
+      if (currMultiple >= (int32_t)base || currMultiple < 0)
       {
         /* Illegal digit for base. Return 0 result as error indicator */
-        iAccum = 0;
+        uAccum = 0;
         break; 
       }
       
-      /* Calculate current power and add its multiple to the running total */
-      currPower = (int32_t) toPower(base, numDigits); 
-      iAccum += currMultiple * currPower; 
+      uAccum = uAccum * base + (uint32_t)currMultiple; 
     }
   }
   
   /* Apply negative to accumulated value if applicable */
-  iAccum = negFlag ? iAccum * -1 : iAccum; 
-  
-  return iAccum; 
-}
-
-/**
- * @brief Calculates the (signed) value of base raised to the exponent power. 
- * 64-bit return value used because the itoa algorithm probes above the 32-bit
- * boundary, and would cause a floating point overflow without a 64-bit value. 
- * @param base      The base value to be raised to a certain power. 
- * @param exponent  The exponent for the base value. 
- * @return          The calculated value of base raised to the exponent.
- */ 
-int64_t toPower(uint32_t base, uint8_t exponent)
-{
-  int64_t accum = 1; 
-  size_t i; 
-  
-  for (i = 0; i < exponent; i++)
-  {
-    accum *= base; 
-  }
-  
-  return accum; 
-}
-
-/**
- * @brief Returns ascii digit representation of passed value. 
- * Values between 0-15 are supported. Any others will return a null character. 
- * @param val Value of the desired digit.  
- * @return    Digit representing the passed value. 
- */ 
-uint8_t digitLookup(int32_t val)
-{
-  uint8_t retVal = '\0'; 
-  
-  switch (val)
-  {
-    case 0:
-      retVal = '0'; 
-      break; 
-    
-    case 1:
-      retVal = '1';
-      break; 
-      
-    case 2:
-      retVal = '2'; 
-      break; 
-      
-    case 3:
-      retVal = '3';
-      break;
-      
-    case 4:
-      retVal = '4';
-      break; 
-      
-    case 5:
-      retVal = '5';
-      break; 
-      
-    case 6:
-      retVal = '6';
-      break; 
-      
-    case 7:
-      retVal = '7';
-      break; 
-      
-    case 8:
-      retVal = '8';
-      break; 
-      
-    case 9:
-      retVal = '9';
-      break; 
-      
-    case 10:
-      retVal = 'A'; 
-      break; 
-      
-    case 11:
-      retVal = 'B';
-      break; 
-      
-    case 12:
-      retVal = 'C'; 
-      break; 
-      
-    case 13:
-      retVal = 'D'; 
-      break; 
-      
-    case 14:
-      retVal = 'E';
-      break; 
-      
-    case 15:
-      retVal = 'F'; 
-      break; 
-      
-    default:
-      break; 
-  }
-  
-  return retVal; 
+  return negFlag ? (int32_t)(0u - uAccum) : (int32_t)uAccum; 
 }
 
 /**
@@ -1045,60 +1568,3 @@ int32_t multipleLookup(uint8_t digit)
   return retVal; 
 }
 
-void print_mem(uint8_t * start, uint32_t length)
-{
-  uint32_t i, j, temp_val; 
- 
-  i = 0; 
-  while (i < length) 
-  {
-		temp_val = (uint32_t)start; 
-		
-    /* Row start index print */  
-		UART_direct_hex_put(temp_val >> 24);
-		UART_direct_hex_put((temp_val >> 16) & 0xFF);
-		UART_direct_hex_put((temp_val >> 8) & 0xFF);
-		UART_direct_hex_put(temp_val & 0xFF);
-    UART_direct_msg_put(":");
-    
-    /* Print DBG_ROW_WIDTH bytes, or the remaining number of bytes */
-    for (j = 0; j < 4 && i < length; j++, i++)
-    {
-			UART_direct_msg_put(" ");
-			UART_direct_hex_put(*start >> 24);
-			UART_direct_hex_put((*start >> 16) & 0xFF);
-			UART_direct_hex_put((*start >> 8) & 0xFF);
-			UART_direct_hex_put(*start & 0xFF);
-			
-			start++;
-    }
-    
-    /* End row */
-    UART_direct_msg_put("\r\n");
-  }
-}
-
-uint32_t collectHex()
-{
-	char tempBuff[TX_BUF_SIZE], echoBuff[2]; 
-	char * buffPtr = tempBuff; 
-	
-	/* Fill buffer with user input */
-	do
-	{
-		while(!UART_input())
-			serial();
-		
-		*buffPtr = UART_get(); 
-		
-		/* echo back*/
-		echoBuff[0] = *buffPtr; 
-		echoBuff[1] = '\0'; 
-		UART_direct_msg_put(echoBuff); 
-	} while (*buffPtr++ != '\r' && buffPtr < (tempBuff + TX_BUF_SIZE - 1)); 
-	*(buffPtr - 1) = '\0'; 
-	
-	UART_direct_msg_put("\n");
-	
-	return my_atoi((uint8_t *) tempBuff, 16); 
-}
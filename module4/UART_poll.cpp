@@ -24,14 +24,19 @@
 --               
 -- 
 --  Functional Description:  This file contains routines that support messages
---    to and from the UART port.  Included are:
---       Serial() - a routine to send/receive bytes on the UART port to
---                      the transmit/receive buffers
+--    to and from the UART port.  The bytes themselves are moved between the
+--    buffers and the port by the receive interrupt and transmit DMA in
+--    uart_dma.cpp.  Included are:
+--       Serial() - a routine that restarts transmission if nothing else did
 --       UART_put()  - a routine that puts a character in the transmit buffer
 --       UART_get()  - a routine that gets the next character from the receive
 --                      buffer
 --       UART_msg_put() - a routine that puts a string in the transmit buffer
---       UART_direct_msg_put() - routine that sends a string out the UART port
+--       UART_msg_try() - a routine that puts a string in the transmit buffer
+--                      only if all of it fits
+--       UART_block_try() - the same for binary data, zeros included
+--       UART_direct_msg_put() - routine that sends a string out the UART port,
+--                      for fault reports only
 --       UART_input() - determines if a character has been received 
 --       UART_hex_put() - a routine that puts a hex byte in the transmit buffer        
 --
@@ -45,6 +50,7 @@
 /*  Configurations */
 /*******************/
 #include <stdio.h>
+#include <string.h>
 #include "shared.h"
 #include "MKL25Z4.h"
 
@@ -65,65 +71,11 @@
  UCHAR error_count = 0;
  
 ///  \fn void serial(void) 
-/// function polls the serial port for Rx or Tx data
-void serial(void)       // The serial function polls the serial port for 
-                        // received data or data to transmit
+/// function restarts output the transmit DMA is not already sending
+void serial(void)       // Bytes move under interrupt and DMA (uart_dma.cpp);
+                        // every put already kicks, so this is a safety net
 {
-	/* Deal with errors first */
-	if ( OERR )           // if an overrun error, clear it and continue.
-  {
-		error_count++;         
-
-		/* resets and sets continous receive enable bit */
-		UART0->C2 = UART0->C2 & (!UARTLP_C2_RE_MASK);
-		UART0->C2 = UART0->C2 | UARTLP_C2_RE_MASK;
-  }
-   
-  if ( FERR ) 					// framing error; read bad byte, clear it and continue
-	{       	
-		error_count++;
-
-		RCREG;         		// This will also clear RCIF if only one byte has been 
-											// received since the last int, which is our assumption.
-											// resets and sets continous receive enable bit
-
-		UART0->C2 = UART0->C2 & (!UARTLP_C2_RE_MASK);
-		UART0->C2 = UART0->C2 | UARTLP_C2_RE_MASK;
-  }
-  else              	// else if no frame error,
-  {
-		if ( RCIF )   		// Check if we have received a byte
-		{             		// Read byte to enable reception of more bytes
-											// For PIC, RCIF automatically cleared when RCREG is read
-											// Also true of Freescale KL25Z
-			
-			*rx_in_ptr++ = RCREG;   	// get received character */    
-		
-			if( rx_in_ptr >= RX_BUF_SIZE + rx_buf )
-			{
-				rx_in_ptr = rx_buf;    // if at end of buffer, circles rx_in_ptr 
-															 // to top of buffer
-			} 
-
-		}     
-	}
-   
-	if (TXIF)          //  Check if transmit buffer empty
-	{
-		if ((tx_in_ptr != tx_out_ptr) && (display_mode != QUIET))
-		{
-			TXREG = *tx_out_ptr++;     /* send next char */
-			
-			if( tx_out_ptr >= TX_BUF_SIZE + tx_buf )
-				tx_out_ptr = tx_buf;     /* 0 <= tx_out_idx < TX_BUF_SIZE */        
-			
-			tx_in_progress = YES;      /* flag needed to start up after idle */
-		}
-		else
-		{
-			tx_in_progress = NO;             /* no more to send */
-		}
-	}                   
+	UART_dma_kick();
 	
 	//  serial_count++;         // increment serial counter, for debugging only
 	serial_flag = 1;        // and set flag
@@ -131,10 +83,16 @@ void serial(void)       // The serial function polls the serial port for
 
 /*******************************************************************************
 * The function UART_direct_msg_put puts a null terminated string directly
-* (no ram buffer) to the UART in ASCII format.
+* (no ram buffer) to the UART in ASCII format.  Output already buffered is sent
+* first, and anything buffered meanwhile waits until the string is out.
+* It spins on the port for the whole string, so it is kept for fault and
+* panic reports, where interrupts may be off; everything else is buffered.
 *******************************************************************************/
 void UART_direct_msg_put(const char *str)
 {
+	UART_dma_flush();                 /* buffered output goes out first */
+	UART_dma_hold(1);
+	
 	while( *str != '\0' )
 	{
 		TXREG = *str++;
@@ -145,83 +103,120 @@ void UART_direct_msg_put(const char *str)
 			;
 		}
 	}
+	
+	UART_dma_hold(0);
 }
 
 /*******************************************************************************
-* The function UART_put puts a byte, to the transmit buffer at the location 
-* pointed to by tx_in_idx.  The pointer is incremented circularly as described
-* previously.  If the transmit buffer should wrap around (should be designed 
-* not to happen), data will be lost.  The serial interrupt must be temporarily
-* disabled since it reads tx_in_idx and this routine updates tx_in_idx which is 
-* a 16 bit value.           
+* The function UART_put puts a byte in the transmit ring (tx_ring).  The ring
+* has a single writer for each index, so no interrupt needs disabling.  A byte 
+* that finds the ring full is dropped and counted in tx_ring.dropped().
 *******************************************************************************/
 void UART_put(UCHAR c)
 {
-	__disable_irq(); 
+	tx_ring.push(c);                        /* save character to transmit ring */
 	
-	*tx_in_ptr++ = c;                    		/* save character to transmit buffer */
-
-	if( tx_in_ptr >= TX_BUF_SIZE + tx_buf)
-		tx_in_ptr = tx_buf;                		/* 0 <= tx_in_idx < TX_BUF_SIZE */    
-
-	__enable_irq(); 	
+	UART_dma_kick();                        /* send it if DMA is idle */
 }
 
 /*******************************************************************************
-* The function UART_get gets the next byte if one is available from the receive
-* buffer at the location pointed to by rx_out_idx.  The pointer is circularly 
-* incremented and the byte is returned in R7. Should no byte be available the 
-* function will wait until one is available. There is no need to disable the 
-* serial interrupt which modifies rx_in_idx since the function is looking for a 
-* compare only between rx_in_idx & rx_out_idx.
+* The function UART_get gets the next byte from the receive ring (rx_ring). 
+* Should no byte be available the function will wait until one is available.
+* This could be an infinite loop, but is not because of the UART_input check.
 *******************************************************************************/
 UCHAR UART_get(void)
 {
 	UCHAR c;
 	
-	while( rx_in_ptr == rx_out_ptr )      		// wait for a received character
-		;																				// indicated when pointers are different
-																						// this could be an infinite loop, but 
-																						// is not because of UART_input check   
-	
-	c = *rx_out_ptr++;
-	
-	if( rx_out_ptr >= RX_BUF_SIZE + rx_buf )  // if at end of buffer
-	{
-		rx_out_ptr = rx_buf;                		// 0 <= rx_out_idx < RX_BUF_SIZE */        
-	}																					// return byte from beginning of buffer                                    
-																						// next time.  
+	while( !rx_ring.pop(&c) )               // wait for a received character
+		;
 	
 	return(c);
 }
 
 /*******************************************************************************
 * The function UART_input returns a 1 if 1 or more receive byte(s) is(are) 
-* available and a 0 if the receive buffer rx_buf is empty.  There is no need to 
-* disable the serial interrupt which modifies rx_in_idx since function is 
-* looking for a compare only between rx_in_idx & rx_out_idx.
+* available and a 0 if the receive ring is empty.
 *******************************************************************************/
 UCHAR UART_input(void)
 {
-	if( rx_in_ptr == rx_out_ptr )
+	if( rx_ring.empty() )
 		return(0);                  	/* no characters in receive buffer */
   else
     return(1);                    /* 1 or more receive characters ready */
 }
 
+/*******************************************************************************
+* The function UART_pending returns a 1 while serial() or chk_UART_msg() have 
+* something to do: received bytes not yet processed, or buffered output that 
+* DMA is not sending. The main loop only sleeps when it is 0.  Output DMA is
+* already sending needs nothing from the loop.
+*******************************************************************************/
+UCHAR UART_pending(void)
+{
+	if ( UART_input() )
+		return(1);                    /* receive side needs servicing */
+	
+	if (!tx_ring.empty() && !UART_dma_busy())
+		return(1);                    /* output waiting for a kick */
+	
+	return(0);
+}
+
+/*******************************************************************************
+* The function UART_tx_space returns how many more bytes the transmit ring 
+* can take before output would be dropped.
+*******************************************************************************/
+UCHAR UART_tx_space(void)
+{
+	uint16_t space = tx_ring.space();
+	
+	return (UCHAR)((space > 255) ? 255 : space);
+}
+
 /*******************************************************************************
 * The function UART_msg_put puts a null terminated string through the transmit
-* buffer to the UART port in ASCII format.
+* ring to the UART port in ASCII format.  Whatever does not fit is dropped 
+* and counted, never written over output not yet sent.
 *******************************************************************************/
 void UART_msg_put(const char *str)
 {
-	while( *str != '\0' )
-	{
-		*tx_in_ptr++ = *str++;        					/* save character to transmit buffer */
-		
-		if( tx_in_ptr >= TX_BUF_SIZE + tx_buf)
-			tx_in_ptr = tx_buf;                  	/* 0 <= tx_in_idx < TX_BUF_SIZE */        
-	}   
+	tx_ring.push((const UCHAR *)str, (uint16_t)strlen(str));
+	
+	UART_dma_kick();                          /* send it if DMA is idle */
+}
+
+/*******************************************************************************
+* The function UART_msg_try puts a null terminated string in the transmit ring
+* only if all of it fits, and otherwise leaves the ring untouched.  This is
+* the flow control for long output: a task that gets 0 back keeps its place
+* and tries again on a later pass, so nothing is dropped or cut in half and
+* nothing waits on the UART.  Only the main loop writes to tx_ring, so the
+* space seen here cannot shrink before the push.
+*
+* Returns 1 if the string was queued, 0 if it did not fit.
+*******************************************************************************/
+UCHAR UART_msg_try(const char *str)
+{
+	return UART_block_try((const UCHAR *)str, (uint16_t)strlen(str));
+}
+
+/*******************************************************************************
+* The function UART_block_try puts len bytes in the transmit ring only if all
+* of them fit, as UART_msg_try does for strings.  Used for binary telemetry
+* frames, which must never go out cut short.
+*
+* Returns 1 if the bytes were queued, 0 if they did not fit.
+*******************************************************************************/
+UCHAR UART_block_try(const UCHAR *data, uint16_t len)
+{
+	if (tx_ring.space() < len)
+		return(0);
+	
+	tx_ring.push(data, len);
+	
+	UART_dma_kick();                          /* send it if DMA is idle */
+	return(1);
 }
 
 /*******************************************************************************
@@ -265,6 +260,9 @@ void UART_hex_put(unsigned char c)
 *******************************************************************************/
 void UART_direct_hex_put(unsigned char c)
 {
+	UART_dma_flush();                 /* buffered output goes out first */
+	UART_dma_hold(1);
+	
 	while( TXIF == 0 ) /* Make sure that transmission is possible */
 		;
 	
@@ -277,4 +275,6 @@ void UART_direct_hex_put(unsigned char c)
 	
 	while( TXIF == 0 ) /* Wait for transmission to finish */
 		;
+	
+	UART_dma_hold(0);
 }
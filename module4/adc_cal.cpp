@@ -0,0 +1,423 @@
+/**----------------------------------------------------------------------------
+ *
+ *            \file adc_cal.cpp
+--                                                                           --
+--              ECEN 5803 Mastering Embedded System Architecture             --
+--                  Project 1 Module 4                                       --
+--                Microcontroller Firmware                                   --
+--                      adc_cal.cpp                                          --
+--                                                                           --
+-------------------------------------------------------------------------------
+--
+--  Designed for:  University of Colorado at Boulder
+--
+--
+--  Designed by:  Tristan Lennertz, Subhradeep Dutta, & Omkar Prabhu
+--
+-- Version: 2.1
+-- Date of current revision:  2018-02
+-- Target Microcontroller: Freescale MKL25ZVMT4
+-- Tools used:  ARM mbed compiler
+--              ARM mbed SDK
+--              Freescale FRDM-KL25Z Freedom Board
+--
+--
+--   Functional Description:
+--   Stores the ADC0 calibration in flash so it does not have to be rerun on
+--   every reset.
+--
+--   The record holds every register the hardware calibration produces (OFS,
+--   PG, MG and the CLPx/CLMx values), a CRC-32, and a tag of the supply
+--   voltage and die temperature it was taken at. At boot both are measured
+--   with a couple of quick conversions; if the record is intact and the tag
+--   is within ADC_CAL_VDD_TOL_MV / ADC_CAL_TEMP_TOL_C the registers are
+--   simply written back. Otherwise, or when asked to, the full calibration
+--   runs and the record is rewritten.
+--
+--   mbed does not provide FlashIAP for the KL25Z, so the sector is erased
+--   and programmed through the FTFA command registers. The part has a
+--   single flash block that cannot be read while a command runs, so the
+--   launch-and-wait loop, flashLaunch(), is linked into RAM (section
+--   "ramfunc", see MKL25Z4.sct) and runs with interrupts disabled. That
+--   is up to a few tens of ms for the erase, which is why the record is
+--   only written at boot or on an explicit recalibration.
+--
+--   Timing uses the cycle counter, so cycleCountInit() must have run.
+--
+*/
+
+#include <string.h>
+
+#include "mbed.h"
+#include "cycle_count.h"
+#include "adc_cal.h"
+
+/**
+ * @brief Record identifier, "ADCC"; bump it if the layout changes
+ */
+#define ADC_CAL_MAGIC (0x43434441UL)
+
+/**
+ * @brief Number of calibration registers saved
+ */
+#define ADC_CAL_REG_COUNT (17)
+
+/**
+ * @brief Internal ADC0 inputs used for the tag
+ */
+#define ADC_CH_TEMP    (26)
+#define ADC_CH_BANDGAP (27)
+
+/**
+ * @brief Nominal bandgap voltage, sensor voltage at 25 C and sensor slope
+ * (KL25 datasheet typical values)
+ */
+#define BANDGAP_MV     (1000)
+#define V_TEMP25_MV    (716)
+#define TEMP_SLOPE_UV  (1715)
+
+/**
+ * @brief FTFA flash commands
+ */
+#define FTFA_CMD_PROGRAM_LONGWORD (0x06)
+#define FTFA_CMD_ERASE_SECTOR     (0x09)
+
+/**
+ * @brief Calibration record as stored in flash. A whole number of longwords.
+ */
+typedef struct
+{
+	uint32_t magic;                          /* ADC_CAL_MAGIC */
+	uint16_t vddMv;                          /* supply when calibrated */
+	int16_t tempC;                           /* die temperature when calibrated */
+	uint16_t regs[ADC_CAL_REG_COUNT + 1];    /* calRegs order, last is padding */
+	uint32_t calUs;                          /* time the full calibration took */
+	uint32_t crc;                            /* CRC-32 of everything above */
+} adcCalRecord_t;
+
+/**
+ * @brief Registers written by the hardware calibration, in record order
+ */
+static volatile uint32_t * const calRegs[ADC_CAL_REG_COUNT] =
+{
+	&ADC0->OFS,  &ADC0->PG,   &ADC0->MG,
+	&ADC0->CLPD, &ADC0->CLPS, &ADC0->CLP4, &ADC0->CLP3, &ADC0->CLP2, &ADC0->CLP1, &ADC0->CLP0,
+	&ADC0->CLMD, &ADC0->CLMS, &ADC0->CLM4, &ADC0->CLM3, &ADC0->CLM2, &ADC0->CLM1, &ADC0->CLM0,
+};
+
+/**
+ * @brief Outcome and duration of the last init/calibrate, and the duration
+ * of a full calibration
+ */
+static uint8_t lastResult = ADC_CAL_FAILED;
+static uint32_t lastUs = 0;
+static uint32_t fullUs = 0;
+
+/**
+ * @brief Bitwise CRC-32 (reflected, polynomial 0xEDB88320). Run once per
+ * boot over a few dozen bytes, so no table.
+ */
+static uint32_t crc32(const uint8_t * data, uint32_t length)
+{
+	uint32_t crc = 0xFFFFFFFFUL;
+	uint8_t bit;
+
+	while (length--)
+	{
+		crc ^= *data++;
+		for (bit = 0; bit < 8; bit++)
+			crc = (crc >> 1) ^ (0xEDB88320UL & (0 - (crc & 1)));
+	}
+
+	return ~crc;
+}
+
+/**
+ * @brief Converts a cycle count to microseconds
+ */
+static uint32_t cyclesToUs(uint32_t cycles)
+{
+	return cycles / (SystemCoreClock / 1000000UL);
+}
+
+/**
+ * @brief Launches the command loaded in FCCOB and waits for it to finish.
+ * The section "ramfunc" is placed in RAM by MKL25Z4.sct, and the scatter
+ * loader copies it there at startup with the initialised data. Kept out of
+ * line, and calling nothing, so no instruction it runs is fetched from
+ * flash; FSTAT's address comes in as the argument rather than from a
+ * literal.
+ */
+__attribute__((section("ramfunc"), noinline))
+static void flashLaunch(volatile uint8_t * fstat)
+{
+	*fstat = FTFA_FSTAT_CCIF_MASK;
+	while (!(*fstat & FTFA_FSTAT_CCIF_MASK))
+		;
+}
+
+/**
+ * @brief Runs the flash command loaded in FCCOB
+ *
+ * @return The FSTAT error bits, zero on success
+ */
+static uint8_t flashCommand(void)
+{
+	uint32_t primask = __get_PRIMASK();
+
+	/* Nothing may fetch from flash until the command completes */
+	__disable_irq();
+	flashLaunch(&FTFA->FSTAT);
+	__set_PRIMASK(primask);
+
+	return FTFA->FSTAT & (FTFA_FSTAT_ACCERR_MASK | FTFA_FSTAT_FPVIOL_MASK | FTFA_FSTAT_MGSTAT0_MASK);
+}
+
+/**
+ * @brief Loads the command and flash address into FCCOB0-3, after waiting
+ * for any previous command and clearing its error flags
+ */
+static void flashSetup(uint8_t command, uint32_t addr)
+{
+	while (!(FTFA->FSTAT & FTFA_FSTAT_CCIF_MASK))
+		;
+	FTFA->FSTAT = FTFA_FSTAT_ACCERR_MASK | FTFA_FSTAT_FPVIOL_MASK;
+
+	FTFA->FCCOB0 = command;
+	FTFA->FCCOB1 = (uint8_t)(addr >> 16);
+	FTFA->FCCOB2 = (uint8_t)(addr >> 8);
+	FTFA->FCCOB3 = (uint8_t)addr;
+}
+
+/**
+ * @brief Erases the 1 KB sector containing addr
+ */
+static uint8_t flashEraseSector(uint32_t addr)
+{
+	flashSetup(FTFA_CMD_ERASE_SECTOR, addr);
+	return flashCommand();
+}
+
+/**
+ * @brief Programs one longword at a longword aligned address
+ */
+static uint8_t flashProgramWord(uint32_t addr, uint32_t data)
+{
+	flashSetup(FTFA_CMD_PROGRAM_LONGWORD, addr);
+	FTFA->FCCOB4 = (uint8_t)(data >> 24);
+	FTFA->FCCOB5 = (uint8_t)(data >> 16);
+	FTFA->FCCOB6 = (uint8_t)(data >> 8);
+	FTFA->FCCOB7 = (uint8_t)data;
+	return flashCommand();
+}
+
+/**
+ * @brief Single software triggered conversion, blocking. Only used for the
+ * tag, before sampling starts.
+ */
+static uint16_t ADC_cal_convert(uint8_t channel)
+{
+	ADC0->SC1[0] = ADC_SC1_ADCH(channel);
+	while (!(ADC0->SC1[0] & ADC_SC1_COCO_MASK))
+		;
+	return ADC0->R[0];
+}
+
+/**
+ * @brief Measures the supply voltage from the bandgap and the die
+ * temperature from the internal sensor
+ */
+static void ADC_cal_measure_tag(uint16_t * vddMv, int16_t * tempC)
+{
+	uint16_t bandgap, sensor;
+	int32_t sensorMv;
+
+	/* 16-bit, long sample, 16 sample average at 3 MHz ADCK */
+	ADC0->CFG1 = ADC_CFG1_ADLSMP_MASK | ADC_CFG1_ADIV(3) | ADC_CFG1_MODE(3) | ADC_CFG1_ADICLK(0);
+	ADC0->SC2 = 0;
+	ADC0->SC3 = ADC_SC3_AVGE_MASK | ADC_SC3_AVGS(2);
+
+	PMC->REGSC |= PMC_REGSC_BGBE_MASK;
+	bandgap = ADC_cal_convert(ADC_CH_BANDGAP);
+	sensor = ADC_cal_convert(ADC_CH_TEMP);
+	PMC->REGSC &= ~PMC_REGSC_BGBE_MASK;
+
+	*vddMv = bandgap ? (uint16_t)((BANDGAP_MV * 65535UL) / bandgap) : 0;
+
+	sensorMv = (int32_t)(((uint32_t)sensor * *vddMv) >> 16);
+	*tempC = (int16_t)(25 - ((sensorMv - V_TEMP25_MV) * 1000) / TEMP_SLOPE_UV);
+}
+
+/**
+ * @brief Runs the ADC0 hardware calibration and fills in the register part
+ * of a record
+ *
+ * @return 0 on success, 1 if the calibration failed
+ */
+static uint8_t ADC_cal_hardware(adcCalRecord_t * rec)
+{
+	uint16_t cal;
+	uint8_t i;
+
+	/* Software triggered, 32 sample hardware average, slow ADCK (3 MHz) */
+	ADC0->CFG1 = ADC_CFG1_ADIV(3) | ADC_CFG1_MODE(3) | ADC_CFG1_ADICLK(0);
+	ADC0->SC2 = 0;
+	ADC0->SC3 = ADC_SC3_CAL_MASK | ADC_SC3_AVGE_MASK | ADC_SC3_AVGS(3);
+
+	/* CAL clears itself when the calibration sequence completes */
+	while (ADC0->SC3 & ADC_SC3_CAL_MASK)
+		;
+
+	if (ADC0->SC3 & ADC_SC3_CALF_MASK)
+		return 1;
+
+	cal = ADC0->CLP0 + ADC0->CLP1 + ADC0->CLP2 + ADC0->CLP3 + ADC0->CLP4 + ADC0->CLPS;
+	ADC0->PG = (cal >> 1) | 0x8000;
+
+	cal = ADC0->CLM0 + ADC0->CLM1 + ADC0->CLM2 + ADC0->CLM3 + ADC0->CLM4 + ADC0->CLMS;
+	ADC0->MG = (cal >> 1) | 0x8000;
+
+	for (i = 0; i < ADC_CAL_REG_COUNT; i++)
+		rec->regs[i] = (uint16_t)*calRegs[i];
+	rec->regs[ADC_CAL_REG_COUNT] = 0xFFFF;
+
+	return 0;
+}
+
+/**
+ * @brief Writes a record to the calibration sector and reads it back
+ *
+ * @return 0 on success, 1 if the flash could not be written
+ */
+static uint8_t ADC_cal_store(const adcCalRecord_t * rec)
+{
+	const uint32_t * words = (const uint32_t *)rec;
+	uint8_t i;
+
+	if (flashEraseSector(ADC_CAL_FLASH_ADDR))
+		return 1;
+
+	for (i = 0; i < sizeof(*rec) / sizeof(uint32_t); i++)
+	{
+		if (flashProgramWord(ADC_CAL_FLASH_ADDR + i * sizeof(uint32_t), words[i]))
+			return 1;
+	}
+
+	return memcmp((const void *)ADC_CAL_FLASH_ADDR, rec, sizeof(*rec)) != 0;
+}
+
+/**
+ * @brief Calibrates with an already measured tag and stores the result.
+ * Records the calibration time, tag measurement included, as the cost a
+ * restore saves.
+ */
+static uint8_t ADC_cal_run(uint32_t cycStart, uint16_t vddMv, int16_t tempC)
+{
+	adcCalRecord_t rec;
+
+	if (ADC_cal_hardware(&rec))
+		return ADC_CAL_FAILED;
+
+	fullUs = cyclesToUs(cycleCountElapsed(cycStart, cycleCountRead()));
+
+	rec.magic = ADC_CAL_MAGIC;
+	rec.vddMv = vddMv;
+	rec.tempC = tempC;
+	rec.calUs = fullUs;
+	rec.crc = crc32((const uint8_t *)&rec, sizeof(rec) - sizeof(rec.crc));
+
+	if (ADC_cal_store(&rec))
+		return ADC_CAL_FAILED;
+
+	return ADC_CAL_CALIBRATED;
+}
+
+/**
+ * @brief Brings ADC0 to a calibrated state, from flash when possible
+ *
+ * @return ADC_CAL_RESTORED, ADC_CAL_CALIBRATED or ADC_CAL_FAILED
+ *
+ * @note Leaves the ADC configured for the tag measurement; the caller sets
+ * up its own conversion mode afterwards.
+ */
+uint8_t ADC_cal_init(void)
+{
+	const adcCalRecord_t * rec = (const adcCalRecord_t *)ADC_CAL_FLASH_ADDR;
+	uint32_t cycStart = cycleCountRead();
+	uint16_t vddMv;
+	int16_t tempC;
+	int32_t dVdd, dTemp;
+	uint8_t i;
+
+	ADC_cal_measure_tag(&vddMv, &tempC);
+
+	dVdd = (int32_t)vddMv - rec->vddMv;
+	dTemp = (int32_t)tempC - rec->tempC;
+
+	if (rec->magic == ADC_CAL_MAGIC &&
+	    rec->crc == crc32((const uint8_t *)rec, sizeof(*rec) - sizeof(rec->crc)) &&
+	    dVdd <= ADC_CAL_VDD_TOL_MV && dVdd >= -ADC_CAL_VDD_TOL_MV &&
+	    dTemp <= ADC_CAL_TEMP_TOL_C && dTemp >= -ADC_CAL_TEMP_TOL_C)
+	{
+		for (i = 0; i < ADC_CAL_REG_COUNT; i++)
+			*calRegs[i] = rec->regs[i];
+
+		fullUs = rec->calUs;
+		lastResult = ADC_CAL_RESTORED;
+	}
+	else
+	{
+		lastResult = ADC_cal_run(cycStart, vddMv, tempC);
+	}
+
+	lastUs = cyclesToUs(cycleCountElapsed(cycStart, cycleCountRead()));
+
+	return lastResult;
+}
+
+/**
+ * @brief Runs the full calibration regardless of the stored record and
+ * replaces it
+ *
+ * @return ADC_CAL_CALIBRATED or ADC_CAL_FAILED
+ *
+ * @note ADC0 must not be converting; leaves it configured as ADC_cal_init().
+ */
+uint8_t ADC_cal_calibrate(void)
+{
+	uint32_t cycStart = cycleCountRead();
+	uint16_t vddMv;
+	int16_t tempC;
+
+	ADC_cal_measure_tag(&vddMv, &tempC);
+	lastResult = ADC_cal_run(cycStart, vddMv, tempC);
+	lastUs = cyclesToUs(cycleCountElapsed(cycStart, cycleCountRead()));
+
+	return lastResult;
+}
+
+/**
+ * @brief Outcome of the last ADC_cal_init() or ADC_cal_calibrate()
+ */
+uint8_t ADC_cal_last_result(void)
+{
+	return lastResult;
+}
+
+/**
+ * @brief How long the last ADC_cal_init() or ADC_cal_calibrate() took, in
+ * microseconds, flash writes included
+ */
+uint32_t ADC_cal_last_us(void)
+{
+	return lastUs;
+}
+
+/**
+ * @brief How long a full calibration takes, in microseconds, as measured
+ * when the stored record was made (or just now, if it was rerun)
+ */
+uint32_t ADC_cal_full_us(void)
+{
+	return fullUs;
+}
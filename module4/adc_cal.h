@@ -0,0 +1,73 @@
+/**----------------------------------------------------------------------------
+ *
+ *            \file adc_cal.h
+--                                                                           --
+--              ECEN 5803 Mastering Embedded System Architecture             --
+--                  Project 1 Module 4                                       --
+--                Microcontroller Firmware                                   --
+--                      adc_cal.h                                            --
+--                                                                           --
+-------------------------------------------------------------------------------
+--
+--  Designed for:  University of Colorado at Boulder
+--
+--
+--  Designed by:  Tristan Lennertz, Subhradeep Dutta, & Omkar Prabhu
+--
+-- Version: 2.1
+-- Date of current revision:  2018-02
+-- Target Microcontroller: Freescale MKL25ZVMT4
+-- Tools used:  ARM mbed compiler
+--              ARM mbed SDK
+--              Freescale FRDM-KL25Z Freedom Board
+--
+--
+--   Functional Description:
+--   ADC0 calibration with the results kept in the last flash sector. At
+--   boot the stored calibration registers are restored if the record is
+--   intact and was taken at a similar supply voltage and temperature;
+--   otherwise the full hardware calibration is run and the record
+--   rewritten.
+--
+*/
+
+#ifndef ADC_CAL_H
+#define ADC_CAL_H
+
+#include <stdint.h>
+
+/**
+ * @brief Flash sector holding the calibration record: the last 1 KB sector
+ * of the 128 KB program flash, excluded from the image by the scatter file
+ */
+#define ADC_CAL_FLASH_ADDR (0x0001FC00UL)
+
+/**
+ * @brief Largest supply and temperature change a stored calibration is
+ * trusted across
+ */
+#define ADC_CAL_VDD_TOL_MV (100)
+#define ADC_CAL_TEMP_TOL_C (15)
+
+/**
+ * @brief Outcome of ADC_cal_init() / ADC_cal_calibrate()
+ */
+#define ADC_CAL_RESTORED   (0)   /* registers loaded from flash */
+#define ADC_CAL_CALIBRATED (1)   /* calibration run and stored */
+#define ADC_CAL_FAILED     (2)   /* calibration or flash write failed */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+uint8_t ADC_cal_init(void);          /* restore, or calibrate if needed */
+uint8_t ADC_cal_calibrate(void);     /* always calibrate and store */
+uint8_t ADC_cal_last_result(void);   /* ADC_CAL_xxx of the last call */
+uint32_t ADC_cal_last_us(void);      /* duration of the last call, us */
+uint32_t ADC_cal_full_us(void);      /* duration of a full calibration, us */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ADC_CAL_H */
@@ -0,0 +1,275 @@
+/**----------------------------------------------------------------------------
+ *
+ *            \file adc_dma.cpp
+--                                                                           --
+--              ECEN 5803 Mastering Embedded System Architecture             --
+--                  Project 1 Module 4                                       --
+--                Microcontroller Firmware                                   --
+--                      adc_dma.cpp                                          --
+--                                                                           --
+-------------------------------------------------------------------------------
+--
+--  Designed for:  University of Colorado at Boulder
+--
+--
+--  Designed by:  Tristan Lennertz, Subhradeep Dutta, & Omkar Prabhu
+--
+-- Version: 2.1
+-- Date of current revision:  2018-02
+-- Target Microcontroller: Freescale MKL25ZVMT4
+-- Tools used:  ARM mbed compiler
+--              ARM mbed SDK
+--              Freescale FRDM-KL25Z Freedom Board
+--
+--
+--   Functional Description:
+--   Hardware timed, DMA driven sampling of the vortex sensor.
+--
+--   TPM1 free runs with an overflow every SAMPLE_PERIOD. Through SIM_SOPT7
+--   the overflow is the ADC0 hardware trigger, so conversions start on the
+--   timer edge regardless of what the CPU is doing. Each completed
+--   conversion raises a DMA request (ADC0 is DMAMUX source 40) and DMA
+--   channel 0 copies the 16-bit result into the block being filled.
+--
+--   When a block is full the channel interrupt hands it to the main loop
+--   and points the channel at the other block. If the main loop has not yet
+--   released the previous block, there is nowhere safe to put new samples:
+--   the block just filled is discarded, refilled, and counted as dropped.
+--
+*/
+
+#include "mbed.h"
+#include "freq.h"
+#include "adc_dma.h"
+#include "adc_cal.h"
+
+/**
+ * @brief TPM counter clock. mbed runs the KL25Z from the PLL, so with
+ * PLLFLLSEL set the TPM source (MCGPLLCLK/2) is 48 MHz.
+ */
+#define ADC_DMA_TPM_CLOCK_HZ (48000000UL)
+
+/**
+ * @brief TPM1 modulo giving one overflow, and one conversion, per sample
+ */
+#define ADC_DMA_TPM_MOD ((uint32_t)(ADC_DMA_TPM_CLOCK_HZ * SAMPLE_PERIOD + 0.5) - 1)
+
+/**
+ * @brief SIM_SOPT7 ADC0 trigger select value for TPM1 overflow
+ */
+#define ADC_TRIGGER_TPM1 (9)
+
+/**
+ * @brief DMAMUX request source number of ADC0
+ */
+#define DMAMUX_SOURCE_ADC0 (40)
+
+/**
+ * @brief Bytes DMA moves per block
+ */
+#define ADC_DMA_BLOCK_BYTES (ADC_DMA_BLOCK_SIZE * sizeof(uint16_t))
+
+/**
+ * @brief readyBlock value when the main loop has nothing to process
+ */
+#define NO_BLOCK (0xFF)
+
+/**
+ * @brief Ping-pong sample blocks
+ */
+static uint16_t adcBlocks[2][ADC_DMA_BLOCK_SIZE];
+
+/**
+ * @brief Block DMA is writing into
+ */
+static uint8_t fillBlock = 0;
+
+/**
+ * @brief Full block owned by the main loop until released, or NO_BLOCK.
+ * Written by the DMA interrupt when a block is handed over and by the main
+ * loop when it is released.
+ */
+static volatile uint8_t readyBlock = NO_BLOCK;
+
+/**
+ * @brief Block statistics, updated in the DMA interrupt
+ */
+static volatile uint32_t blockCount = 0;
+static volatile uint32_t droppedBlocks = 0;
+static volatile uint32_t dmaErrors = 0;
+
+/**
+ * @brief DMA channel 0 interrupt, once per completed block (or on error)
+ */
+static void ADC_dma_isr(void)
+{
+	uint32_t status = DMA0->DMA[0].DSR_BCR;
+
+	/* Writing DONE clears it along with the error flags */
+	DMA0->DMA[0].DSR_BCR = DMA_DSR_BCR_DONE_MASK;
+
+	if (status & (DMA_DSR_BCR_CE_MASK | DMA_DSR_BCR_BES_MASK | DMA_DSR_BCR_BED_MASK))
+	{
+		/* The block is incomplete; start it again */
+		dmaErrors++;
+	}
+	else
+	{
+		blockCount++;
+
+		if (readyBlock != NO_BLOCK)
+		{
+			/* Main loop still holds the other block: reuse this one */
+			droppedBlocks++;
+		}
+		else
+		{
+			readyBlock = fillBlock;
+			fillBlock ^= 1;
+		}
+	}
+
+	DMA0->DMA[0].DAR = (uint32_t)adcBlocks[fillBlock];
+	DMA0->DMA[0].DSR_BCR = DMA_DSR_BCR_BCR(ADC_DMA_BLOCK_BYTES);
+}
+
+/**
+ * @brief Sets ADC0 up for timer triggered, DMA serviced conversions of the
+ * vortex input
+ */
+static void ADC_dma_configure(void)
+{
+	/* 16-bit single ended at 12 MHz ADCK, one conversion per trigger */
+	ADC0->CFG1 = ADC_CFG1_ADIV(1) | ADC_CFG1_MODE(3) | ADC_CFG1_ADICLK(0);
+	ADC0->CFG2 = 0;
+	ADC0->SC3 = 0;
+	ADC0->SC2 = ADC_SC2_ADTRG_MASK | ADC_SC2_DMAEN_MASK;
+	ADC0->SC1[0] = ADC_SC1_ADCH(ADC_DMA_CHANNEL);
+}
+
+/**
+ * @brief Restores or runs the ADC0 calibration (see adc_cal.cpp), then
+ * starts timer triggered conversions with DMA into the ping-pong blocks.
+ * The first block is ready 6.4 ms later.
+ */
+void ADC_dma_init(void)
+{
+	/* Clocks to everything in the chain */
+	SIM->SCGC5 |= SIM_SCGC5_PORTB_MASK;
+	SIM->SCGC6 |= SIM_SCGC6_ADC0_MASK | SIM_SCGC6_TPM1_MASK | SIM_SCGC6_DMAMUX_MASK;
+	SIM->SCGC7 |= SIM_SCGC7_DMA_MASK;
+
+	/* Vortex input pin to its analog function */
+	PORTB->PCR[1] = PORT_PCR_MUX(0);
+
+	/* Stop anything left running */
+	TPM1->SC = 0;
+	DMAMUX0->CHCFG[0] = 0;
+	DMA0->DMA[0].DSR_BCR = DMA_DSR_BCR_DONE_MASK;
+
+	/* A failed calibration leaves the ADC usable, just less accurate */
+	ADC_cal_init();
+	ADC_dma_configure();
+
+	/* TPM1 overflow starts each conversion */
+	SIM->SOPT7 = (SIM->SOPT7 & ~(SIM_SOPT7_ADC0TRGSEL_MASK | SIM_SOPT7_ADC0PRETRGSEL_MASK)) |
+	             SIM_SOPT7_ADC0ALTTRGEN_MASK | SIM_SOPT7_ADC0TRGSEL(ADC_TRIGGER_TPM1);
+
+	/* DMA channel 0: 16-bit result register into the first block */
+	fillBlock = 0;
+	readyBlock = NO_BLOCK;
+	DMA0->DMA[0].SAR = (uint32_t)&ADC0->R[0];
+	DMA0->DMA[0].DAR = (uint32_t)adcBlocks[fillBlock];
+	DMA0->DMA[0].DSR_BCR = DMA_DSR_BCR_BCR(ADC_DMA_BLOCK_BYTES);
+	DMA0->DMA[0].DCR = DMA_DCR_EINT_MASK | DMA_DCR_ERQ_MASK | DMA_DCR_CS_MASK |
+	                   DMA_DCR_SSIZE(2) | DMA_DCR_DINC_MASK | DMA_DCR_DSIZE(2);
+
+	/* The block swap must finish well inside one sample period */
+	NVIC_SetVector(DMA0_IRQn, (uint32_t)&ADC_dma_isr);
+	NVIC_SetPriority(DMA0_IRQn, 0);
+	NVIC_EnableIRQ(DMA0_IRQn);
+
+	DMAMUX0->CHCFG[0] = DMAMUX_CHCFG_ENBL_MASK | DMAMUX_CHCFG_SOURCE(DMAMUX_SOURCE_ADC0);
+
+	/* Start the sample clock last */
+	SIM->SOPT2 = (SIM->SOPT2 & ~SIM_SOPT2_TPMSRC_MASK) | SIM_SOPT2_TPMSRC(1) | SIM_SOPT2_PLLFLLSEL_MASK;
+	TPM1->CNT = 0;
+	TPM1->MOD = ADC_DMA_TPM_MOD;
+	TPM1->SC = TPM_SC_CMOD(1) | TPM_SC_PS(0);
+}
+
+/**
+ * @brief Pauses sampling, reruns the full ADC0 calibration and stores it in
+ * flash, then resumes sampling
+ *
+ * @return ADC_CAL_CALIBRATED or ADC_CAL_FAILED
+ *
+ * @note Sampling stops for the duration (tens of ms, see ADC_cal_last_us()),
+ * so the block in progress spans the gap.
+ */
+uint8_t ADC_dma_recalibrate(void)
+{
+	uint8_t result;
+
+	/* Stop the trigger and let any conversion in flight finish */
+	TPM1->SC = 0;
+	while (ADC0->SC2 & ADC_SC2_ADACT_MASK)
+		;
+
+	result = ADC_cal_calibrate();
+	ADC_dma_configure();
+
+	TPM1->CNT = 0;
+	TPM1->SC = TPM_SC_CMOD(1) | TPM_SC_PS(0);
+
+	return result;
+}
+
+/**
+ * @brief Next full block of samples, if there is one
+ *
+ * @return ADC_DMA_BLOCK_SIZE samples, oldest first, or NULL when no block is
+ * ready. The block belongs to the caller until ADC_dma_release_block().
+ */
+const uint16_t * ADC_dma_get_block(void)
+{
+	uint8_t block = readyBlock;
+
+	if (block == NO_BLOCK)
+		return NULL;
+
+	return adcBlocks[block];
+}
+
+/**
+ * @brief Returns the block from ADC_dma_get_block() so the next one can be
+ * handed over
+ */
+void ADC_dma_release_block(void)
+{
+	readyBlock = NO_BLOCK;
+}
+
+/**
+ * @brief Number of blocks completed since ADC_dma_init(), including dropped ones
+ */
+uint32_t ADC_dma_block_count(void)
+{
+	return blockCount;
+}
+
+/**
+ * @brief Number of blocks discarded because the main loop was too slow
+ */
+uint32_t ADC_dma_dropped_blocks(void)
+{
+	return droppedBlocks;
+}
+
+/**
+ * @brief Number of DMA errors, each of which restarted a block
+ */
+uint32_t ADC_dma_error_count(void)
+{
+	return dmaErrors;
+}
@@ -0,0 +1,68 @@
+/**----------------------------------------------------------------------------
+ *
+ *            \file adc_dma.h
+--                                                                           --
+--              ECEN 5803 Mastering Embedded System Architecture             --
+--                  Project 1 Module 4                                       --
+--                Microcontroller Firmware                                   --
+--                      adc_dma.h                                            --
+--                                                                           --
+-------------------------------------------------------------------------------
+--
+--  Designed for:  University of Colorado at Boulder
+--
+--
+--  Designed by:  Tristan Lennertz, Subhradeep Dutta, & Omkar Prabhu
+--
+-- Version: 2.1
+-- Date of current revision:  2018-02
+-- Target Microcontroller: Freescale MKL25ZVMT4
+-- Tools used:  ARM mbed compiler
+--              ARM mbed SDK
+--              Freescale FRDM-KL25Z Freedom Board
+--
+--
+--   Functional Description:
+--   Hardware timed sampling of the vortex sensor. TPM1 overflows every
+--   SAMPLE_PERIOD and triggers an ADC0 conversion, and DMA channel 0 moves
+--   each result into one of two ping-pong blocks. The main loop is handed
+--   a complete block at a time and processes it at its leisure; if it is
+--   still holding a block when the next one completes, that block is dropped
+--   and counted rather than silently lost.
+--
+*/
+
+#ifndef ADC_DMA_H
+#define ADC_DMA_H
+
+#include <stdint.h>
+
+/**
+ * @brief Samples per block. At 10 kHz a block completes every 6.4 ms, which
+ * is how long the main loop has to take and release each one.
+ */
+#define ADC_DMA_BLOCK_SIZE (64)
+
+/**
+ * @brief ADC0 single ended input carrying the vortex signal
+ * (ADC0_SE9, PTB1, Arduino header A1)
+ */
+#define ADC_DMA_CHANNEL (9)
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void ADC_dma_init(void);                     /* calibrate ADC0, start sampling */
+uint8_t ADC_dma_recalibrate(void);           /* rerun and store the calibration */
+const uint16_t * ADC_dma_get_block(void);    /* next full block, or NULL */
+void ADC_dma_release_block(void);            /* hand the block back to DMA */
+uint32_t ADC_dma_block_count(void);          /* blocks completed */
+uint32_t ADC_dma_dropped_blocks(void);       /* blocks lost to a busy main loop */
+uint32_t ADC_dma_error_count(void);          /* DMA configuration/bus errors */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ADC_DMA_H */
@@ -0,0 +1,161 @@
+/**----------------------------------------------------------------------------
+ *
+ *            \file cycle_count.h
+--                                                                           --
+--              ECEN 5803 Mastering Embedded System Architecture             --
+--                  Project 1 Module 4                                       --
+--                Microcontroller Firmware                                   --
+--                      cycle_count.h                                        --
+--                                                                           --
+-------------------------------------------------------------------------------
+--
+--  Designed for:  University of Colorado at Boulder
+--
+--
+--  Designed by:  Tristan Lennertz, Subhradeep Dutta, & Omkar Prabhu
+--
+-- Version: 2.1
+-- Date of current revision:  2018-02
+-- Target Microcontroller: Freescale MKL25ZVMT4
+-- Tools used:  ARM mbed compiler
+--              ARM mbed SDK
+--              Freescale FRDM-KL25Z Freedom Board
+--
+--
+--   Functional Description:
+--   Free-running cycle counter for measuring execution time of short code
+--   sections. The Cortex-M0+ has no DWT cycle counter, so on the KL25Z the
+--   otherwise unused SysTick timer is run from the core clock as a 24-bit
+--   down counter with no interrupt. Intervals up to 2^24 core clocks
+--   (~349 ms at 48 MHz) are measured correctly across its wraparound.
+--
+--   On a host build the counter is the processor time stamp counter where
+--   available, or a nanosecond clock otherwise; the executive simulation
+--   (HOST_SIM) reads its virtual clock instead, less the cycles slept in
+--   WFI, since SysTick stops with the core clock in sleep.
+--
+*/
+
+#ifndef CYCLE_COUNT_H
+#define CYCLE_COUNT_H
+
+#include <stdint.h>
+
+#ifdef TARGET_KL25Z
+
+#include "MKL25Z4.h"
+
+/**
+ * @brief Valid bits of the counter, used to measure across wraparound
+ */
+#define CYCLE_COUNT_MASK (0x00FFFFFFUL)
+
+/**
+ * @brief Starts SysTick free running at the core clock, interrupt disabled
+ */
+static __inline void cycleCountInit(void)
+{
+	SysTick->LOAD = CYCLE_COUNT_MASK;
+	SysTick->VAL = 0;
+	SysTick->CTRL = SysTick_CTRL_CLKSOURCE_Msk | SysTick_CTRL_ENABLE_Msk;
+}
+
+/**
+ * @brief Current counter value. SysTick counts down, this counts up.
+ */
+static __inline uint32_t cycleCountRead(void)
+{
+	return CYCLE_COUNT_MASK - SysTick->VAL;
+}
+
+#elif defined(HOST_SIM) /* host simulation of the executive */
+
+/* The virtual core clock of host/sim, so measurements show only the
+   modelled costs and repeat exactly from run to run */
+#define CYCLE_COUNT_MASK (0xFFFFFFFFUL)
+
+#ifdef __cplusplus
+extern "C" uint32_t simCycleCount(void);
+#else
+uint32_t simCycleCount(void);
+#endif
+
+static __inline void cycleCountInit(void)
+{
+}
+
+static __inline uint32_t cycleCountRead(void)
+{
+	return simCycleCount();
+}
+
+#else /* host build */
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#else
+#include <time.h>
+#endif
+
+#define CYCLE_COUNT_MASK (0xFFFFFFFFUL)
+
+static __inline void cycleCountInit(void)
+{
+}
+
+static __inline uint32_t cycleCountRead(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+	return (uint32_t)__rdtsc();
+#else
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint32_t)((uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec);
+#endif
+}
+
+#endif /* TARGET_KL25Z */
+
+/**
+ * @brief Number of counts between two readings of cycleCountRead()
+ */
+static __inline uint32_t cycleCountElapsed(uint32_t start, uint32_t end)
+{
+	return (end - start) & CYCLE_COUNT_MASK;
+}
+
+/**
+ * @brief Running execution time statistics for a measured code section
+ */
+typedef struct
+{
+	uint32_t min;      /* shortest measured interval, in counts */
+	uint32_t max;      /* longest measured interval, in counts */
+	uint64_t total;    /* sum of all intervals */
+	uint32_t count;    /* number of measured intervals */
+} cycleStats_t;
+
+/**
+ * @brief Folds one measured interval into a statistics record
+ */
+static __inline void cycleStatsUpdate(cycleStats_t * stats, uint32_t cycles)
+{
+	if (stats->count == 0 || cycles < stats->min)
+		stats->min = cycles;
+	if (cycles > stats->max)
+		stats->max = cycles;
+
+	stats->total += cycles;
+	stats->count++;
+}
+
+/**
+ * @brief Mean interval of a statistics record, zero if nothing was measured
+ */
+static __inline uint32_t cycleStatsAverage(const cycleStats_t * stats)
+{
+	return stats->count ? (uint32_t)(stats->total / stats->count) : 0;
+}
+
+#endif /* CYCLE_COUNT_H */
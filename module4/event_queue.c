@@ -0,0 +1,110 @@
+/**----------------------------------------------------------------------------
+ *
+ *            \file event_queue.c
+--                                                                           --
+--              ECEN 5803 Mastering Embedded System Architecture             --
+--                  Project 1 Module 4                                       --
+--                Microcontroller Firmware                                   --
+--                      event_queue.c                                        --
+--                                                                           --
+-------------------------------------------------------------------------------
+--
+--  Designed for:  University of Colorado at Boulder
+--
+--
+--  Designed by:  Tristan Lennertz, Subhradeep Dutta, & Omkar Prabhu
+--
+-- Version: 2.1
+-- Date of current revision:  2018-02
+-- Target Microcontroller: Freescale MKL25ZVMT4
+-- Tools used:  ARM mbed compiler
+--              ARM mbed SDK
+--              Freescale FRDM-KL25Z Freedom Board
+--
+--
+--   Functional Description:
+--   Single producer, single consumer event queue (see event_queue.h). The
+--   producer fills a slot before publishing it by advancing head, and the
+--   consumer copies a slot out before releasing it by advancing tail. The
+--   buffer and indices are volatile, so the compiler keeps those stores in
+--   program order, and the single core M0+ needs no barrier beyond that.
+--
+*/
+
+#include <stdint.h>
+
+#include "event_queue.h"
+
+/**
+ * @brief Adds an event. Called only from the producer (timer0).
+ *
+ * @return 0 if queued, 1 if the queue was full and the event was counted
+ * as an overflow instead
+ */
+uint8_t evqPost(eventQueue_t * q, uint8_t type, uint32_t time)
+{
+	uint8_t head = q->head;
+	volatile event_t * slot;
+
+	if ((uint8_t)(head - q->tail) >= EVQ_SIZE)
+	{
+		q->overflows++;
+		return 1;
+	}
+
+	slot = &q->buf[head & (EVQ_SIZE - 1)];
+	slot->type = type;
+	slot->time = time;
+
+	/* Publish only once the slot is complete */
+	q->head = head + 1;
+	q->posted++;
+
+	return 0;
+}
+
+/**
+ * @brief Takes the oldest event. Called only from the consumer (main loop).
+ *
+ * @return 1 if an event was copied to ev, 0 if the queue was empty
+ */
+uint8_t evqGet(eventQueue_t * q, event_t * ev)
+{
+	uint8_t tail = q->tail;
+	uint8_t fill = (uint8_t)(q->head - tail);
+	volatile event_t * slot;
+
+	if (fill == 0)
+		return 0;
+
+	if (fill > q->highWater)
+		q->highWater = fill;
+
+	slot = &q->buf[tail & (EVQ_SIZE - 1)];
+	ev->type = slot->type;
+	ev->time = slot->time;
+
+	/* Release the slot only once it has been copied */
+	q->tail = tail + 1;
+
+	return 1;
+}
+
+/**
+ * @brief Records events the consumer merged into another of the same type
+ * rather than handling separately
+ */
+void evqCoalesced(eventQueue_t * q, uint32_t events)
+{
+	q->coalesced += events;
+}
+
+/**
+ * @brief Whether the consumer has nothing to take. A post may land just
+ * after this returns 1, so the main loop checks it with interrupts masked
+ * before sleeping.
+ */
+uint8_t evqIsEmpty(const eventQueue_t * q)
+{
+	return q->head == q->tail;
+}
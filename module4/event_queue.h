@@ -0,0 +1,95 @@
+/**----------------------------------------------------------------------------
+ *
+ *            \file event_queue.h
+--                                                                           --
+--              ECEN 5803 Mastering Embedded System Architecture             --
+--                  Project 1 Module 4                                       --
+--                Microcontroller Firmware                                   --
+--                      event_queue.h                                        --
+--                                                                           --
+-------------------------------------------------------------------------------
+--
+--  Designed for:  University of Colorado at Boulder
+--
+--
+--  Designed by:  Tristan Lennertz, Subhradeep Dutta, & Omkar Prabhu
+--
+-- Version: 2.1
+-- Date of current revision:  2018-02
+-- Target Microcontroller: Freescale MKL25ZVMT4
+-- Tools used:  ARM mbed compiler
+--              ARM mbed SDK
+--              Freescale FRDM-KL25Z Freedom Board
+--
+--
+--   Functional Description:
+--   Single producer, single consumer queue of timestamped events, used to
+--   pass events from timer0() to the super loop without losing or merging
+--   them silently.
+--
+--   The head index is written only by the producer and the tail only by
+--   the consumer. Both are single bytes, so every update is one store and
+--   the Cortex-M0+ needs no LDREX/STREX or interrupt masking. The indices
+--   run freely and wrap at 256; EVQ_SIZE is a power of two no larger than
+--   128 so their difference is always the fill level.
+--
+*/
+
+#ifndef EVENT_QUEUE_H
+#define EVENT_QUEUE_H
+
+#include <stdint.h>
+
+/**
+ * @brief Queue capacity in events, a power of two up to 128
+ */
+#define EVQ_SIZE (16)
+
+#if (EVQ_SIZE & (EVQ_SIZE - 1)) != 0 || EVQ_SIZE > 128
+#error "EVQ_SIZE must be a power of two no larger than 128"
+#endif
+
+/**
+ * @brief Event types posted by timer0()
+ */
+#define EV_DISPLAY    (1)   /* display period elapsed, OK to print status */
+#define EV_LED_TOGGLE (2)   /* heartbeat LED due to toggle */
+#define EV_TYPE_COUNT (3)
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief One queued event
+ */
+typedef struct
+{
+	uint8_t type;       /* EV_xxx */
+	uint32_t time;      /* timer0 tick it was posted on */
+} event_t;
+
+/**
+ * @brief Queue storage and statistics. Each field has a single writer.
+ */
+typedef struct
+{
+	volatile event_t buf[EVQ_SIZE];
+	volatile uint8_t head;          /* producer: next slot to fill */
+	volatile uint8_t tail;          /* consumer: next slot to read */
+	volatile uint32_t posted;       /* producer: events accepted */
+	volatile uint32_t overflows;    /* producer: events lost to a full queue */
+	uint32_t coalesced;             /* consumer: events merged with another */
+	uint8_t highWater;              /* consumer: deepest fill seen */
+} eventQueue_t;
+
+uint8_t evqPost(eventQueue_t * q, uint8_t type, uint32_t time);   /* producer */
+uint8_t evqGet(eventQueue_t * q, event_t * ev);                  /* consumer */
+void evqCoalesced(eventQueue_t * q, uint32_t events);            /* consumer */
+uint8_t evqIsEmpty(const eventQueue_t * q);                      /* consumer */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* EVENT_QUEUE_H */
@@ -25,28 +25,45 @@
 --   Functional Description:  
 --   This file contains the functions and data structures needed to smooth 
 --	 ADC samples and calculate frequency from the samples using a peak 
---	 detection algorithm. 
+--	 detection algorithm. Each peak found, and each reset or prominence
+--	 change, leaves a record in the trace log (trace.h).
 -- 
 */
 
 #include <stdint.h>
+#include <string.h>
+
+#include "freq.h"
+#include "trace.h"
 
 /**
- * @brief Period between each ADC sample (and call of calculateFrequency)
- * Defined in seconds (float)
+ * @brief Size of the sliding window for moving average. Always a power of two
+ * (see WINDOW_SHIFT in freq.h) so index wraparound is a mask.
  */
-#define SAMPLE_PERIOD (0.0001)
+#define WINDOW_SIZE (1 << WINDOW_SHIFT)
+#define WINDOW_MASK (WINDOW_SIZE - 1)
+
+#if (WINDOW_SHIFT < 0) || (WINDOW_SHIFT > 16)
+#error "WINDOW_SHIFT must be 0..16 for the running sum to fit in 32 bits"
+#endif
 
 /**
- * @brief Size of the sliding window for moving average 
+ * @brief Size of the comparison set for peak detection: a center value with 
+ * CIRCBUF_SIZE / 2 values on either side. Should be an odd number. 
  */
-#define WINDOW_SIZE (8)
+#define CIRCBUF_SIZE (9)
+#define PEAK_HALF (CIRCBUF_SIZE / 2)
 
 /**
- * @brief Size of the sliding window for moving average 
- * Should be an odd number. 
+ * @brief Length of the peak detection history. A power of two holding the 
+ * comparison set plus the value that has just left it.
  */
-#define CIRCBUF_SIZE (9)
+#define PEAK_BUF_SIZE (16)
+#define PEAK_BUF_MASK (PEAK_BUF_SIZE - 1)
+
+#if ((CIRCBUF_SIZE & 1) == 0) || (CIRCBUF_SIZE + 1 > PEAK_BUF_SIZE)
+#error "CIRCBUF_SIZE must be odd and smaller than PEAK_BUF_SIZE"
+#endif
 
 /**
  * @brief Sliding window buffer for moving average calculation of ADC samples
@@ -54,9 +71,46 @@
 static uint16_t adcWindowBuff[WINDOW_SIZE];
 
 /**
- * @brief Circular buffer for peak detection storage of previous values
+ * @brief Circular buffer for peak detection storage of previous averages
+ */
+static uint32_t peakBuff[PEAK_BUF_SIZE]; 
+
+/**
+ * @brief Write index into adcWindowBuff
+ */
+static uint16_t adcWindowIdx = 0;
+
+/**
+ * @brief Running sum of adcWindowBuff, which is also the moving average in
+ * Q(WINDOW_SHIFT) fixed point
+ */
+static uint32_t adcWindowSum = 0;
+
+/**
+ * @brief Write index into peakBuff
+ */
+static uint16_t peakBuffIdx = 0;
+
+/**
+ * @brief Running sums of the PEAK_HALF newest values, and of the PEAK_HALF 
+ * oldest values, of the comparison set
+ */
+static uint32_t peakNewSum = 0;
+static uint32_t peakOldSum = 0;
+
+/**
+ * @brief Margin the center value must clear both side averages by, and fall 
+ * below the last peak by before another peak is accepted. In the same 
+ * Q(WINDOW_SHIFT) units as the averages. 
+ */
+static uint32_t peakProminence = (uint32_t)PEAK_PROMINENCE << WINDOW_SHIFT;
+
+/**
+ * @brief Center value of the last detected peak, and whether the detector has 
+ * been re-armed since
  */
-static float peakBuff[CIRCBUF_SIZE]; 
+static uint32_t lastPeakVal = 0;
+static uint8_t peakArmed = 1;
 
 /**
  * @brief Keeps track of the number of calls to the frequency detection function
@@ -69,8 +123,6 @@ static uint32_t samplesBeforePeak = 0;
 static float currentFreqEstimate = 0; 
 
 /* Internal function declarations */
-float updateADCAvg(uint16_t latestValue);
-uint8_t atPeak(float newAvg);
 void updateFrequencyEstimate(float newFreq); 
 
 /**
@@ -87,7 +139,7 @@ void updateFrequencyEstimate(float newFreq);
 uint32_t calculateFrequency(uint16_t latestValue)
 {
 	/* Smooth out the noise from the ADC with a moving average */
-	float newAvg = updateADCAvg(latestValue);
+	uint32_t newAvg = updateADCAvg(latestValue);
 	
 	/* Update samples its been between peak detections */
 	samplesBeforePeak++; 
@@ -98,7 +150,10 @@ uint32_t calculateFrequency(uint16_t latestValue)
 		/* Extrapolate a frequency from this peak-to-peak period, update to
      * new current best estimate 
 		 */
-		float currentFreqEstimate = 1 / ((float)samplesBeforePeak * SAMPLE_PERIOD); 
+		currentFreqEstimate = 1 / ((float)samplesBeforePeak * SAMPLE_PERIOD); 
+		
+		TRACE(TRACE_FREQ_PEAK, (samplesBeforePeak > 0xFFFF) ? 0xFFFF : samplesBeforePeak,
+		      lastPeakVal);
 		
 		/* Reset running sample count */
 		samplesBeforePeak = 0; 
@@ -111,33 +166,26 @@ uint32_t calculateFrequency(uint16_t latestValue)
  * @brief Takes in the latest ADC sample and returns an updated moving average. 
  *
  * Intended to smooth out the noise present in the ADC samples. Implemented using
- * a sliding windows moving average. 
+ * a sliding windows moving average. Only the sample leaving the window and the 
+ * one entering it touch the running sum, so the cost does not depend on the
+ * window length, and no division is needed because the sum itself is returned
+ * as a fixed point average. 
  * 
  * @param latestValue The latest value to be sampled from the ADC
  *
- * @return An updated average value from the ADC
+ * @return An updated average value from the ADC, in Q(WINDOW_SHIFT) format
+ * (divide by WINDOW_SIZE for ADC counts)
  */  
-float updateADCAvg(uint16_t latestValue)
+uint32_t updateADCAvg(uint16_t latestValue)
 {
-	static uint16_t buffIdx = 0;
-	float retVal; 
-	
-	/* Index wraps around buffer, removing oldest value each time */
-	buffIdx %= WINDOW_SIZE; 
-	adcWindowBuff[buffIdx] = latestValue; 
-	
-	/* Perform calculation of the new average */
-	int i, tempSum = 0;
-	for (i = 0; i < WINDOW_SIZE; i++)
-	{
-		tempSum += adcWindowBuff[i];
-	}
-	retVal = (float)tempSum / (float)WINDOW_SIZE;
+	/* Swap the oldest value in the window for the newest one */
+	adcWindowSum += (uint32_t)latestValue - adcWindowBuff[adcWindowIdx];
+	adcWindowBuff[adcWindowIdx] = latestValue; 
 	
-	/* Advace the buffer's index for next time */
-	buffIdx++; 
+	/* Advance the buffer's index for next time, wrapping around the window */
+	adcWindowIdx = (adcWindowIdx + 1) & WINDOW_MASK; 
 		
-	return retVal;
+	return adcWindowSum;
 }
 
 /**
@@ -145,55 +193,86 @@ float updateADCAvg(uint16_t latestValue)
  * been reached yet. 
  *
  * Keeps track of past inputs to this function to compare and determine whether a peak
- * has been reached. 
+ * has been reached. A peak is a center value greater than the average of the 
+ * PEAK_HALF values on either side of it. Both side sums are maintained 
+ * incrementally as values enter and leave the comparison set, and the averages
+ * are compared by multiplying the center value instead of dividing the sums.  
+ *
+ * When a prominence is set, the center must exceed both averages by more than 
+ * it, and after a peak the center must fall more than it below that peak before
+ * the next one is accepted. This stops small ripples on a peak resetting the 
+ * period count. With a prominence of zero every local maximum is reported, 
+ * exactly as the original float detector did. 
  *
- * @param latestValue The latest value to contribute to the peak comparison. 
+ * @param newAvg The latest fixed point average to contribute to the peak comparison. 
  *
  * @return True if a peak is determined to exist, false otherwise. 
  */  
-uint8_t atPeak(float newAvg)
+uint8_t atPeak(uint32_t newAvg)
 {
-	static uint16_t buffIdx = CIRCBUF_SIZE - 1; 
-	uint16_t i, tempIdx; 
-	float beforeAvg, afterAvg, centerVal; 
+	uint32_t centerVal, threshold; 
+	uint8_t isPeak = 0; 
 	
-	/* Index wraps around buffer, removing oldest value as well as changing
-   * the start of the comparison set each time	*/
-	peakBuff[buffIdx] = newAvg; 
+	/* Store the value and advance. Going back PEAK_HALF from the newest value 
+	 * gives the center, one further is the newest of the oldest side, and 
+	 * CIRCBUF_SIZE back is the value that has just left the comparison set. 
+	 */
+	peakBuff[peakBuffIdx] = newAvg; 
+	centerVal = peakBuff[(peakBuffIdx - PEAK_HALF) & PEAK_BUF_MASK]; 
 	
-	/* The comparison set starts where the new value was added */
-	tempIdx = buffIdx; 
+	peakNewSum += newAvg - centerVal; 
+	peakOldSum += peakBuff[(peakBuffIdx - PEAK_HALF - 1) & PEAK_BUF_MASK] - 
+	              peakBuff[(peakBuffIdx - CIRCBUF_SIZE) & PEAK_BUF_MASK]; 
 	
-	/* Average out the values that preceeded the center value */
-	beforeAvg = 0; 
-	for (i = 0; i < (CIRCBUF_SIZE / 2); i++)
-	{
-		/* Accumulate next value */ 
-		beforeAvg += peakBuff[tempIdx++]; 
-		
-		/* Wrap around the buffer if needed */
-		tempIdx %= CIRCBUF_SIZE; 
-	}
-	beforeAvg /= (CIRCBUF_SIZE / 2);
+	peakBuffIdx = (peakBuffIdx + 1) & PEAK_BUF_MASK; 
 	
-	/* Grab the center value */
-	centerVal = peakBuff[tempIdx++];
-	tempIdx %= CIRCBUF_SIZE; 
+	/* Re-arm once the signal has dropped away from the last peak */
+	if (!peakArmed && (peakProminence == 0 || centerVal + peakProminence < lastPeakVal))
+		peakArmed = 1; 
 	
-	/* Average out the values after the center value */
-	afterAvg = 0; 
-	for (i = 0; i < (CIRCBUF_SIZE / 2); i++)
+	/* center > average + prominence, without dividing by PEAK_HALF */
+	threshold = peakProminence * PEAK_HALF; 
+	if (peakArmed && 
+	    centerVal * PEAK_HALF > peakNewSum + threshold && 
+	    centerVal * PEAK_HALF > peakOldSum + threshold)
 	{
-		/* Accumulate next value */ 
-		afterAvg += peakBuff[tempIdx++]; 
-		
-		/* Wrap around the buffer if needed */
-		tempIdx %= CIRCBUF_SIZE; 
+		lastPeakVal = centerVal; 
+		peakArmed = 0; 
+		isPeak = 1; 
 	}
-	afterAvg /= (CIRCBUF_SIZE / 2);
-	
-	/* Move the buffer's index for next time. Progresses backwards. */
-	buffIdx = buffIdx ? buffIdx - 1 : CIRCBUF_SIZE - 1; 
 	
-	return (centerVal > beforeAvg && centerVal > afterAvg ? 1 : 0); 
+	return isPeak; 
+}
+
+/**
+ * @brief Sets the peak detection prominence/hysteresis threshold
+ *
+ * @param adcCounts Margin in ADC counts. Zero reports every local maximum.
+ */  
+void setPeakProminence(uint16_t adcCounts)
+{
+	peakProminence = (uint32_t)adcCounts << WINDOW_SHIFT; 
+	TRACE(TRACE_FREQ_PROMINENCE, adcCounts, 0);
+}
+
+/**
+ * @brief Returns the smoothing and peak detection state to its power-on values.
+ *
+ * Lets a host replay (or a restart of measurement) start from a clean
+ * pipeline without the history of a previous sample stream.
+ */
+void resetFrequency(void)
+{
+	memset(adcWindowBuff, 0, sizeof(adcWindowBuff));
+	memset(peakBuff, 0, sizeof(peakBuff));
+	adcWindowIdx = 0;
+	adcWindowSum = 0;
+	peakBuffIdx = 0;
+	peakNewSum = 0;
+	peakOldSum = 0;
+	lastPeakVal = 0;
+	peakArmed = 1;
+	samplesBeforePeak = 0;
+	currentFreqEstimate = 0;
+	TRACE(TRACE_FREQ_RESET, 0, 0);
 }
@@ -0,0 +1,139 @@
+/**----------------------------------------------------------------------------
+ *
+ *            \file freq.h
+--                                                                           --
+--              ECEN 5803 Mastering Embedded System Architecture             --
+--                  Project 1 Module 4                                       --
+--                Microcontroller Firmware                                   --
+--                      freq.h                                               --
+--                                                                           --
+-------------------------------------------------------------------------------
+--
+--  Designed for:  University of Colorado at Boulder
+--
+--
+--  Designed by:  Tristan Lennertz, Subhradeep Dutta, & Omkar Prabhu
+--
+-- Version: 2.1
+-- Date of current revision:  2018-02
+-- Target Microcontroller: Freescale MKL25ZVMT4
+-- Tools used:  ARM mbed compiler
+--              ARM mbed SDK
+--              Freescale FRDM-KL25Z Freedom Board
+--
+--
+--   Functional Description:
+--   Interface to the vortex frequency estimators and the ADC smoothing and
+--   peak detection pipeline in freq.c. This header has no mbed dependencies
+--   so that the same code can be compiled and replayed on a host machine
+--   (see host/).
+--
+*/
+
+#ifndef FREQ_H
+#define FREQ_H
+
+#include <stdint.h>
+
+#include "cycle_count.h"
+
+/**
+ * @brief Period between each ADC sample (and call of calculateFrequency)
+ * Defined in seconds (float)
+ */
+#define SAMPLE_PERIOD (0.0001)
+
+/**
+ * @brief log2 of the moving average window length, fixed at compile time.
+ * The average is returned in Q(WINDOW_SHIFT) fixed point, so with a power of
+ * two window no division is ever needed.
+ */
+#ifndef WINDOW_SHIFT
+#define WINDOW_SHIFT (3)
+#endif
+
+/**
+ * @brief Default peak detection prominence/hysteresis, in ADC counts. Zero
+ * keeps the original behaviour of reporting every local maximum.
+ */
+#ifndef PEAK_PROMINENCE
+#define PEAK_PROMINENCE (0)
+#endif
+
+/**
+ * @brief Available frequency estimators. FREQ_ESTIMATOR picks the one the
+ * firmware runs; it is bound at compile time in freq_estimator.c.
+ * Zero crossings are the default: they track 50 Hz to 3 kHz within 0.1 %
+ * with noise on the signal. The peak detector counts every ripple of the
+ * moving average as a peak at PEAK_PROMINENCE 0 and reads 7 to 10 kHz on
+ * a clean sine, and Goertzel only covers its bins' band; both are kept to
+ * compare against (freq_replay -e all). The host build checks the default
+ * on synthetic sines (ctest).
+ */
+#define FREQ_EST_PEAK     (0)   /* moving average + peak detector, freq.c */
+#define FREQ_EST_GOERTZEL (1)   /* Goertzel filter bank, freq_goertzel.c */
+#define FREQ_EST_ZEROCROSS (2)  /* interpolated zero crossings, freq_zerocross.c */
+#define FREQ_EST_COUNT    (3)
+
+#ifndef FREQ_ESTIMATOR
+#define FREQ_ESTIMATOR FREQ_EST_ZEROCROSS
+#endif
+
+/**
+ * @brief Default zero-crossing hysteresis half width, in ADC counts. Should
+ * sit above the noise amplitude on the vortex signal.
+ */
+#ifndef ZC_HYSTERESIS
+#define ZC_HYSTERESIS (256)
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Interface every frequency estimator implements
+ */
+typedef struct
+{
+	const char * name;                       /* short name for reports */
+	void (*reset)(void);                     /* back to power-on state */
+	uint32_t (*process)(uint16_t sample);    /* one ADC sample in, Hz out */
+	cycleStats_t * cycles;                   /* measured per-sample cost */
+} freqEstimator_t;
+
+extern const freqEstimator_t freqEstimators[FREQ_EST_COUNT];
+
+/* Selected estimator, fed per sample or per block (freq_estimator.c) */
+uint32_t freqProcess(uint16_t sample);
+uint32_t freqProcessBlock(const uint16_t * samples, uint16_t count);
+void freqReset(void);
+uint32_t freqLastEstimate(void);
+const freqEstimator_t * freqActiveEstimator(void);
+const freqEstimator_t * freqFindEstimator(const char * name);
+
+/* Moving average + peak detector estimator (freq.c) */
+uint32_t calculateFrequency(uint16_t latestValue);
+
+/* Pipeline stages, exposed so they can be exercised individually */
+uint32_t updateADCAvg(uint16_t latestValue);
+uint8_t atPeak(uint32_t newAvg);
+void setPeakProminence(uint16_t adcCounts);
+
+/* Returns the pipeline to its power-on state */
+void resetFrequency(void);
+
+/* Goertzel filter bank estimator (freq_goertzel.c) */
+uint32_t goertzelFrequency(uint16_t latestValue);
+void resetGoertzel(void);
+
+/* Interpolated zero-crossing estimator (freq_zerocross.c) */
+uint32_t zeroCrossFrequency(uint16_t latestValue);
+void setZeroCrossHysteresis(uint16_t adcCounts);
+void resetZeroCross(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FREQ_H */
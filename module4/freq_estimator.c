@@ -0,0 +1,175 @@
+/**----------------------------------------------------------------------------
+ *
+ *            \file freq_estimator.c
+--                                                                           --
+--              ECEN 5803 Mastering Embedded System Architecture             --
+--                  Project 1 Module 4                                       --
+--                Microcontroller Firmware                                   --
+--                      freq_estimator.c                                     --
+--                                                                           --
+-------------------------------------------------------------------------------
+--
+--  Designed for:  University of Colorado at Boulder
+--
+--
+--  Designed by:  Tristan Lennertz, Subhradeep Dutta, & Omkar Prabhu
+--
+-- Version: 2.1
+-- Date of current revision:  2018-02
+-- Target Microcontroller: Freescale MKL25ZVMT4
+-- Tools used:  ARM mbed compiler
+--              ARM mbed SDK
+--              Freescale FRDM-KL25Z Freedom Board
+--
+--
+--   Functional Description:
+--   Selects the vortex frequency estimator used by the firmware. The choice
+--   is made at build time with FREQ_ESTIMATOR (see freq.h) and freqProcess()
+--   calls the selected implementation directly, so the 100 us sample path
+--   has no indirect call. The table of all estimators is kept for the host
+--   replay tools and for reporting, and each entry carries the per-sample
+--   cycle cost measured for it.
+--
+*/
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "freq.h"
+#include "cycle_count.h"
+
+/**
+ * @brief Bind the build-time selection to its entry points
+ */
+#if FREQ_ESTIMATOR == FREQ_EST_PEAK
+#define ESTIMATOR_PROCESS calculateFrequency
+#define ESTIMATOR_RESET   resetFrequency
+#elif FREQ_ESTIMATOR == FREQ_EST_GOERTZEL
+#define ESTIMATOR_PROCESS goertzelFrequency
+#define ESTIMATOR_RESET   resetGoertzel
+#elif FREQ_ESTIMATOR == FREQ_EST_ZEROCROSS
+#define ESTIMATOR_PROCESS zeroCrossFrequency
+#define ESTIMATOR_RESET   resetZeroCross
+#else
+#error "Unknown FREQ_ESTIMATOR"
+#endif
+
+/**
+ * @brief Measured per-sample cost of each estimator, indexed by FREQ_EST_xxx
+ */
+static cycleStats_t estimatorCycles[FREQ_EST_COUNT];
+
+/**
+ * @brief Last estimate returned by the selected estimator, in Hz
+ */
+static uint32_t lastEstimate = 0;
+
+/**
+ * @brief All estimators built into this image, indexed by FREQ_EST_xxx
+ */
+const freqEstimator_t freqEstimators[FREQ_EST_COUNT] =
+{
+	{ "peak",      resetFrequency, calculateFrequency, &estimatorCycles[FREQ_EST_PEAK] },
+	{ "goertzel",  resetGoertzel,  goertzelFrequency,  &estimatorCycles[FREQ_EST_GOERTZEL] },
+	{ "zerocross", resetZeroCross, zeroCrossFrequency, &estimatorCycles[FREQ_EST_ZEROCROSS] },
+};
+
+/**
+ * @brief Runs the latest ADC sample through the build-time selected estimator
+ *
+ * @param sample The latest value to be sampled from the ADC
+ *
+ * @return The estimator's current frequency estimate, in Hz
+ *
+ * @note Must be called once per ADC sample, every SAMPLE_PERIOD seconds.
+ */
+uint32_t freqProcess(uint16_t sample)
+{
+	uint32_t cycStart = cycleCountRead();
+	uint32_t freq = ESTIMATOR_PROCESS(sample);
+
+	cycleStatsUpdate(&estimatorCycles[FREQ_ESTIMATOR],
+	                 cycleCountElapsed(cycStart, cycleCountRead()));
+
+	lastEstimate = freq;
+	return freq;
+}
+
+/**
+ * @brief Runs a block of consecutive ADC samples through the build-time
+ * selected estimator
+ *
+ * @param samples The samples, oldest first, SAMPLE_PERIOD seconds apart
+ * @param count Number of samples in the block
+ *
+ * @return The estimator's frequency estimate after the last sample, in Hz
+ *
+ * @note The cycle statistics still record the cost per sample: the block is
+ * timed once and the total divided by count.
+ */
+uint32_t freqProcessBlock(const uint16_t * samples, uint16_t count)
+{
+	uint32_t cycStart = cycleCountRead();
+	uint32_t freq = lastEstimate;
+	uint16_t i;
+
+	if (count == 0)
+		return freq;
+
+	for (i = 0; i < count; i++)
+		freq = ESTIMATOR_PROCESS(samples[i]);
+
+	cycleStatsUpdate(&estimatorCycles[FREQ_ESTIMATOR],
+	                 cycleCountElapsed(cycStart, cycleCountRead()) / count);
+
+	lastEstimate = freq;
+	return freq;
+}
+
+/**
+ * @brief Returns the selected estimator to its power-on state and clears its
+ * cycle statistics
+ */
+void freqReset(void)
+{
+	ESTIMATOR_RESET();
+	lastEstimate = 0;
+	estimatorCycles[FREQ_ESTIMATOR].count = 0;
+	estimatorCycles[FREQ_ESTIMATOR].total = 0;
+	estimatorCycles[FREQ_ESTIMATOR].max = 0;
+}
+
+/**
+ * @brief Most recent estimate of the selected estimator, in Hz
+ */
+uint32_t freqLastEstimate(void)
+{
+	return lastEstimate;
+}
+
+/**
+ * @brief Table entry of the build-time selected estimator
+ */
+const freqEstimator_t * freqActiveEstimator(void)
+{
+	return &freqEstimators[FREQ_ESTIMATOR];
+}
+
+/**
+ * @brief Looks up an estimator by name
+ *
+ * @return The table entry, or NULL if no estimator has that name
+ */
+const freqEstimator_t * freqFindEstimator(const char * name)
+{
+	uint8_t i;
+
+	for (i = 0; i < FREQ_EST_COUNT; i++)
+	{
+		if (strcmp(freqEstimators[i].name, name) == 0)
+			return &freqEstimators[i];
+	}
+
+	return NULL;
+}
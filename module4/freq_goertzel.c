@@ -0,0 +1,349 @@
+/**----------------------------------------------------------------------------
+ *
+ *            \file freq_goertzel.c
+--                                                                           --
+--              ECEN 5803 Mastering Embedded System Architecture             --
+--                  Project 1 Module 4                                       --
+--                Microcontroller Firmware                                   --
+--                      freq_goertzel.c                                      --
+--                                                                           --
+-------------------------------------------------------------------------------
+--
+--  Designed for:  University of Colorado at Boulder
+--
+--
+--  Designed by:  Tristan Lennertz, Subhradeep Dutta, & Omkar Prabhu
+--
+-- Version: 2.1
+-- Date of current revision:  2018-02
+-- Target Microcontroller: Freescale MKL25ZVMT4
+-- Tools used:  ARM mbed compiler
+--              ARM mbed SDK
+--              Freescale FRDM-KL25Z Freedom Board
+--
+--
+--   Functional Description:
+--   Goertzel filter bank frequency estimator. Rather than timing peaks in
+--   the time domain, the energy of each DFT bin across the expected vortex
+--   band is measured over a block of GOERTZEL_N samples, and the strongest
+--   bin is refined by interpolating with its neighbours. Broadband
+--   turbulence is spread across all bins while the vortex tone lands in
+--   one, so this keeps working at low flow where the signal to noise ratio
+--   is too poor for peak picking.
+--
+--   All per-sample arithmetic is 32-bit integer. Each sample is windowed
+--   (Hann) and fed to every bin's recurrence. At the end of a block the bin
+--   states are handed to a second bank and their powers are evaluated a few
+--   bins per sample while the next block accumulates, so no single 100 us
+--   tick carries the whole evaluation.
+--
+*/
+
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+
+#include "freq.h"
+
+/**
+ * @brief Block length in samples. A power of two; the bin spacing is
+ * fs / GOERTZEL_N (39 Hz at 10 kHz sampling).
+ */
+#define GOERTZEL_N (256)
+
+/**
+ * @brief First and last bin of the scanned band (78 Hz to 1.875 kHz). The
+ * peak must have a neighbour on each side to be interpolated, so tones are
+ * reported from bin 3 to bin 47, about 117 Hz to 1.84 kHz.
+ */
+#define GOERTZEL_BIN_MIN (2)
+#define GOERTZEL_BIN_MAX (48)
+#define GOERTZEL_BINS    (GOERTZEL_BIN_MAX - GOERTZEL_BIN_MIN + 1)
+
+/**
+ * @brief Right shift applied to the DC-removed ADC sample before filtering.
+ * Keeps the recurrence states inside 32 bits for a full scale input.
+ */
+#define GOERTZEL_INPUT_SHIFT (6)
+
+/**
+ * @brief Fractional bits of the filter coefficients and the window
+ */
+#define COEFF_FRAC_BITS  (14)
+#define WINDOW_FRAC_BITS (15)
+
+/**
+ * @brief Bin powers evaluated per sample once a block is complete
+ */
+#define GOERTZEL_EVAL_PER_TICK (4)
+
+/**
+ * @brief Right shift applied to bin powers so they fit in 32 bits
+ */
+#define GOERTZEL_POWER_SHIFT (4)
+
+/**
+ * @brief The strongest bin must carry this many times the average bin power
+ * for the block to count as a tone
+ */
+#define GOERTZEL_MIN_PEAK_RATIO (4)
+
+/**
+ * @brief Smallest tone amplitude, in ADC counts, reported as a frequency;
+ * 1/64 of the nominal sensor swing. The ratio test alone passes plain
+ * noise, whose strongest bin stands out of a quiet block just as well.
+ */
+#define GOERTZEL_MIN_AMPLITUDE (256)
+
+/**
+ * @brief Power floor for the strongest bin. The Hann window sums to N/2,
+ * so a bin centred tone of amplitude A evaluates to (A N/4 >> input shift)^2
+ * >> power shift.
+ */
+#define GOERTZEL_MIN_TONE  ((GOERTZEL_MIN_AMPLITUDE * (GOERTZEL_N / 4)) >> GOERTZEL_INPUT_SHIFT)
+#define GOERTZEL_MIN_POWER ((uint32_t)GOERTZEL_MIN_TONE * GOERTZEL_MIN_TONE >> GOERTZEL_POWER_SHIFT)
+
+/**
+ * @brief Sample rate as an integer, in Hz
+ */
+#define GOERTZEL_FS ((uint32_t)(1.0 / SAMPLE_PERIOD + 0.5))
+
+#if (GOERTZEL_N & (GOERTZEL_N - 1)) != 0
+#error "GOERTZEL_N must be a power of two"
+#endif
+
+/**
+ * @brief 2cos(2 pi k / N) for each bin, Q14
+ */
+static int32_t binCoeff[GOERTZEL_BINS];
+
+/**
+ * @brief Hann window, Q15
+ */
+static int16_t hannWindow[GOERTZEL_N];
+
+/**
+ * @brief Two banks of recurrence state: one accumulating the current block,
+ * the other holding the finished block until its powers are evaluated
+ */
+static int32_t binS1[2][GOERTZEL_BINS];
+static int32_t binS2[2][GOERTZEL_BINS];
+static uint8_t activeBank = 0;
+
+/**
+ * @brief Evaluated power of each bin of the last finished block
+ */
+static uint32_t binPower[GOERTZEL_BINS];
+
+/**
+ * @brief Next bin to evaluate, or GOERTZEL_BINS when nothing is pending
+ */
+static uint16_t evalBin = GOERTZEL_BINS;
+
+/**
+ * @brief Position within the current block
+ */
+static uint16_t blockIdx = 0;
+
+/**
+ * @brief DC level removed from samples (mean of the previous block) and the
+ * running sum that produces the next one
+ */
+static int32_t dcLevel = 0x8000;
+static uint32_t dcSum = 0;
+
+/**
+ * @brief Current best frequency estimate, in Hz
+ */
+static uint32_t goertzelEstimate = 0;
+
+/**
+ * @brief Q14 coefficient times a recurrence state. The state can exceed 2^17,
+ * so it is split to keep both partial products inside 32 bits.
+ */
+static __inline int32_t mulCoeff(int32_t coeff, int32_t s)
+{
+	return coeff * (s >> COEFF_FRAC_BITS) +
+	       ((coeff * (s & ((1 << COEFF_FRAC_BITS) - 1))) >> COEFF_FRAC_BITS);
+}
+
+/**
+ * @brief Integer square root, rounded down
+ */
+static uint32_t isqrt32(uint32_t val)
+{
+	uint32_t root = 0;
+	uint32_t bit = 1UL << 30;
+
+	while (bit > val)
+		bit >>= 2;
+
+	while (bit != 0)
+	{
+		if (val >= root + bit)
+		{
+			val -= root + bit;
+			root = (root >> 1) + bit;
+		}
+		else
+		{
+			root >>= 1;
+		}
+		bit >>= 2;
+	}
+
+	return root;
+}
+
+/**
+ * @brief Evaluates the power of one bin from its final recurrence state
+ */
+static uint32_t binPowerOf(uint8_t bank, uint16_t bin)
+{
+	int64_t s1 = binS1[bank][bin];
+	int64_t s2 = binS2[bank][bin];
+	int64_t power = s1 * s1 + s2 * s2 - ((binCoeff[bin] * s1 * s2) >> COEFF_FRAC_BITS);
+
+	if (power < 0)
+		power = 0;
+
+	return (uint32_t)(power >> GOERTZEL_POWER_SHIFT);
+}
+
+/**
+ * @brief Picks the strongest bin of the evaluated block and interpolates the
+ * tone frequency from it and its two neighbours. A block without a tone in
+ * the band reads 0 Hz: no flow.
+ */
+static void updateGoertzelEstimate(void)
+{
+	uint16_t i, peak = 0;
+	uint32_t total = 0;
+	int32_t mPrev, mPeak, mNext, denom, delta;
+
+	for (i = 0; i < GOERTZEL_BINS; i++)
+	{
+		total += binPower[i] >> 8;
+		if (binPower[i] > binPower[peak])
+			peak = i;
+	}
+
+	/* Too weak, not a clear tone, or at the band edge where it cannot be
+	   interpolated */
+	if (binPower[peak] < GOERTZEL_MIN_POWER ||
+	    (binPower[peak] >> 8) * GOERTZEL_BINS < total * GOERTZEL_MIN_PEAK_RATIO ||
+	    peak == 0 || peak == GOERTZEL_BINS - 1)
+	{
+		goertzelEstimate = 0;
+		return;
+	}
+
+	/* Hann window interpolation on bin magnitudes, offset in 1/256 bins */
+	mPrev = (int32_t)isqrt32(binPower[peak - 1]);
+	mPeak = (int32_t)isqrt32(binPower[peak]);
+	mNext = (int32_t)isqrt32(binPower[peak + 1]);
+
+	denom = mPrev + 2 * mPeak + mNext;
+	delta = denom ? ((mNext - mPrev) * 512) / denom : 0;
+	if (delta > 128)
+		delta = 128;
+	else if (delta < -128)
+		delta = -128;
+
+	goertzelEstimate = ((uint32_t)((peak + GOERTZEL_BIN_MIN) * 256 + delta) * GOERTZEL_FS +
+	                    (GOERTZEL_N * 256 / 2)) / (GOERTZEL_N * 256);
+}
+
+/**
+ * @brief Takes in the latest ADC sample and returns an updated frequency estimate
+ *
+ * @param latestValue The latest value to be sampled from the ADC
+ *
+ * @return The tone frequency of the last evaluated block, in Hz
+ *
+ * @note Must be called every SAMPLE_PERIOD seconds. The estimate is updated
+ * once per GOERTZEL_N samples.
+ */
+uint32_t goertzelFrequency(uint16_t latestValue)
+{
+	int32_t x, s0;
+	uint16_t i;
+	int32_t * s1 = binS1[activeBank];
+	int32_t * s2 = binS2[activeBank];
+
+	/* Remove DC, scale and window the sample */
+	x = ((int32_t)latestValue - dcLevel) >> GOERTZEL_INPUT_SHIFT;
+	x = (x * hannWindow[blockIdx]) >> WINDOW_FRAC_BITS;
+	dcSum += latestValue;
+
+	if (blockIdx == 0)
+	{
+		/* Fresh block: the states of the previous one live in the other bank */
+		for (i = 0; i < GOERTZEL_BINS; i++)
+		{
+			s1[i] = x;
+			s2[i] = 0;
+		}
+	}
+	else
+	{
+		for (i = 0; i < GOERTZEL_BINS; i++)
+		{
+			s0 = x + mulCoeff(binCoeff[i], s1[i]) - s2[i];
+			s2[i] = s1[i];
+			s1[i] = s0;
+		}
+	}
+
+	/* Spread the evaluation of the finished block over the following ticks */
+	if (evalBin < GOERTZEL_BINS)
+	{
+		uint8_t doneBank = activeBank ^ 1;
+
+		for (i = 0; i < GOERTZEL_EVAL_PER_TICK && evalBin < GOERTZEL_BINS; i++, evalBin++)
+			binPower[evalBin] = binPowerOf(doneBank, evalBin);
+
+		if (evalBin == GOERTZEL_BINS)
+			updateGoertzelEstimate();
+	}
+
+	/* End of block: swap banks, start evaluating, and take the new DC level */
+	if (++blockIdx == GOERTZEL_N)
+	{
+		blockIdx = 0;
+		activeBank ^= 1;
+		evalBin = 0;
+		dcLevel = (int32_t)(dcSum / GOERTZEL_N);
+		dcSum = 0;
+	}
+
+	return goertzelEstimate;
+}
+
+/**
+ * @brief Returns the Goertzel estimator to its power-on state. Computes the
+ * coefficient and window tables, the only floating point work it does.
+ */
+void resetGoertzel(void)
+{
+	uint16_t i;
+	const double pi = 3.14159265358979323846;
+
+	for (i = 0; i < GOERTZEL_BINS; i++)
+		binCoeff[i] = (int32_t)floor(2.0 * cos(2.0 * pi * (i + GOERTZEL_BIN_MIN) / GOERTZEL_N) *
+		                             (1 << COEFF_FRAC_BITS) + 0.5);
+
+	for (i = 0; i < GOERTZEL_N; i++)
+		hannWindow[i] = (int16_t)floor((0.5 - 0.5 * cos(2.0 * pi * i / GOERTZEL_N)) *
+		                               ((1 << WINDOW_FRAC_BITS) - 1) + 0.5);
+
+	memset(binS1, 0, sizeof(binS1));
+	memset(binS2, 0, sizeof(binS2));
+	memset(binPower, 0, sizeof(binPower));
+	activeBank = 0;
+	evalBin = GOERTZEL_BINS;
+	blockIdx = 0;
+	dcLevel = 0x8000;
+	dcSum = 0;
+	goertzelEstimate = 0;
+}
@@ -0,0 +1,236 @@
+/**----------------------------------------------------------------------------
+ *
+ *            \file freq_zerocross.c
+--                                                                           --
+--              ECEN 5803 Mastering Embedded System Architecture             --
+--                  Project 1 Module 4                                       --
+--                Microcontroller Firmware                                   --
+--                      freq_zerocross.c                                     --
+--                                                                           --
+-------------------------------------------------------------------------------
+--
+--  Designed for:  University of Colorado at Boulder
+--
+--
+--  Designed by:  Tristan Lennertz, Subhradeep Dutta, & Omkar Prabhu
+--
+-- Version: 2.1
+-- Date of current revision:  2018-02
+-- Target Microcontroller: Freescale MKL25ZVMT4
+-- Tools used:  ARM mbed compiler
+--              ARM mbed SDK
+--              Freescale FRDM-KL25Z Freedom Board
+--
+--
+--   Functional Description:
+--   Zero-crossing frequency estimator. The signal's DC level is tracked with
+--   a slow first order filter and rising crossings of that level are timed.
+--   The crossing instant is linearly interpolated between the two samples
+--   either side of it, so periods are resolved to 1/256 of a sample rather
+--   than the whole-sample count the peak detector is limited to. A
+--   hysteresis band confirms each crossing, so noise chattering around the
+--   DC level cannot produce extra periods.
+--
+--   The per-sample work is a filter update and a comparison; the divisions
+--   happen once per crossing.
+--
+*/
+
+#include <stdint.h>
+
+#include "freq.h"
+
+/**
+ * @brief Time constant of the DC level tracker, as a power of two in samples
+ * (2^12 samples = 0.41 s at 10 kHz)
+ */
+#define ZC_DC_SHIFT (12)
+
+/**
+ * @brief Fractional bits of crossing times and of the DC level
+ */
+#define ZC_FRAC_BITS (8)
+
+/**
+ * @brief Number of periods averaged for the estimate, as a power of two
+ */
+#define ZC_PERIOD_AVG_SHIFT (2)
+#define ZC_PERIOD_AVG       (1 << ZC_PERIOD_AVG_SHIFT)
+
+/**
+ * @brief With no confirmed crossing for this many samples the flow is taken
+ * to have stopped and the estimate drops to zero (5 Hz at 10 kHz)
+ */
+#define ZC_MAX_PERIOD (2000)
+
+/**
+ * @brief Sample rate as an integer, in Hz
+ */
+#define ZC_FS ((uint32_t)(1.0 / SAMPLE_PERIOD + 0.5))
+
+/**
+ * @brief Half width of the hysteresis band around the DC level, ADC counts
+ */
+static int32_t zcHysteresis = ZC_HYSTERESIS;
+
+/**
+ * @brief DC level, Q(ZC_FRAC_BITS) ADC counts. Starts at mid-scale.
+ */
+static int32_t dcLevelQ = 0x8000L << ZC_FRAC_BITS;
+
+/**
+ * @brief Previous sample relative to the DC level
+ */
+static int32_t prevOffset = 0;
+
+/**
+ * @brief Set once the signal has risen through the top of the hysteresis
+ * band, cleared once it falls through the bottom
+ */
+static uint8_t signalHigh = 0;
+
+/**
+ * @brief Samples seen, the time base for crossings
+ */
+static uint32_t sampleCount = 0;
+
+/**
+ * @brief Interpolated time of the latest unconfirmed rising crossing, and
+ * whether there is one. Q(ZC_FRAC_BITS) samples.
+ */
+static uint32_t candidateTime = 0;
+static uint8_t candidateValid = 0;
+
+/**
+ * @brief Time of the last confirmed crossing, and whether there is one
+ */
+static uint32_t lastCrossTime = 0;
+static uint8_t lastCrossValid = 0;
+
+/**
+ * @brief Last ZC_PERIOD_AVG periods with their running sum and fill level
+ */
+static uint32_t periodBuff[ZC_PERIOD_AVG];
+static uint32_t periodSum = 0;
+static uint8_t periodIdx = 0;
+static uint8_t periodCount = 0;
+
+/**
+ * @brief Current best frequency estimate, in Hz
+ */
+static uint32_t zcEstimate = 0;
+
+/**
+ * @brief Records the period ending at a confirmed crossing and updates the
+ * estimate from the average of the stored periods
+ */
+static void addPeriod(uint32_t crossTime)
+{
+	if (lastCrossValid)
+	{
+		uint32_t period = crossTime - lastCrossTime;
+
+		if (periodCount == ZC_PERIOD_AVG)
+			periodSum -= periodBuff[periodIdx];
+		else
+			periodCount++;
+
+		periodBuff[periodIdx] = period;
+		periodSum += period;
+		periodIdx = (periodIdx + 1) & (ZC_PERIOD_AVG - 1);
+
+		/* f = fs / (periodSum / periodCount), periods in 1/256 samples */
+		zcEstimate = (((ZC_FS * periodCount) << ZC_FRAC_BITS) + periodSum / 2) / periodSum;
+	}
+
+	lastCrossTime = crossTime;
+	lastCrossValid = 1;
+}
+
+/**
+ * @brief Takes in the latest ADC sample and returns an updated frequency estimate
+ *
+ * @param latestValue The latest value to be sampled from the ADC
+ *
+ * @return Frequency from the average of the last few interpolated periods, Hz
+ *
+ * @note Must be called every SAMPLE_PERIOD seconds.
+ */
+uint32_t zeroCrossFrequency(uint16_t latestValue)
+{
+	int32_t offset;
+
+	/* Track the DC level, then work relative to it */
+	dcLevelQ += (((int32_t)latestValue << ZC_FRAC_BITS) - dcLevelQ) >> ZC_DC_SHIFT;
+	offset = (int32_t)latestValue - (dcLevelQ >> ZC_FRAC_BITS);
+
+	if (!signalHigh)
+	{
+		/* Rising through the DC level: interpolate where between the samples */
+		if (prevOffset < 0 && offset >= 0)
+		{
+			uint32_t frac = (uint32_t)((-prevOffset) << ZC_FRAC_BITS) / (uint32_t)(offset - prevOffset);
+
+			candidateTime = ((sampleCount - 1) << ZC_FRAC_BITS) + frac;
+			candidateValid = 1;
+		}
+
+		/* Clear of the band: the last rising crossing was a real one */
+		if (offset > zcHysteresis)
+		{
+			signalHigh = 1;
+			if (candidateValid)
+			{
+				addPeriod(candidateTime);
+				candidateValid = 0;
+			}
+		}
+	}
+	else if (offset < -zcHysteresis)
+	{
+		signalHigh = 0;
+		candidateValid = 0;
+	}
+
+	/* No crossings for too long, the vortex shedding has stopped */
+	if (lastCrossValid &&
+	    ((sampleCount << ZC_FRAC_BITS) - lastCrossTime) > ((uint32_t)ZC_MAX_PERIOD << ZC_FRAC_BITS))
+	{
+		lastCrossValid = 0;
+		periodCount = 0;
+		periodSum = 0;
+		zcEstimate = 0;
+	}
+
+	prevOffset = offset;
+	sampleCount++;
+
+	return zcEstimate;
+}
+
+/**
+ * @brief Sets the half width of the hysteresis band
+ *
+ * @param adcCounts Band half width in ADC counts, above the noise amplitude
+ */
+void setZeroCrossHysteresis(uint16_t adcCounts)
+{
+	zcHysteresis = adcCounts;
+}
+
+/**
+ * @brief Returns the zero-crossing estimator to its power-on state
+ */
+void resetZeroCross(void)
+{
+	dcLevelQ = 0x8000L << ZC_FRAC_BITS;
+	prevOffset = 0;
+	signalHigh = 0;
+	sampleCount = 0;
+	candidateValid = 0;
+	lastCrossValid = 0;
+	periodSum = 0;
+	periodIdx = 0;
+	periodCount = 0;
+	zcEstimate = 0;
+}
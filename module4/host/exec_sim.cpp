@@ -0,0 +1,197 @@
+/**----------------------------------------------------------------------------
+ *
+ *            \file exec_sim.cpp
+--                                                                           --
+--              ECEN 5803 Mastering Embedded System Architecture             --
+--                  Project 1 Module 4                                       --
+--                Host Tools                                                 --
+--                      exec_sim.cpp                                         --
+--                                                                           --
+-------------------------------------------------------------------------------
+--
+--  Designed for:  University of Colorado at Boulder
+--
+--  Designed by:  Tristan Lennertz, Subhradeep Dutta, & Omkar Prabhu
+--
+--   Functional Description:
+--   Runs the module4 executive (timer0, the super loop, serial port,
+--   monitor and frequency path) unchanged on the workstation against the
+--   virtual clock in sim/. Each loop pass is charged a fixed cost; the
+--   100 us tick and the ADC block interrupt are taken in time order between
+--   and during passes, and idle sleeps skip straight to the next one. Hours
+--   of operation run in seconds and every run is identical, so scheduling
+--   behaviour (display cadence, LED heartbeat, block loss under load) can
+--   be compared before and after a change.
+--
+--   Usage:  exec_sim [options]
+--
+--     -t <seconds>    Simulated time to run (default 60)
+--     -f <hz>         Vortex signal frequency (default 100)
+--     -n <counts>     Signal noise, rms ADC counts (default 0)
+--     -p <us>         Cost of one loop pass (default 20)
+--     -l <us>         Extra load added to every pass (default 0)
+--     -b <baud>       UART0 baud rate (default: what the firmware sets)
+--     -i <s>:<text>   Type text into the serial port at time s; \r and \n
+--                     escapes are understood, e.g. -i '0.5:NOR\r'
+--     -o <file>       Write everything sent on the serial port to a file
+--
+*/
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <chrono>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "sim.h"
+#include "shared.h"
+
+static void usage(void)
+{
+  fprintf(stderr,
+    "usage: exec_sim [-t seconds] [-f hz] [-n counts] [-p pass_us] [-l load_us]\n"
+    "                [-b baud] [-i seconds:text]... [-o uart.log]\n");
+}
+
+/**
+ * @brief Turns the \r, \n and \\ escapes typed on the command line into
+ * the characters a terminal would send
+ */
+static std::string unescape(const char * text)
+{
+  std::string out;
+
+  for (; *text != '\0'; text++)
+  {
+    if (text[0] == '\\' && text[1] == 'r')
+      out += '\r', text++;
+    else if (text[0] == '\\' && text[1] == 'n')
+      out += '\n', text++;
+    else if (text[0] == '\\' && text[1] == '\\')
+      out += '\\', text++;
+    else
+      out += *text;
+  }
+
+  return out;
+}
+
+int main(int argc, char ** argv)
+{
+  double seconds = 60.0, signalHz = 100.0, noise = 0.0;
+  double passUs = 20.0, loadUs = 0.0;
+  long baud = 0;
+  const char * outPath = NULL;
+  std::vector<std::pair<double, std::string> > inputs;
+  std::chrono::steady_clock::time_point start, stop;
+  uint64_t endCycles, passCycles, passes = 0;
+  double hostS, simS;
+  size_t n;
+  int i;
+
+  for (i = 1; i < argc; i++)
+  {
+    if (strcmp(argv[i], "-t") == 0 && i + 1 < argc)
+      seconds = atof(argv[++i]);
+    else if (strcmp(argv[i], "-f") == 0 && i + 1 < argc)
+      signalHz = atof(argv[++i]);
+    else if (strcmp(argv[i], "-n") == 0 && i + 1 < argc)
+      noise = atof(argv[++i]);
+    else if (strcmp(argv[i], "-p") == 0 && i + 1 < argc)
+      passUs = atof(argv[++i]);
+    else if (strcmp(argv[i], "-l") == 0 && i + 1 < argc)
+      loadUs = atof(argv[++i]);
+    else if (strcmp(argv[i], "-b") == 0 && i + 1 < argc)
+      baud = atol(argv[++i]);
+    else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc)
+      outPath = argv[++i];
+    else if (strcmp(argv[i], "-i") == 0 && i + 1 < argc)
+    {
+      const char * arg = argv[++i];
+      const char * colon = strchr(arg, ':');
+
+      if (colon == NULL)
+      {
+        usage();
+        return 2;
+      }
+      inputs.push_back(std::make_pair(atof(arg), unescape(colon + 1)));
+    }
+    else
+    {
+      usage();
+      return 2;
+    }
+  }
+
+  if (seconds <= 0 || signalHz <= 0 || passUs < 0 || loadUs < 0 || baud < 0)
+  {
+    usage();
+    return 2;
+  }
+
+  simReset();
+  simAdcSignal(signalHz, noise);
+  if (baud > 0)
+    simUartFixBaud((uint32_t)baud);
+  for (n = 0; n < inputs.size(); n++)
+    simUartInput((uint64_t)(inputs[n].first * SIM_CORE_HZ), inputs[n].second);
+
+  endCycles = (uint64_t)(seconds * SIM_CORE_HZ);
+  passCycles = (uint64_t)((passUs + loadUs) * SIM_CYCLES_PER_US);
+
+  start = std::chrono::steady_clock::now();
+
+  executive_init();
+  while (simNow() < endCycles)
+  {
+    simUartPassStart();
+    executive_pass();
+    simAdvance(passCycles);
+    passes++;
+  }
+
+  stop = std::chrono::steady_clock::now();
+
+  hostS = std::chrono::duration<double>(stop - start).count();
+  simS = (double)simNow() / SIM_CORE_HZ;
+
+  if (outPath != NULL)
+  {
+    FILE * fp = fopen(outPath, "wb");
+
+    if (fp == NULL)
+    {
+      fprintf(stderr, "exec_sim: cannot write %s\n", outPath);
+      return 1;
+    }
+    fwrite(simUartOutput().data(), 1, simUartOutput().size(), fp);
+    fclose(fp);
+  }
+
+  printf("simulated:        %.3f s, %llu timer0 ticks\n", simS,
+         (unsigned long long)timebaseTicks());
+  printf("host time:        %.3f s (%.0fx real time)\n", hostS, hostS > 0 ? simS / hostS : 0.0);
+  printf("loop passes:      %llu (%.1f us apart on average)\n", (unsigned long long)passes,
+         passes ? simS * 1e6 / (double)passes : 0.0);
+  printf("idle:             %.1f %%\n", 100.0 * (double)simSleepCycles() / (double)simNow());
+  printf("red LED toggles:  %llu (heartbeat due %llu)\n",
+         (unsigned long long)simPinToggles(LED_RED),
+         (unsigned long long)(timebaseTicks() / LED_TOGGLE_TICKS));
+  printf("timer events:     %u posted, %u coalesced, %u overflowed, max latency %u ticks\n",
+         (unsigned)timer_events.posted, (unsigned)timer_events.coalesced,
+         (unsigned)timer_events.overflows, (unsigned)event_latency_max);
+  printf("ADC blocks:       %u completed, %u dropped\n",
+         (unsigned)ADC_dma_block_count(), (unsigned)ADC_dma_dropped_blocks());
+  printf("frequency:        %u Hz estimated (%s), %.1f Hz signal\n",
+         (unsigned)freqLastEstimate(), freqActiveEstimator()->name, signalHz);
+  printf("serial port:      %zu bytes sent in %u DMA bursts, %u receive overruns, %u dropped\n",
+         simUartOutput().size(), (unsigned)UART_dma_bursts(), (unsigned)simUartOverruns(),
+         (unsigned)UART_dma_rx_dropped());
+
+  return 0;
+}
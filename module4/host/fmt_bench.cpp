@@ -0,0 +1,214 @@
+/**----------------------------------------------------------------------------
+ *
+ *            \file fmt_bench.cpp
+--                                                                           --
+--              ECEN 5803 Mastering Embedded System Architecture             --
+--                  Project 1 Module 4                                       --
+--                Host Tools                                                 --
+--                      fmt_bench.cpp                                        --
+--                                                                           --
+-------------------------------------------------------------------------------
+--
+--  Designed for:  University of Colorado at Boulder
+--
+--  Designed by:  Tristan Lennertz, Subhradeep Dutta, & Omkar Prabhu
+--
+--   Functional Description:
+--   Checks the firmware's number formatting (numfmt.c) against snprintf
+--   over the whole 32-bit range in steps and a few million random values,
+--   then times it against the my_itoa() it replaced and against snprintf.
+--   The per-call cycle figures come from the same numfmtBench() the
+--   monitor's F command runs on the board.
+--
+--   Usage:  fmt_bench [-n random_values] [-r reps]
+--
+*/
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <chrono>
+#include <random>
+
+#include "numfmt.h"
+#include "numfmt_bench.h"
+
+static uint64_t failures = 0;
+
+static void expect(const char * what, const char * got, const char * want)
+{
+  if (strcmp(got, want) == 0)
+    return;
+
+  if (failures < 10)
+    fprintf(stderr, "fmt_bench: %s gave \"%s\", expected \"%s\"\n", what, got, want);
+  failures++;
+}
+
+/**
+ * @brief fmtFixed's expected output, built without floating point
+ */
+static void fixedReference(int32_t v, uint8_t decimals, char * out)
+{
+  long long mag = llabs((long long)v);
+  long long scale = 1;
+  uint8_t i;
+
+  for (i = 0; i < decimals; i++)
+    scale *= 10;
+
+  if (decimals == 0)
+    sprintf(out, "%d", v);
+  else
+    sprintf(out, "%s%lld.%0*lld", v < 0 ? "-" : "", mag / scale, (int)decimals, mag % scale);
+}
+
+static void checkValue(uint32_t u, uint8_t decimals, uint8_t base)
+{
+  char got[NUMFMT_MAX_LEN + 1];
+  char want[48];
+  char * p;
+  uint32_t rest;
+  int32_t s = (int32_t)u;
+  uint8_t minDigits = (uint8_t)(decimals % 9);
+
+  fmtU32(u, got);
+  sprintf(want, "%u", u);
+  expect("fmtU32", got, want);
+
+  fmtI32(s, got);
+  sprintf(want, "%d", s);
+  expect("fmtI32", got, want);
+
+  fmtHex32(u, minDigits, got);
+  sprintf(want, "%0*X", minDigits ? (int)minDigits : 1, u);
+  expect("fmtHex32", got, want);
+
+  fmtFixed(s, decimals, got);
+  fixedReference(s, decimals, want);
+  expect("fmtFixed", got, want);
+
+  /* Any base, built the slow way */
+  p = want + sizeof(want) - 1;
+  *p = '\0';
+  rest = u;
+  do
+  {
+    *--p = "0123456789ABCDEF"[rest % base];
+    rest /= base;
+  } while (rest != 0);
+  fmtBase(u, base, got);
+  expect("fmtBase", got, p);
+}
+
+/**
+ * @brief Wall time per call of one conversion over the benchmark values
+ */
+template <typename Fn>
+static double nsPerCall(Fn fn, int reps)
+{
+  static const int32_t values[] =
+  {
+    0, 7, 42, 100, 999, 4800, 65535, 123456,
+    4800000, 16777215, 536870912, 2147483647, -1, -4096, -123456789, -2147483647
+  };
+  const size_t count = sizeof(values) / sizeof(values[0]);
+  char buf[NUMFMT_MAX_LEN + 1];
+  volatile char sink = 0;
+  auto start = std::chrono::steady_clock::now();
+  int r;
+  size_t i;
+
+  for (r = 0; r < reps; r++)
+  {
+    for (i = 0; i < count; i++)
+    {
+      fn(values[i], buf);
+      sink = sink + buf[0];
+    }
+  }
+
+  auto stop = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::nano>(stop - start).count() / ((double)reps * count);
+}
+
+int main(int argc, char ** argv)
+{
+  long randomValues = 3000000;
+  int reps = 200000;
+  cycleStats_t stats[NUMFMT_BENCH_COUNT];
+  cycleStats_t best[NUMFMT_BENCH_COUNT];
+  uint8_t mismatches = 0;
+  uint64_t u;
+  long n;
+  int i, j;
+
+  for (i = 1; i < argc; i++)
+  {
+    if (strcmp(argv[i], "-n") == 0 && i + 1 < argc)
+      randomValues = atol(argv[++i]);
+    else if (strcmp(argv[i], "-r") == 0 && i + 1 < argc)
+      reps = atoi(argv[++i]);
+    else
+    {
+      fprintf(stderr, "usage: fmt_bench [-n random_values] [-r reps]\n");
+      return 2;
+    }
+  }
+
+  /* Correctness: every value up to 2^21, steps above, then random ones */
+  std::mt19937 rng(5803);
+  for (u = 0; u <= 0xFFFFFFFFull; u += (u < (1u << 21)) ? 1 : 9973)
+    checkValue((uint32_t)u, (uint8_t)(u % 10), (uint8_t)(2 + u % 15));
+  checkValue(0xFFFFFFFFu, 9, 16);
+  checkValue(0x80000000u, 9, 10);
+  for (n = 0; n < randomValues; n++)
+  {
+    uint32_t v = rng();
+
+    checkValue(v >> (rng() % 32), (uint8_t)(rng() % 10), (uint8_t)(2 + rng() % 15));
+  }
+
+  printf("correctness:      %llu failures\n", (unsigned long long)failures);
+
+  /* Cycles per call as the board measures them, best of many runs */
+  for (i = 0; i < 1000; i++)
+  {
+    mismatches |= numfmtBench(stats);
+    for (j = 0; j < NUMFMT_BENCH_COUNT; j++)
+    {
+      if (i == 0 || stats[j].min < best[j].min)
+        best[j].min = stats[j].min;
+      if (i == 0 || cycleStatsAverage(&stats[j]) < cycleStatsAverage(&best[j]))
+      {
+        best[j].total = stats[j].total;
+        best[j].count = stats[j].count;
+      }
+    }
+  }
+
+  printf("old/new differing: %u\n", mismatches);
+  printf("host cycles per call (min/avg, best of 1000 runs):\n");
+  for (j = 0; j < NUMFMT_BENCH_COUNT; j++)
+    printf("  %-18s %5u %5u\n", numfmtBenchNames[j], best[j].min, cycleStatsAverage(&best[j]));
+
+  printf("ns per call:\n");
+  printf("  %-18s %6.1f\n", numfmtBenchNames[NUMFMT_BENCH_OLD_DEC],
+         nsPerCall([](int32_t v, char * b) { numfmtLegacyItoa(v, (uint8_t *)b, 10); }, reps));
+  printf("  %-18s %6.1f\n", numfmtBenchNames[NUMFMT_BENCH_DEC],
+         nsPerCall([](int32_t v, char * b) { fmtI32(v, b); }, reps));
+  printf("  %-18s %6.1f\n", "snprintf %d",
+         nsPerCall([](int32_t v, char * b) { snprintf(b, NUMFMT_MAX_LEN + 1, "%d", v); }, reps));
+  printf("  %-18s %6.1f\n", numfmtBenchNames[NUMFMT_BENCH_OLD_HEX],
+         nsPerCall([](int32_t v, char * b) { numfmtLegacyItoa(v, (uint8_t *)b, 16); }, reps));
+  printf("  %-18s %6.1f\n", numfmtBenchNames[NUMFMT_BENCH_HEX],
+         nsPerCall([](int32_t v, char * b) { fmtHex32((uint32_t)v, 1, b); }, reps));
+  printf("  %-18s %6.1f\n", "snprintf %X",
+         nsPerCall([](int32_t v, char * b) { snprintf(b, NUMFMT_MAX_LEN + 1, "%X", (unsigned)v); }, reps));
+  printf("  %-18s %6.1f\n", numfmtBenchNames[NUMFMT_BENCH_FIXED],
+         nsPerCall([](int32_t v, char * b) { fmtFixed(v, 2, b); }, reps));
+
+  return (failures == 0 && mismatches == 0) ? 0 : 1;
+}
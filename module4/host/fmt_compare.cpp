@@ -0,0 +1,271 @@
+/**----------------------------------------------------------------------------
+ *
+ *            \file fmt_compare.cpp
+--                                                                           --
+--              ECEN 5803 Mastering Embedded System Architecture             --
+--                  Project 1 Module 4                                       --
+--                Host Tools                                                 --
+--                      fmt_compare.cpp                                      --
+--                                                                           --
+-------------------------------------------------------------------------------
+--
+--  Designed by:  Tristan Lennertz, Subhradeep Dutta, & Omkar Prabhu
+--
+--   Functional Description:
+--   Checks the stream formatter (fmt.h) against snprintf for every
+--   conversion the firmware uses, then times both on the lines the
+--   programs actually print. Integers must match exactly, and floating
+--   point too except on exact ties, which fmt.h rounds away from zero and
+--   the C library to even. Those are counted, not failed.
+--
+--   Usage:  fmt_compare [-n random_values] [-r reps]
+--
+*/
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <chrono>
+#include <random>
+
+#include "fmt.h"
+
+/**
+ * @brief Sink filling a caller's buffer, as snprintf does
+ */
+struct BufSink
+{
+  BufSink(char * buf, size_t size) : p(buf), end(buf + size - 1) {}
+
+  void put(char c)
+  {
+    if (p < end)
+      *p++ = c;
+  }
+
+  void flush(void)
+  {
+    *p = '\0';
+  }
+
+  char * p;
+  char * end;
+};
+
+typedef fmt::Format<BufSink> BufFormat;
+
+static uint64_t failures = 0;
+static uint64_t floatTies = 0;
+
+static void expect(const char * what, const char * got, const char * want)
+{
+  if (strcmp(got, want) == 0)
+    return;
+
+  if (failures < 10)
+    fprintf(stderr, "fmt_compare: %s gave \"%s\", expected \"%s\"\n", what, got, want);
+  failures++;
+}
+
+/**
+ * @brief Floating point: the same text unless d is exactly half way
+ * between two results
+ */
+static void expectFloat(const char * got, const char * want, double d, uint8_t digits)
+{
+  long double scaled = fabsl((long double)d) * powl(10.0L, digits);
+
+  if (strcmp(got, want) != 0 && scaled - floorl(scaled) == 0.5L)
+  {
+    floatTies++;
+    return;
+  }
+
+  expect("double", got, want);
+}
+
+static void checkValue(uint32_t u, uint8_t width, uint8_t digits)
+{
+  char got[48];
+  char want[48];
+  int32_t s = (int32_t)u;
+  int64_t big = (int64_t)s * 1000003;
+
+  {
+    BufSink sink(got, sizeof(got));
+    BufFormat(sink) << u;
+  }
+  snprintf(want, sizeof(want), "%u", u);
+  expect("unsigned", got, want);
+
+  {
+    BufSink sink(got, sizeof(got));
+    BufFormat(sink) << fmt::width(width) << s;
+  }
+  snprintf(want, sizeof(want), "%*d", (int)width, s);
+  expect("int, width", got, want);
+
+  {
+    BufSink sink(got, sizeof(got));
+    BufFormat(sink) << fmt::fill('0') << fmt::width(width) << s;
+  }
+  snprintf(want, sizeof(want), "%0*d", (int)width, s);
+  expect("int, zero fill", got, want);
+
+  {
+    BufSink sink(got, sizeof(got));
+    BufFormat(sink) << fmt::hex << fmt::fill('0') << fmt::width(width) << u;
+  }
+  snprintf(want, sizeof(want), "%0*X", (int)width, u);
+  expect("hex", got, want);
+
+  {
+    BufSink sink(got, sizeof(got));
+    BufFormat(sink) << (long long)big;
+  }
+  snprintf(want, sizeof(want), "%lld", (long long)big);
+  expect("long long", got, want);
+
+  {
+    BufSink sink(got, sizeof(got));
+    BufFormat(sink) << fmt::hex << (unsigned long long)big;
+  }
+  snprintf(want, sizeof(want), "%llX", (unsigned long long)big);
+  expect("long long hex", got, want);
+
+  /* Full 64-bit range, where the digits above 10^9 take another path */
+  unsigned long long wide = ((unsigned long long)u << 32) | (uint32_t)s;
+
+  {
+    BufSink sink(got, sizeof(got));
+    BufFormat(sink) << fmt::width(width) << wide;
+  }
+  snprintf(want, sizeof(want), "%*llu", (int)width, wide);
+  expect("unsigned long long", got, want);
+
+  /* Magnitudes the programs print: volts, g, seconds, DMIPS */
+  double d = (double)s / (double)(1u << (u % 24));
+
+  {
+    BufSink sink(got, sizeof(got));
+    BufFormat(sink) << fmt::fixed(digits) << fmt::width(width) << d;
+  }
+  snprintf(want, sizeof(want), "%*.*f", (int)width, (int)digits, d);
+  expectFloat(got, want, d, digits);
+}
+
+/**
+ * @brief Wall time per line of fn over the benchmark values
+ */
+template <typename Fn>
+static double nsPerLine(Fn fn, int reps)
+{
+  static const uint32_t values[] =
+  {
+    0, 7, 42, 100, 999, 4800, 65535, 123456, 4800000, 16777215, 536870912, 4294967295u
+  };
+  const size_t count = sizeof(values) / sizeof(values[0]);
+  char buf[128];
+  volatile char keep = 0;
+  auto start = std::chrono::steady_clock::now();
+  int r;
+  size_t i;
+
+  for (r = 0; r < reps; r++)
+  {
+    for (i = 0; i < count; i++)
+    {
+      fn(values[i], buf, sizeof(buf));
+      keep = keep + buf[0];
+    }
+  }
+
+  auto stop = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::nano>(stop - start).count() / ((double)reps * count);
+}
+
+int main(int argc, char ** argv)
+{
+  long randomValues = 2000000;
+  int reps = 100000;
+  uint64_t u;
+  long n;
+  int i;
+
+  for (i = 1; i < argc; i++)
+  {
+    if (strcmp(argv[i], "-n") == 0 && i + 1 < argc)
+      randomValues = atol(argv[++i]);
+    else if (strcmp(argv[i], "-r") == 0 && i + 1 < argc)
+      reps = atoi(argv[++i]);
+    else
+    {
+      fprintf(stderr, "usage: fmt_compare [-n random_values] [-r reps]\n");
+      return 2;
+    }
+  }
+
+  std::mt19937 rng(5803);
+  for (u = 0; u <= 0xFFFFFFFFull; u += (u < (1u << 16)) ? 1 : 99991)
+    checkValue((uint32_t)u, (uint8_t)(u % 12), (uint8_t)(u % 7));
+  checkValue(0x80000000u, 11, 0);
+  checkValue(0xFFFFFFFFu, 0, 6);
+  for (n = 0; n < randomValues; n++)
+  {
+    uint32_t v = rng();
+
+    checkValue(v >> (rng() % 32), (uint8_t)(rng() % 12), (uint8_t)(rng() % 7));
+  }
+
+  printf("correctness:      %llu failures, %llu ties rounded away from zero\n",
+         (unsigned long long)failures, (unsigned long long)floatTies);
+
+  /* The status lines of ADC_module4, module3 and the accelerometer */
+  printf("ns per line:\n");
+  printf("  %-28s %7.1f\n", "fmt.h    ADC_module4 line",
+         nsPerLine([](uint32_t v, char * b, size_t size)
+         {
+           BufSink sink(b, size);
+           BufFormat(sink) << (uint16_t)v << ", " << (uint16_t)(v >> 3) << ", "
+                           << (uint16_t)(v >> 7) << ",  " << (int)(v & 0xFF) - 40
+                           << ", overruns " << v << "\n\r";
+         }, reps));
+  printf("  %-28s %7.1f\n", "snprintf ADC_module4 line",
+         nsPerLine([](uint32_t v, char * b, size_t size)
+         {
+           snprintf(b, size, "%u, %u, %u,  %d, overruns %u\n\r", (uint16_t)v,
+                    (uint16_t)(v >> 3), (uint16_t)(v >> 7), (int)(v & 0xFF) - 40, v);
+         }, reps));
+  printf("  %-28s %7.1f\n", "fmt.h    accelerometer line",
+         nsPerLine([](uint32_t v, char * b, size_t size)
+         {
+           float g = (float)(v & 0xFFFF) / 16384.0f;
+
+           BufSink sink(b, size);
+           BufFormat(sink) << fmt::fixed(1) << "\n\rX: " << g << ", Y: " << g / 2
+                           << ", Z: " << g / 4;
+         }, reps));
+  printf("  %-28s %7.1f\n", "snprintf accelerometer line",
+         nsPerLine([](uint32_t v, char * b, size_t size)
+         {
+           float g = (float)(v & 0xFFFF) / 16384.0f;
+
+           snprintf(b, size, "\n\rX: %1.1f, Y: %1.1f, Z: %1.1f", g, g / 2, g / 4);
+         }, reps));
+  printf("  %-28s %7.1f\n", "fmt.h    hex word",
+         nsPerLine([](uint32_t v, char * b, size_t size)
+         {
+           BufSink sink(b, size);
+           BufFormat(sink) << fmt::hex << fmt::fill('0') << fmt::width(8) << v;
+         }, reps));
+  printf("  %-28s %7.1f\n", "snprintf hex word",
+         nsPerLine([](uint32_t v, char * b, size_t size)
+         {
+           snprintf(b, size, "%08X", v);
+         }, reps));
+
+  return (failures == 0) ? 0 : 1;
+}
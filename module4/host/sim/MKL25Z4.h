@@ -0,0 +1,87 @@
+/**----------------------------------------------------------------------------
+ *
+ *            \file MKL25Z4.h
+--                                                                           --
+--              ECEN 5803 Mastering Embedded System Architecture             --
+--                  Project 1 Module 4                                       --
+--                Host Tools                                                 --
+--                      MKL25Z4.h                                            --
+--                                                                           --
+-------------------------------------------------------------------------------
+--
+--  Designed for:  University of Colorado at Boulder
+--
+--  Designed by:  Tristan Lennertz, Subhradeep Dutta, & Omkar Prabhu
+--
+--   Functional Description:
+--   Host simulation stand-in for the KL25Z device header, covering only
+--   the UART0 registers the serial driver touches. S1, D and C2 are
+--   proxies, so reading and writing them acts on the UART model in
+--   sim_machine.cpp the way the hardware would: reading D takes the
+--   received byte, writing D starts a transmission, writing 1 to OR in S1
+--   or clearing RE clears an overrun.
+--
+*/
+
+#ifndef SIM_MKL25Z4_H
+#define SIM_MKL25Z4_H
+
+#include <stdint.h>
+
+#include "cmsis.h"
+
+#define UARTLP_S1_TDRE_MASK (0x80u)
+#define UARTLP_S1_TC_MASK   (0x40u)
+#define UARTLP_S1_RDRF_MASK (0x20u)
+#define UARTLP_S1_OR_MASK   (0x08u)
+#define UARTLP_S1_NF_MASK   (0x04u)
+#define UARTLP_S1_FE_MASK   (0x02u)
+#define UARTLP_S1_PF_MASK   (0x01u)
+#define UARTLP_C2_TE_MASK   (0x08u)
+#define UARTLP_C2_RE_MASK   (0x04u)
+
+uint8_t simUartReadS1(void);
+void simUartWriteS1(uint8_t value);
+uint8_t simUartReadD(void);
+void simUartWriteD(uint8_t value);
+uint8_t simUartReadC2(void);
+void simUartWriteC2(uint8_t value);
+
+/**
+ * @brief UART0 status register 1, error flags write 1 to clear
+ */
+struct SimUartS1
+{
+  operator uint8_t() const { return simUartReadS1(); }
+  SimUartS1 & operator=(uint8_t value) { simUartWriteS1(value); return *this; }
+};
+
+/**
+ * @brief UART0 data register
+ */
+struct SimUartD
+{
+  operator uint8_t() const { return simUartReadD(); }
+  SimUartD & operator=(uint8_t value) { simUartWriteD(value); return *this; }
+};
+
+/**
+ * @brief UART0 control register 2
+ */
+struct SimUartC2
+{
+  operator uint8_t() const { return simUartReadC2(); }
+  SimUartC2 & operator=(uint8_t value) { simUartWriteC2(value); return *this; }
+};
+
+typedef struct
+{
+  SimUartS1 S1;
+  SimUartD D;
+  SimUartC2 C2;
+} UART0_Type;
+
+extern UART0_Type simUart0;
+#define UART0 (&simUart0)
+
+#endif /* SIM_MKL25Z4_H */
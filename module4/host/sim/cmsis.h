@@ -0,0 +1,61 @@
+/**----------------------------------------------------------------------------
+ *
+ *            \file cmsis.h
+--                                                                           --
+--              ECEN 5803 Mastering Embedded System Architecture             --
+--                  Project 1 Module 4                                       --
+--                Host Tools                                                 --
+--                      cmsis.h                                              --
+--                                                                           --
+-------------------------------------------------------------------------------
+--
+--  Designed for:  University of Colorado at Boulder
+--
+--  Designed by:  Tristan Lennertz, Subhradeep Dutta, & Omkar Prabhu
+--
+--   Functional Description:
+--   Host simulation stand-in for the CMSIS core intrinsics the firmware
+--   uses. Interrupt masking and WFI act on the virtual machine in sim.h.
+--   Usable from C and C++.
+--
+*/
+
+#ifndef SIM_CMSIS_H
+#define SIM_CMSIS_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct
+{
+	volatile uint32_t SCR;
+} SCB_Type;
+
+#define SCB_SCR_SLEEPDEEP_Msk (1UL << 2)
+
+extern SCB_Type simScb;
+#define SCB (&simScb)
+
+extern uint32_t SystemCoreClock;
+
+void simIrqDisable(void);
+void simIrqEnable(void);
+uint32_t simIrqGetMask(void);
+void simIrqSetMask(uint32_t primask);
+void simWfi(void);
+
+#define __disable_irq()     simIrqDisable()
+#define __enable_irq()      simIrqEnable()
+#define __get_PRIMASK()     simIrqGetMask()
+#define __set_PRIMASK(m)    simIrqSetMask(m)
+#define __WFI()             simWfi()
+#define __DMB()             __sync_synchronize()
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SIM_CMSIS_H */
@@ -0,0 +1,90 @@
+/**----------------------------------------------------------------------------
+ *
+ *            \file mbed.h
+--                                                                           --
+--              ECEN 5803 Mastering Embedded System Architecture             --
+--                  Project 1 Module 4                                       --
+--                Host Tools                                                 --
+--                      mbed.h                                               --
+--                                                                           --
+-------------------------------------------------------------------------------
+--
+--  Designed for:  University of Colorado at Boulder
+--
+--  Designed by:  Tristan Lennertz, Subhradeep Dutta, & Omkar Prabhu
+--
+--   Functional Description:
+--   Host simulation stand-in for the parts of the mbed SDK the executive
+--   uses: DigitalOut records writes per pin, Ticker becomes a periodic
+--   interrupt source on the virtual clock, and Serial::printf goes
+--   straight to the UART output capture.
+--
+*/
+
+#ifndef SIM_MBED_H
+#define SIM_MBED_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "MKL25Z4.h"
+#include "cmsis.h"
+
+/**
+ * @brief Pins the firmware names
+ */
+typedef enum
+{
+  PTB9,
+  LED_RED,
+  LED_GREEN,
+  LED_BLUE,
+  USBTX,
+  USBRX,
+  SIM_PIN_COUNT
+} PinName;
+
+/**
+ * @brief Output pin, every write counted by the pin model
+ */
+class DigitalOut
+{
+public:
+  DigitalOut(PinName pin);
+  DigitalOut & operator=(int value);
+  operator int();
+
+private:
+  PinName pin_;
+  int value_;
+};
+
+/**
+ * @brief Periodic callback, run as an interrupt on the virtual clock
+ */
+class Ticker
+{
+public:
+  Ticker();
+  void attach(void (*fn)(void), float seconds);
+  void attach_us(void (*fn)(void), uint32_t us);
+  void detach(void);
+
+private:
+  int source_;
+};
+
+/**
+ * @brief mbed serial port. Output is captured with the UART0 output;
+ * transmission time is not modelled. baud() sets the UART0 model's rate
+ * unless exec_sim -b has fixed it.
+ */
+class Serial
+{
+public:
+  Serial(PinName tx, PinName rx);
+  void baud(int baudrate);
+  int printf(const char * format, ...);
+};
+
+#endif /* SIM_MBED_H */
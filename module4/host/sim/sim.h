@@ -0,0 +1,79 @@
+/**----------------------------------------------------------------------------
+ *
+ *            \file sim.h
+--                                                                           --
+--              ECEN 5803 Mastering Embedded System Architecture             --
+--                  Project 1 Module 4                                       --
+--                Host Tools                                                 --
+--                      sim.h                                                --
+--                                                                           --
+-------------------------------------------------------------------------------
+--
+--  Designed for:  University of Colorado at Boulder
+--
+--  Designed by:  Tristan Lennertz, Subhradeep Dutta, & Omkar Prabhu
+--
+--   Functional Description:
+--   Virtual FRDM-KL25Z the firmware executive runs on in the host
+--   simulation. Time is a 64-bit count of core clock cycles that moves only
+--   when the simulation says so: by a modelled cost, or by a WFI skipping
+--   to the next interrupt. Interrupt sources are periodic and fire in time
+--   order whenever the clock moves with interrupts unmasked, so a run is
+--   the same on every host and every time.
+--
+--   The stub mbed.h, MKL25Z4.h, cmsis.h and us_ticker_api.h in this
+--   directory map the firmware's hardware accesses onto this machine.
+--
+*/
+
+#ifndef SIM_H
+#define SIM_H
+
+#include <stdint.h>
+
+#include <string>
+
+/**
+ * @brief Core clock of the modelled KL25Z
+ */
+#define SIM_CORE_HZ (48000000ULL)
+
+/**
+ * @brief Core cycles in a microsecond
+ */
+#define SIM_CYCLES_PER_US (SIM_CORE_HZ / 1000000ULL)
+
+/**
+ * @brief Identifies an interrupt source for simSourceStart()/simSourceStop()
+ */
+typedef int simSource_t;
+
+/* Virtual clock and interrupts (sim_machine.cpp) */
+void simReset(void);
+uint64_t simNow(void);
+void simAdvance(uint64_t cycles);
+void simWaitForInterrupt(void);
+simSource_t simSourceAdd(const char * name, void (*isr)(void));
+void simSourceStart(simSource_t source, uint64_t firstCycles, uint64_t periodCycles);
+void simSourceStop(simSource_t source);
+uint64_t simSourceCount(simSource_t source);
+uint64_t simSleepCycles(void);
+
+/* UART0 model (sim_machine.cpp) */
+void simUartSetBaud(uint32_t baud);
+void simUartFixBaud(uint32_t baud);
+void simUartInput(uint64_t atCycle, const std::string & text);
+uint64_t simUartNextRx(void);
+uint64_t simUartTxDone(void);
+std::string & simUartOutput(void);
+uint32_t simUartOverruns(void);
+void simUartPassStart(void);
+
+/* Pin model (sim_machine.cpp) */
+uint64_t simPinWrites(int pin);
+uint64_t simPinToggles(int pin);
+
+/* Vortex signal fed to the ADC model (sim_adc.cpp) */
+void simAdcSignal(double hz, double noise);
+
+#endif /* SIM_H */
@@ -0,0 +1,170 @@
+/**----------------------------------------------------------------------------
+ *
+ *            \file sim_adc.cpp
+--                                                                           --
+--              ECEN 5803 Mastering Embedded System Architecture             --
+--                  Project 1 Module 4                                       --
+--                Host Tools                                                 --
+--                      sim_adc.cpp                                          --
+--                                                                           --
+-------------------------------------------------------------------------------
+--
+--  Designed for:  University of Colorado at Boulder
+--
+--  Designed by:  Tristan Lennertz, Subhradeep Dutta, & Omkar Prabhu
+--
+--   Functional Description:
+--   Host simulation of adc_dma.cpp and adc_cal.cpp. The TPM1, ADC0 and DMA
+--   chain is replaced by an interrupt source that fires once per block
+--   time and fills the block with the next ADC_DMA_BLOCK_SIZE samples of a
+--   synthetic vortex signal. The hand-over to the main loop, and the
+--   dropping of a block when the loop still holds the previous one, are
+--   the same as on the board. Calibration always reports a restore.
+--
+*/
+
+#include <stdint.h>
+#include <stddef.h>
+#include <math.h>
+
+#include <random>
+
+#include "sim.h"
+#include "freq.h"
+#include "adc_dma.h"
+#include "adc_cal.h"
+
+/**
+ * @brief readyBlock value when the main loop has nothing to process
+ */
+#define NO_BLOCK (0xFF)
+
+static uint16_t adcBlocks[2][ADC_DMA_BLOCK_SIZE];
+static uint8_t fillBlock = 0;
+static uint8_t readyBlock = NO_BLOCK;
+static uint32_t blockCount = 0;
+static uint32_t droppedBlocks = 0;
+
+/**
+ * @brief Signal: sine of signalHz, half of full scale around mid-scale,
+ * plus gaussian noise of signalNoise counts rms. The noise generator has a
+ * fixed seed, so every run sees the same samples.
+ */
+static double signalHz = 100.0;
+static double signalNoise = 0.0;
+static uint64_t sampleIndex = 0;
+static std::mt19937 rng(5803);
+
+void simAdcSignal(double hz, double noise)
+{
+  signalHz = hz;
+  signalNoise = noise;
+}
+
+static uint16_t nextSample(void)
+{
+  double t = (double)sampleIndex++ * SAMPLE_PERIOD;
+  double v = 32768.0 + 16384.0 * sin(2.0 * M_PI * signalHz * t);
+
+  if (signalNoise > 0)
+  {
+    std::normal_distribution<double> gauss(0.0, signalNoise);
+    v += gauss(rng);
+  }
+
+  if (v < 0)
+    v = 0;
+  else if (v > 65535)
+    v = 65535;
+
+  return (uint16_t)lrint(v);
+}
+
+/**
+ * @brief Block complete interrupt, once per ADC_DMA_BLOCK_SIZE samples
+ */
+static void blockIsr(void)
+{
+  uint16_t i;
+
+  for (i = 0; i < ADC_DMA_BLOCK_SIZE; i++)
+    adcBlocks[fillBlock][i] = nextSample();
+
+  blockCount++;
+
+  if (readyBlock != NO_BLOCK)
+    droppedBlocks++;
+  else
+  {
+    readyBlock = fillBlock;
+    fillBlock ^= 1;
+  }
+}
+
+void ADC_dma_init(void)
+{
+  uint64_t blockCycles = (uint64_t)(SAMPLE_PERIOD * SIM_CORE_HZ + 0.5) * ADC_DMA_BLOCK_SIZE;
+  simSource_t source = simSourceAdd("adc_dma", blockIsr);
+
+  fillBlock = 0;
+  readyBlock = NO_BLOCK;
+  simSourceStart(source, blockCycles, blockCycles);
+}
+
+uint8_t ADC_dma_recalibrate(void)
+{
+  return ADC_CAL_CALIBRATED;
+}
+
+const uint16_t * ADC_dma_get_block(void)
+{
+  if (readyBlock == NO_BLOCK)
+    return NULL;
+
+  return adcBlocks[readyBlock];
+}
+
+void ADC_dma_release_block(void)
+{
+  readyBlock = NO_BLOCK;
+}
+
+uint32_t ADC_dma_block_count(void)
+{
+  return blockCount;
+}
+
+uint32_t ADC_dma_dropped_blocks(void)
+{
+  return droppedBlocks;
+}
+
+uint32_t ADC_dma_error_count(void)
+{
+  return 0;
+}
+
+uint8_t ADC_cal_init(void)
+{
+  return ADC_CAL_RESTORED;
+}
+
+uint8_t ADC_cal_calibrate(void)
+{
+  return ADC_CAL_CALIBRATED;
+}
+
+uint8_t ADC_cal_last_result(void)
+{
+  return ADC_CAL_RESTORED;
+}
+
+uint32_t ADC_cal_last_us(void)
+{
+  return 0;
+}
+
+uint32_t ADC_cal_full_us(void)
+{
+  return 0;
+}
@@ -0,0 +1,564 @@
+/**----------------------------------------------------------------------------
+ *
+ *            \file sim_machine.cpp
+--                                                                           --
+--              ECEN 5803 Mastering Embedded System Architecture             --
+--                  Project 1 Module 4                                       --
+--                Host Tools                                                 --
+--                      sim_machine.cpp                                      --
+--                                                                           --
+-------------------------------------------------------------------------------
+--
+--  Designed for:  University of Colorado at Boulder
+--
+--  Designed by:  Tristan Lennertz, Subhradeep Dutta, & Omkar Prabhu
+--
+--   Functional Description:
+--   The virtual machine behind sim.h: clock, interrupt sources, PRIMASK,
+--   WFI, the UART0 model and the pin model.
+--
+--   Interrupts all share one priority and never nest, like timer0 and the
+--   ADC block interrupt on the board. One that falls due while masked, or
+--   while another is running, is taken as soon as that ends.
+--
+--   The UART runs at a set baud rate, 10 bit times per character. A write
+--   to D is sent from a one byte buffer into the shift register, so TDRE
+--   clears only when a character is waiting behind the one being shifted
+--   and TC clears until both are out. Received bytes arrive at their
+--   scheduled time; one that arrives with the previous still unread is
+--   lost and sets OR. Code that keeps polling S1 while waiting for the
+--   transmitter (UART_direct_msg_put) is fast-forwarded to the end of the
+--   transmission, with interrupts taken on the way as they would be.
+--
+*/
+
+#include <stdint.h>
+#include <stdarg.h>
+#include <stdio.h>
+
+#include <deque>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "sim.h"
+#include "mbed.h"
+#include "us_ticker_api.h"
+
+/**
+ * @brief Reads of S1 in one loop pass, with no data register access in
+ * between, after which the code is taken to be spinning on the UART
+ */
+static const int SPIN_READS = 8;
+
+/**
+ * @brief One periodic interrupt source
+ */
+struct Source
+{
+  std::string name;
+  void (*isr)(void);
+  uint64_t due;        /* cycle it next fires on */
+  uint64_t period;     /* cycles between firings */
+  bool running;
+  uint64_t count;      /* times fired */
+};
+
+static std::vector<Source> sources;
+static uint64_t now = 0;
+static bool masked = false;
+static bool inIsr = false;
+static uint64_t sleepCycles = 0;
+
+SCB_Type simScb;
+uint32_t SystemCoreClock = (uint32_t)SIM_CORE_HZ;
+
+/* UART0 model state */
+static uint64_t charCycles = SIM_CORE_HZ * 10 / 9600;
+static bool baudFixed = false;
+static std::deque<std::pair<uint64_t, uint8_t> > rxQueue;
+static bool rxFull = false;
+static uint8_t rxData = 0;
+static bool rxOverrun = false;
+static uint32_t rxOverruns = 0;
+static uint64_t txDoneAt = 0;
+static uint8_t uartC2 = UARTLP_C2_TE_MASK | UARTLP_C2_RE_MASK;
+static int spinReads = 0;
+static std::string uartOutput;
+
+UART0_Type simUart0;
+
+/* Pin model state */
+static int pinValue[SIM_PIN_COUNT];
+static uint64_t pinWrites[SIM_PIN_COUNT];
+static uint64_t pinToggles[SIM_PIN_COUNT];
+
+/**
+ * @brief Index of the running source due first, or -1. Ties go to the
+ * source added first.
+ */
+static int nextSource(void)
+{
+  int best = -1;
+  size_t i;
+
+  for (i = 0; i < sources.size(); i++)
+  {
+    if (sources[i].running && (best < 0 || sources[i].due < sources[best].due))
+      best = (int)i;
+  }
+
+  return best;
+}
+
+/**
+ * @brief Takes every interrupt due by the given cycle, in time order,
+ * unless interrupts are masked or one is already running
+ */
+static void dispatch(uint64_t until)
+{
+  while (!masked && !inIsr)
+  {
+    int i = nextSource();
+
+    if (i < 0 || sources[i].due > until)
+      break;
+
+    if (sources[i].due > now)
+      now = sources[i].due;
+
+    sources[i].due += sources[i].period;
+    sources[i].count++;
+
+    inIsr = true;
+    sources[i].isr();
+    inIsr = false;
+  }
+}
+
+/**
+ * @brief Back to cycle 0 with no interrupt sources, an idle UART and all
+ * pins low. Firmware globals are not touched, so one process runs one
+ * simulation.
+ */
+void simReset(void)
+{
+  sources.clear();
+  now = 0;
+  masked = false;
+  inIsr = false;
+  sleepCycles = 0;
+
+  baudFixed = false;
+  rxQueue.clear();
+  rxFull = false;
+  rxOverrun = false;
+  rxOverruns = 0;
+  txDoneAt = 0;
+  uartC2 = UARTLP_C2_TE_MASK | UARTLP_C2_RE_MASK;
+  spinReads = 0;
+  uartOutput.clear();
+
+  for (int pin = 0; pin < SIM_PIN_COUNT; pin++)
+  {
+    pinValue[pin] = 0;
+    pinWrites[pin] = 0;
+    pinToggles[pin] = 0;
+  }
+}
+
+/**
+ * @brief Core cycles since simReset()
+ */
+uint64_t simNow(void)
+{
+  return now;
+}
+
+/**
+ * @brief Moves the clock on, as if the CPU had spent the cycles running,
+ * taking the interrupts that fall due on the way
+ */
+void simAdvance(uint64_t cycles)
+{
+  uint64_t target = now + cycles;
+
+  dispatch(target);
+  now = target;
+}
+
+/**
+ * @brief WFI: moves the clock to the next interrupt. The interrupt itself
+ * is taken once it is unmasked.
+ */
+void simWaitForInterrupt(void)
+{
+  int i = nextSource();
+
+  if (i >= 0 && sources[i].due > now)
+  {
+    sleepCycles += sources[i].due - now;
+    now = sources[i].due;
+  }
+}
+
+/**
+ * @brief Registers an interrupt source, initially stopped
+ */
+simSource_t simSourceAdd(const char * name, void (*isr)(void))
+{
+  Source s;
+
+  s.name = name;
+  s.isr = isr;
+  s.due = 0;
+  s.period = 1;
+  s.running = false;
+  s.count = 0;
+  sources.push_back(s);
+
+  return (simSource_t)(sources.size() - 1);
+}
+
+/**
+ * @brief Starts a source firing firstCycles from now, then every
+ * periodCycles
+ */
+void simSourceStart(simSource_t source, uint64_t firstCycles, uint64_t periodCycles)
+{
+  sources[source].due = now + firstCycles;
+  sources[source].period = periodCycles ? periodCycles : 1;
+  sources[source].running = true;
+}
+
+void simSourceStop(simSource_t source)
+{
+  sources[source].running = false;
+}
+
+/**
+ * @brief Number of times a source has fired
+ */
+uint64_t simSourceCount(simSource_t source)
+{
+  return sources[source].count;
+}
+
+/**
+ * @brief Cycles skipped by WFI
+ */
+uint64_t simSleepCycles(void)
+{
+  return sleepCycles;
+}
+
+/*********************************/
+/*     CMSIS and mbed HAL        */
+/*********************************/
+
+extern "C" void simIrqDisable(void)
+{
+  masked = true;
+}
+
+extern "C" void simIrqEnable(void)
+{
+  masked = false;
+  dispatch(now);
+}
+
+extern "C" uint32_t simIrqGetMask(void)
+{
+  return masked ? 1 : 0;
+}
+
+extern "C" void simIrqSetMask(uint32_t primask)
+{
+  masked = (primask & 1) != 0;
+  dispatch(now);
+}
+
+extern "C" void simWfi(void)
+{
+  simWaitForInterrupt();
+}
+
+/**
+ * @brief SysTick, which runs from the core clock and so stands still
+ * while WFI sleeps: the cycles awake. The microsecond ticker (PIT) runs
+ * on through sleep.
+ */
+extern "C" uint32_t simCycleCount(void)
+{
+  return (uint32_t)(now - sleepCycles);
+}
+
+extern "C" uint32_t us_ticker_read(void)
+{
+  return (uint32_t)(now / SIM_CYCLES_PER_US);
+}
+
+/*********************************/
+/*     UART0                     */
+/*********************************/
+
+/**
+ * @brief Sets the character time from the baud rate, 8N1. Ignored once
+ * simUartFixBaud() has been called.
+ */
+void simUartSetBaud(uint32_t baud)
+{
+  if (!baudFixed)
+    charCycles = SIM_CORE_HZ * 10 / (baud ? baud : 1);
+}
+
+/**
+ * @brief Sets the baud rate for the whole run, whatever the firmware asks
+ * for
+ */
+void simUartFixBaud(uint32_t baud)
+{
+  baudFixed = false;
+  simUartSetBaud(baud);
+  baudFixed = true;
+}
+
+/**
+ * @brief Schedules text to arrive on the receive line, one character
+ * time per byte, starting at the given cycle
+ */
+void simUartInput(uint64_t atCycle, const std::string & text)
+{
+  size_t i;
+
+  for (i = 0; i < text.size(); i++)
+    rxQueue.push_back(std::make_pair(atCycle + (i + 1) * charCycles, (uint8_t)text[i]));
+}
+
+/**
+ * @brief Cycle the next scheduled byte arrives on, or UINT64_MAX if no
+ * more are scheduled
+ */
+uint64_t simUartNextRx(void)
+{
+  return rxQueue.empty() ? UINT64_MAX : rxQueue.front().first;
+}
+
+/**
+ * @brief Cycle the transmitter finishes everything written to D so far
+ */
+uint64_t simUartTxDone(void)
+{
+  return txDoneAt;
+}
+
+/**
+ * @brief Everything transmitted so far, including Serial::printf output
+ */
+std::string & simUartOutput(void)
+{
+  return uartOutput;
+}
+
+/**
+ * @brief Received bytes lost because the last one had not been read
+ */
+uint32_t simUartOverruns(void)
+{
+  return rxOverruns;
+}
+
+/**
+ * @brief Called by the driver before each loop pass; restarts spin
+ * detection
+ */
+void simUartPassStart(void)
+{
+  spinReads = 0;
+}
+
+/**
+ * @brief Delivers the received bytes whose time has come
+ */
+static void rxUpdate(void)
+{
+  while (!rxQueue.empty() && rxQueue.front().first <= now)
+  {
+    if (!(uartC2 & UARTLP_C2_RE_MASK))
+      ;                          /* receiver off: the byte is never seen */
+    else if (rxFull)
+    {
+      rxOverrun = true;
+      rxOverruns++;
+    }
+    else
+    {
+      rxFull = true;
+      rxData = rxQueue.front().second;
+    }
+    rxQueue.pop_front();
+  }
+}
+
+static uint8_t s1Value(void)
+{
+  uint8_t s1 = 0;
+
+  if (txDoneAt <= now + charCycles)
+    s1 |= UARTLP_S1_TDRE_MASK;
+  if (txDoneAt <= now)
+    s1 |= UARTLP_S1_TC_MASK;
+  if (rxFull)
+    s1 |= UARTLP_S1_RDRF_MASK;
+  if (rxOverrun)
+    s1 |= UARTLP_S1_OR_MASK;
+
+  return s1;
+}
+
+uint8_t simUartReadS1(void)
+{
+  rxUpdate();
+
+  /* Polling for the transmitter to finish: skip to when it does */
+  if (++spinReads > SPIN_READS && txDoneAt > now)
+  {
+    simAdvance(txDoneAt - now);
+    rxUpdate();
+  }
+
+  return s1Value();
+}
+
+void simUartWriteS1(uint8_t value)
+{
+  if (value & UARTLP_S1_OR_MASK)
+    rxOverrun = false;
+}
+
+uint8_t simUartReadD(void)
+{
+  rxUpdate();
+  spinReads = 0;
+  rxFull = false;
+
+  return rxData;
+}
+
+void simUartWriteD(uint8_t value)
+{
+  uint64_t start = txDoneAt > now ? txDoneAt : now;
+
+  spinReads = 0;
+  txDoneAt = start + charCycles;
+  uartOutput += (char)value;
+}
+
+uint8_t simUartReadC2(void)
+{
+  return uartC2;
+}
+
+void simUartWriteC2(uint8_t value)
+{
+  /* Turning the receiver off clears an overrun */
+  if (!(value & UARTLP_C2_RE_MASK))
+    rxOverrun = false;
+
+  uartC2 = value;
+}
+
+/*********************************/
+/*     Pins                      */
+/*********************************/
+
+uint64_t simPinWrites(int pin)
+{
+  return pinWrites[pin];
+}
+
+/**
+ * @brief Writes that changed the pin's level
+ */
+uint64_t simPinToggles(int pin)
+{
+  return pinToggles[pin];
+}
+
+DigitalOut::DigitalOut(PinName pin) : pin_(pin), value_(0)
+{
+}
+
+DigitalOut & DigitalOut::operator=(int value)
+{
+  value = value ? 1 : 0;
+
+  pinWrites[pin_]++;
+  if (value != pinValue[pin_])
+    pinToggles[pin_]++;
+
+  pinValue[pin_] = value;
+  value_ = value;
+
+  return *this;
+}
+
+DigitalOut::operator int()
+{
+  return value_;
+}
+
+/*********************************/
+/*     Ticker and Serial         */
+/*********************************/
+
+Ticker::Ticker() : source_(-1)
+{
+}
+
+void Ticker::attach(void (*fn)(void), float seconds)
+{
+  attach_us(fn, (uint32_t)(seconds * 1e6f + 0.5f));
+}
+
+void Ticker::attach_us(void (*fn)(void), uint32_t us)
+{
+  uint64_t period = (uint64_t)us * SIM_CYCLES_PER_US;
+
+  /* Each attach gets a source of its own; the callback is the ISR */
+  source_ = simSourceAdd("ticker", fn);
+  simSourceStart(source_, period, period);
+}
+
+void Ticker::detach(void)
+{
+  if (source_ >= 0)
+    simSourceStop(source_);
+}
+
+Serial::Serial(PinName tx, PinName rx)
+{
+  (void)tx;
+  (void)rx;
+}
+
+void Serial::baud(int baudrate)
+{
+  simUartSetBaud((uint32_t)baudrate);
+}
+
+int Serial::printf(const char * format, ...)
+{
+  char buf[256];
+  va_list args;
+  int n;
+
+  va_start(args, format);
+  n = vsnprintf(buf, sizeof(buf), format, args);
+  va_end(args);
+
+  if (n > 0)
+    uartOutput.append(buf, (size_t)n < sizeof(buf) ? (size_t)n : sizeof(buf) - 1);
+
+  return n;
+}
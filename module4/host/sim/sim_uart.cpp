@@ -0,0 +1,175 @@
+/**----------------------------------------------------------------------------
+ *
+ *            \file sim_uart.cpp
+--                                                                           --
+--              ECEN 5803 Mastering Embedded System Architecture             --
+--                  Project 1 Module 4                                       --
+--                Host Tools                                                 --
+--                      sim_uart.cpp                                         --
+--                                                                           --
+-------------------------------------------------------------------------------
+--
+--  Designed for:  University of Colorado at Boulder
+--
+--  Designed by:  Tristan Lennertz, Subhradeep Dutta, & Omkar Prabhu
+--
+--   Functional Description:
+--   Host simulation of uart_dma.cpp. The receive interrupt is a source
+--   that fires when each scheduled byte arrives at the UART0 model and
+--   handles it the way the firmware handler does. Transmit DMA writes a
+--   whole burst to the model's data register at once, which queues the
+--   bytes back to back at the baud rate, and a second source stands in for
+--   the channel interrupt when the last of them is out. Buffer handling,
+--   the hold for direct output and the trace records are the same as on
+--   the board.
+--   UART_dma_flush() is fast-forwarded to the end of each burst, as
+--   sim_machine.cpp does for polling S1. UART_dma_busy() itself does not
+--   move time on: the main loop asks it on every idle check, and on the
+--   board that costs nothing.
+--
+--   Bytes must be scheduled with simUartInput() before UART_dma_init().
+--
+*/
+
+#include <stdint.h>
+
+#include "sim.h"
+#include "shared.h"
+#include "uart_dma.h"
+
+#define UART_RX_ERRORS (UARTLP_S1_OR_MASK | UARTLP_S1_NF_MASK | \
+                        UARTLP_S1_FE_MASK | UARTLP_S1_PF_MASK)
+
+static simSource_t rxSource = -1;
+static simSource_t txSource = -1;
+static uint32_t txBurst = 0;
+static uint64_t txBurstDone = 0;
+static uint8_t txHold = 0;
+static uint32_t burstCount = 0;
+
+/**
+ * @brief Points the receive source at the next byte to arrive
+ */
+static void rxSchedule(void)
+{
+  uint64_t next = simUartNextRx();
+
+  simSourceStop(rxSource);
+  if (next != UINT64_MAX)
+    simSourceStart(rxSource, next > simNow() ? next - simNow() : 0, 1);
+}
+
+static void rxIsr(void)
+{
+  uint8_t status = UART0->S1;
+  UCHAR c;
+
+  if (status & UART_RX_ERRORS)
+  {
+    error_count++;
+    UART0->S1 = status & UART_RX_ERRORS;
+  }
+
+  if (status & UARTLP_S1_RDRF_MASK)
+  {
+    c = UART0->D;
+    rx_ring.push(c);
+    TRACE(TRACE_UART_RX, c, rx_ring.size());
+  }
+
+  rxSchedule();
+}
+
+static void txIsr(void)
+{
+  simSourceStop(txSource);
+  TRACE(TRACE_UART_TX_DONE, txBurst, 0);
+
+  tx_ring.consume((uint16_t)txBurst);
+  txBurst = 0;
+  tx_in_progress = NO;
+
+  UART_dma_kick();
+}
+
+void UART_dma_init(void)
+{
+  rxSource = simSourceAdd("uart0_rx", rxIsr);
+  txSource = simSourceAdd("uart0_dma", txIsr);
+  txBurst = 0;
+  txHold = 0;
+
+  rxSchedule();
+}
+
+void UART_dma_kick(void)
+{
+  const UCHAR * span;
+  uint16_t count;
+  uint16_t i;
+
+  if (txBurst != 0 || txHold)
+    return;
+
+  count = tx_ring.readSpan(&span);
+  if (count == 0)
+    return;
+
+  txBurst = count;
+  for (i = 0; i < count; i++)
+    UART0->D = span[i];
+
+  txBurstDone = simUartTxDone();
+  simSourceStart(txSource, txBurstDone - simNow(), 1);
+
+  burstCount++;
+  tx_in_progress = YES;
+  TRACE(TRACE_UART_TX_START, count, burstCount);
+}
+
+uint8_t UART_dma_busy(void)
+{
+  return txBurst != 0 && simNow() < txBurstDone;
+}
+
+/**
+ * @brief Waits out the burst in progress, as a busy poll would
+ */
+static void waitBurst(void)
+{
+  if (UART_dma_busy())
+    simAdvance(txBurstDone - simNow());
+}
+
+void UART_dma_flush(void)
+{
+  if (__get_PRIMASK())
+  {
+    waitBurst();
+    return;
+  }
+
+  do
+  {
+    UART_dma_kick();
+    waitBurst();
+  } while (txBurst != 0);
+}
+
+void UART_dma_hold(uint8_t hold)
+{
+  txHold = hold;
+
+  if (!hold)
+    UART_dma_kick();
+}
+
+uint32_t UART_dma_bursts(void)
+{
+  return burstCount;
+}
+
+uint32_t UART_dma_rx_dropped(void)
+{
+  return rx_ring.dropped();
+}
@@ -0,0 +1,37 @@
+/**----------------------------------------------------------------------------
+ *
+ *            \file us_ticker_api.h
+--                                                                           --
+--              ECEN 5803 Mastering Embedded System Architecture             --
+--                  Project 1 Module 4                                       --
+--                Host Tools                                                 --
+--                      us_ticker_api.h                                      --
+--                                                                           --
+-------------------------------------------------------------------------------
+--
+--  Designed for:  University of Colorado at Boulder
+--
+--  Designed by:  Tristan Lennertz, Subhradeep Dutta, & Omkar Prabhu
+--
+--   Functional Description:
+--   Host simulation stand-in for the mbed microsecond ticker, read from
+--   the virtual clock.
+--
+*/
+
+#ifndef SIM_US_TICKER_API_H
+#define SIM_US_TICKER_API_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+uint32_t us_ticker_read(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SIM_US_TICKER_API_H */
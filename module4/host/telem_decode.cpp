@@ -0,0 +1,121 @@
+/**----------------------------------------------------------------------------
+ *
+ *            \file telem_decode.cpp
+--                                                                           --
+--              ECEN 5803 Mastering Embedded System Architecture             --
+--                  Project 1 Module 4                                       --
+--                Host Tools                                                 --
+--                      telem_decode.cpp                                     --
+--                                                                           --
+-------------------------------------------------------------------------------
+--
+--  Designed for:  University of Colorado at Boulder
+--
+--  Designed by:  Tristan Lennertz, Subhradeep Dutta, & Omkar Prabhu
+--
+--   Functional Description:
+--   Turns a binary telemetry capture (display mode BINARY) into CSV for a
+--   historian or a spreadsheet, one row per record, and reports on stderr
+--   how many records were lost or damaged on the way.
+--
+--   Usage:  telem_decode [-o records.csv] <capture|->
+--
+--     <capture>       Raw bytes from the serial port, e.g. an exec_sim -o
+--                     log or a terminal capture. "-" reads standard input,
+--                     so a live port can be piped in.
+--     -o <file>       Write the CSV there instead of standard output
+--
+*/
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <vector>
+
+#include "telem_decoder.h"
+
+static void usage(void)
+{
+  fprintf(stderr, "usage: telem_decode [-o records.csv] <capture|->\n");
+}
+
+static void writeRecords(FILE * fp, const std::vector<telemSample_t> & recs)
+{
+  for (const telemSample_t & r : recs)
+    fprintf(fp, "%u,%.6f,%u,%.4f,%.2f,%u,%u,%u\n", r.seq, (double)r.timeUs * 1e-6, r.freqHz,
+            (double)r.flow, (double)r.temp, r.adcMin, r.adcMax, r.adcMean);
+}
+
+int main(int argc, char ** argv)
+{
+  const char * inPath = NULL;
+  const char * outPath = NULL;
+  FILE * in;
+  FILE * out = stdout;
+  TelemetryDecoder decoder;
+  std::vector<telemSample_t> recs;
+  uint8_t buf[4096];
+  size_t n;
+  int i;
+
+  for (i = 1; i < argc; i++)
+  {
+    if (strcmp(argv[i], "-o") == 0 && i + 1 < argc)
+      outPath = argv[++i];
+    else if (argv[i][0] == '-' && argv[i][1] != '\0')
+    {
+      usage();
+      return 2;
+    }
+    else
+      inPath = argv[i];
+  }
+
+  if (inPath == NULL)
+  {
+    usage();
+    return 2;
+  }
+
+  in = (strcmp(inPath, "-") == 0) ? stdin : fopen(inPath, "rb");
+  if (in == NULL)
+  {
+    fprintf(stderr, "telem_decode: cannot open %s\n", inPath);
+    return 1;
+  }
+
+  if (outPath != NULL && (out = fopen(outPath, "w")) == NULL)
+  {
+    fprintf(stderr, "telem_decode: cannot write %s\n", outPath);
+    return 1;
+  }
+
+  fprintf(out, "seq,time_s,freq_hz,flow,temp_c,adc_min,adc_max,adc_mean\n");
+
+  /* Rows go out as they are decoded, so a live port can be followed */
+  while ((n = fread(buf, 1, sizeof(buf), in)) > 0)
+  {
+    recs.clear();
+    decoder.feed(buf, n, recs);
+    writeRecords(out, recs);
+    fflush(out);
+  }
+
+  if (in != stdin)
+    fclose(in);
+  if (out != stdout)
+    fclose(out);
+
+  const TelemetryDecoder::Stats & st = decoder.stats();
+  fprintf(stderr, "bytes:            %llu (%llu before the first frame)\n",
+          (unsigned long long)st.bytes, (unsigned long long)st.skipped);
+  fprintf(stderr, "frames:           %llu\n", (unsigned long long)st.frames);
+  fprintf(stderr, "records:          %llu, %llu lost in sequence gaps\n",
+          (unsigned long long)st.records, (unsigned long long)st.lost);
+  fprintf(stderr, "rejected:         %llu malformed, %llu CRC, %llu unknown type\n",
+          (unsigned long long)st.malformed, (unsigned long long)st.crcErrors,
+          (unsigned long long)st.unknown);
+
+  return 0;
+}
@@ -0,0 +1,98 @@
+/**----------------------------------------------------------------------------
+ *
+ *            \file telem_decoder.cpp
+--                                                                           --
+--              ECEN 5803 Mastering Embedded System Architecture             --
+--                  Project 1 Module 4                                       --
+--                Host Tools                                                 --
+--                      telem_decoder.cpp                                    --
+--                                                                           --
+-------------------------------------------------------------------------------
+--
+--  Designed for:  University of Colorado at Boulder
+--
+--  Designed by:  Tristan Lennertz, Subhradeep Dutta, & Omkar Prabhu
+--
+--   Functional Description:
+--   Frame splitting, CRC checking and sequence tracking for the telemetry
+--   stream. The COBS, CRC and record layout come from the firmware's
+--   telemetry.c.
+--
+*/
+
+#include "telem_decoder.h"
+
+/**
+ * @brief Longest COBS frame accepted, without the delimiter
+ */
+static const size_t FRAME_MAX = TELEM_FRAME_LIMIT - 1;
+
+void TelemetryDecoder::feed(const uint8_t * data, size_t len, std::vector<telemSample_t> & out)
+{
+  size_t i;
+
+  stats_.bytes += len;
+
+  for (i = 0; i < len; i++)
+  {
+    if (data[i] == 0)
+    {
+      if (synced_)
+        endFrame(out);
+      synced_ = true;
+      frame_.clear();
+      overlong_ = false;
+    }
+    else if (!synced_)
+      stats_.skipped++;
+    else if (frame_.size() < FRAME_MAX)
+      frame_.push_back(data[i]);
+    else
+      overlong_ = true;
+  }
+}
+
+void TelemetryDecoder::endFrame(std::vector<telemSample_t> & out)
+{
+  uint8_t raw[TELEM_FRAME_LIMIT];
+  uint16_t rawLen;
+  uint16_t crc;
+  telemSample_t rec;
+
+  if (frame_.empty())
+    return;
+  stats_.frames++;
+
+  rawLen = overlong_ ? 0 : telemCobsDecode(frame_.data(), (uint16_t)frame_.size(), raw);
+  if (rawLen < 3)
+  {
+    stats_.malformed++;
+    return;
+  }
+
+  rawLen -= 2;
+  crc = (uint16_t)(raw[rawLen] | (raw[rawLen + 1] << 8));
+  if (telemCrc16(raw, rawLen, 0xFFFF) != crc)
+  {
+    stats_.crcErrors++;
+    return;
+  }
+
+  if (!telemUnpackSample(raw, rawLen, &rec))
+  {
+    if (other_ && other_(raw, rawLen))
+      stats_.other++;
+    else
+      stats_.unknown++;
+    return;
+  }
+
+  /* The firmware numbers dropped records too, so a gap is data lost */
+  if (haveSeq_)
+    stats_.lost += (uint16_t)(rec.seq - lastSeq_ - 1);
+  haveSeq_ = true;
+  lastSeq_ = rec.seq;
+
+  stats_.records++;
+  out.push_back(rec);
+}
@@ -0,0 +1,84 @@
+/**----------------------------------------------------------------------------
+ *
+ *            \file telem_decoder.h
+--                                                                           --
+--              ECEN 5803 Mastering Embedded System Architecture             --
+--                  Project 1 Module 4                                       --
+--                Host Tools                                                 --
+--                      telem_decoder.h                                      --
+--                                                                           --
+-------------------------------------------------------------------------------
+--
+--  Designed for:  University of Colorado at Boulder
+--
+--  Designed by:  Tristan Lennertz, Subhradeep Dutta, & Omkar Prabhu
+--
+--   Functional Description:
+--   Decoder for the binary telemetry stream the firmware sends in BINARY
+--   display mode (../telemetry.h). Bytes are fed in as they arrive, in
+--   chunks of any size, and complete records come out. Everything before
+--   the first frame delimiter is skipped, as is any frame that is too long,
+--   not valid COBS or fails its CRC, so text from the monitor mixed into
+--   the stream costs at most the record it runs into. Good frames of
+--   other record types (the trace dump) go to an optional handler.
+--
+*/
+
+#ifndef TELEM_DECODER_H
+#define TELEM_DECODER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <functional>
+#include <vector>
+
+#include "telemetry.h"
+
+class TelemetryDecoder
+{
+public:
+  /**
+   * @brief Counts of what the stream has held so far
+   */
+  struct Stats
+  {
+    uint64_t bytes = 0;         /* fed in */
+    uint64_t skipped = 0;       /* before the first delimiter */
+    uint64_t frames = 0;        /* delimited, non-empty */
+    uint64_t records = 0;       /* decoded and passed the CRC */
+    uint64_t malformed = 0;     /* too long, bad COBS or too short */
+    uint64_t crcErrors = 0;
+    uint64_t other = 0;         /* good CRC, taken by the other record handler */
+    uint64_t unknown = 0;       /* good CRC, unknown record type or length */
+    uint64_t lost = 0;          /* records missing from the sequence */
+  };
+
+  /**
+   * @brief Decodes len bytes and appends the records they complete to out
+   */
+  void feed(const uint8_t * data, size_t len, std::vector<telemSample_t> & out);
+
+  /**
+   * @brief Payload (CRC removed) of each good frame that is not a sample
+   * record. The handler returns false for one it does not know either.
+   */
+  typedef std::function<bool(const uint8_t * payload, uint16_t len)> OtherHandler;
+
+  void setOtherHandler(OtherHandler handler) { other_ = handler; }
+
+  const Stats & stats() const { return stats_; }
+
+private:
+  void endFrame(std::vector<telemSample_t> & out);
+
+  std::vector<uint8_t> frame_;
+  bool synced_ = false;
+  bool overlong_ = false;
+  bool haveSeq_ = false;
+  uint16_t lastSeq_ = 0;
+  Stats stats_;
+  OtherHandler other_;
+};
+
+#endif /* TELEM_DECODER_H */
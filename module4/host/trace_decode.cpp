@@ -0,0 +1,130 @@
+/**----------------------------------------------------------------------------
+ *
+ *            \file trace_decode.cpp
+--                                                                           --
+--              ECEN 5803 Mastering Embedded System Architecture             --
+--                  Project 1 Module 4                                       --
+--                Host Tools                                                 --
+--                      trace_decode.cpp                                     --
+--                                                                           --
+-------------------------------------------------------------------------------
+--
+--  Designed for:  University of Colorado at Boulder
+--
+--  Designed by:  Tristan Lennertz, Subhradeep Dutta, & Omkar Prabhu
+--
+--   Functional Description:
+--   Prints the firmware's trace log as text, one event per line with its
+--   time in microseconds, from a serial capture holding the frames of
+--   monitor command L or from a raw RAM dump holding traceLog (found by
+--   its magic, so the dump may cover more than the log). Counts of lost
+--   and missed events go to stderr.
+--
+--   Usage:  trace_decode [-o trace.txt] <capture|dump|->
+--
+--     <capture>       Raw bytes from the serial port, e.g. an exec_sim -o
+--                     log; telemetry records and text in it are skipped
+--     <dump>          RAM read out by a debugger, e.g. OpenOCD's
+--                     dump_image over traceLog's address from the map file
+--     -               Standard input
+--     -o <file>       Write the text there instead of standard output
+--
+*/
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <string>
+#include <vector>
+
+#include "telem_decoder.h"
+#include "trace_decoder.h"
+
+static void usage(void)
+{
+  fprintf(stderr, "usage: trace_decode [-o trace.txt] <capture|dump|->\n");
+}
+
+int main(int argc, char ** argv)
+{
+  const char * inPath = NULL;
+  const char * outPath = NULL;
+  FILE * in;
+  FILE * out = stdout;
+  TelemetryDecoder telem;
+  TraceDecoder trace;
+  std::vector<telemSample_t> samples;
+  std::vector<uint8_t> data;
+  std::string err;
+  uint8_t buf[4096];
+  size_t n;
+  int i;
+
+  for (i = 1; i < argc; i++)
+  {
+    if (strcmp(argv[i], "-o") == 0 && i + 1 < argc)
+      outPath = argv[++i];
+    else if (argv[i][0] == '-' && argv[i][1] != '\0')
+    {
+      usage();
+      return 2;
+    }
+    else
+      inPath = argv[i];
+  }
+
+  if (inPath == NULL)
+  {
+    usage();
+    return 2;
+  }
+
+  in = (strcmp(inPath, "-") == 0) ? stdin : fopen(inPath, "rb");
+  if (in == NULL)
+  {
+    fprintf(stderr, "trace_decode: cannot open %s\n", inPath);
+    return 1;
+  }
+
+  while ((n = fread(buf, 1, sizeof(buf), in)) > 0)
+    data.insert(data.end(), buf, buf + n);
+  if (in != stdin)
+    fclose(in);
+
+  /* A RAM dump names itself with the log's magic; anything else is taken
+     as a serial capture */
+  if (!trace.loadDump(data.data(), data.size(), err))
+  {
+    telem.setOtherHandler([&trace](const uint8_t * p, uint16_t len)
+                          { return trace.payload(p, len); });
+    telem.feed(data.data(), data.size(), samples);
+  }
+
+  if (outPath != NULL && (out = fopen(outPath, "w")) == NULL)
+  {
+    fprintf(stderr, "trace_decode: cannot write %s\n", outPath);
+    return 1;
+  }
+
+  std::vector<TraceEvent> events = trace.events();
+  for (const TraceEvent & e : events)
+    fprintf(out, "%14.2f  %-22s %s\n", e.timeUs, TraceDecoder::name(e.rec.id),
+            TraceDecoder::text(e.rec).c_str());
+
+  if (out != stdout)
+    fclose(out);
+
+  const TraceDecoder::Stats & st = trace.stats();
+  fprintf(stderr, "source:           %s\n",
+          trace.anchored() ? "serial capture, us since start up" : "RAM dump, us from the oldest record");
+  fprintf(stderr, "dumps:            %llu\n", (unsigned long long)st.dumps);
+  fprintf(stderr, "events:           %llu, %llu lost on the way, %llu missed while frozen\n",
+          (unsigned long long)events.size(), (unsigned long long)st.lost,
+          (unsigned long long)st.missed);
+  if (st.orphans)
+    fprintf(stderr, "orphan frames:    %llu (their dump's info frame was lost)\n",
+            (unsigned long long)st.orphans);
+
+  return (st.dumps != 0) ? 0 : 1;
+}
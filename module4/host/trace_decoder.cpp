@@ -0,0 +1,234 @@
+/**----------------------------------------------------------------------------
+ *
+ *            \file trace_decoder.cpp
+--                                                                           --
+--              ECEN 5803 Mastering Embedded System Architecture             --
+--                  Project 1 Module 4                                       --
+--                Host Tools                                                 --
+--                      trace_decoder.cpp                                    --
+--                                                                           --
+-------------------------------------------------------------------------------
+--
+--  Designed for:  University of Colorado at Boulder
+--
+--  Designed by:  Tristan Lennertz, Subhradeep Dutta, & Omkar Prabhu
+--
+--   Functional Description:
+--   Trace dump reassembly, stamp unwrapping and the event dictionary. The
+--   frame layouts come from the firmware's trace.c.
+--
+*/
+
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "trace_decoder.h"
+
+#define TRACE_NAME(id, format) #id,
+#define TRACE_FORMAT(id, format) format,
+
+static const char * const traceNames[] = { TRACE_EVENTS(TRACE_NAME) };
+static const char * const traceFormats[] = { TRACE_EVENTS(TRACE_FORMAT) };
+
+const char * TraceDecoder::name(uint16_t id)
+{
+  return (id < TRACE_ID_COUNT) ? traceNames[id] : "TRACE_UNKNOWN";
+}
+
+std::string TraceDecoder::text(const traceRec_t & rec)
+{
+  char buf[160];
+
+  if (rec.id >= TRACE_ID_COUNT)
+  {
+    snprintf(buf, sizeof(buf), "unknown event %u (%u, %u)", rec.id, rec.arg16, rec.arg32);
+    return buf;
+  }
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wformat-nonliteral"
+#pragma GCC diagnostic ignored "-Wformat-extra-args"
+  snprintf(buf, sizeof(buf), traceFormats[rec.id], (unsigned)rec.arg16, (unsigned)rec.arg32);
+#pragma GCC diagnostic pop
+
+  return buf;
+}
+
+bool TraceDecoder::payload(const uint8_t * data, uint16_t len)
+{
+  traceInfo_t info;
+  traceRec_t recs[TRACE_FRAME_RECORDS];
+  uint32_t first;
+  uint8_t count;
+  uint8_t i;
+
+  if (traceUnpackInfo(data, len, &info))
+  {
+    finishDump();
+    dumps_.push_back(Dump());
+    dumps_.back().info = info;
+    open_ = true;
+    stats_.dumps++;
+    stats_.missed = info.missed;   /* a running count on the board */
+    return true;
+  }
+
+  count = traceUnpackRecords(data, len, &first, recs);
+  if (count == 0)
+    return false;
+
+  stats_.frames++;
+  stats_.records += count;
+  if (!open_)
+  {
+    stats_.orphans++;
+    return true;
+  }
+
+  for (i = 0; i < count; i++)
+    dumps_.back().recs[first + i] = recs[i];
+
+  return true;
+}
+
+bool TraceDecoder::loadDump(const uint8_t * data, size_t len, std::string & err)
+{
+  const size_t headerLen = offsetof(traceLog_t, rec);
+  traceLog_t hdr;
+  traceRec_t rec;
+  Dump dump;
+  uint32_t magic;
+  uint32_t first;
+  uint32_t i;
+  size_t at;
+
+  for (at = 0; at + headerLen <= len; at += 4)
+  {
+    memcpy(&magic, data + at, sizeof(magic));
+    if (magic != TRACE_MAGIC)
+      continue;
+
+    memcpy(&hdr, data + at, headerLen);
+    if (hdr.version != TRACE_VERSION || hdr.capacity == 0 ||
+        (hdr.capacity & (hdr.capacity - 1)) != 0 || hdr.counterMask == 0)
+      continue;
+
+    if (at + headerLen + (size_t)hdr.capacity * sizeof(traceRec_t) > len)
+    {
+      err = "trace log header found, but the dump ends inside its records";
+      return false;
+    }
+
+    finishDump();
+    memset(&dump.info, 0, sizeof(dump.info));
+    dump.info.capacity = hdr.capacity;
+    dump.info.counterMask = hdr.counterMask;
+    dump.info.clockHz = hdr.clockHz;
+    dump.info.head = hdr.head;
+    dump.info.missed = hdr.missed;
+
+    first = (hdr.head > hdr.capacity) ? hdr.head - hdr.capacity : 0;
+    for (i = first; i != hdr.head; i++)
+    {
+      memcpy(&rec, data + at + headerLen + (size_t)(i & (hdr.capacity - 1)) * sizeof(traceRec_t),
+             sizeof(rec));
+      dump.recs[i] = rec;
+    }
+
+    dumps_.push_back(dump);
+    anchored_ = false;
+    stats_.dumps++;
+    stats_.records += dump.recs.size();
+    stats_.missed = hdr.missed;
+    return true;
+  }
+
+  err = "no trace log (magic \"TRC1\") in the dump";
+  return false;
+}
+
+/**
+ * @brief Counts what the last dump announced but did not deliver
+ */
+void TraceDecoder::finishDump()
+{
+  const Dump * dump;
+  uint32_t expected;
+
+  if (!open_)
+    return;
+  open_ = false;
+
+  dump = &dumps_.back();
+  expected = (dump->info.head > dump->info.capacity) ? dump->info.capacity : dump->info.head;
+  if (dump->recs.size() < expected)
+    stats_.lost += expected - dump->recs.size();
+}
+
+/**
+ * @brief Times a dump's records by walking back from the newest, each
+ * step taken as signed within the counter's range
+ */
+void TraceDecoder::timeDump(const Dump & dump, bool anchor, std::map<uint32_t, TraceEvent> & out)
+{
+  const uint64_t range = (uint64_t)dump.info.counterMask + 1;
+  const double usPerCycle = 1e6 / (dump.info.clockHz ? dump.info.clockHz : 48000000.0);
+  uint32_t later;
+  bool haveLater = anchor;
+  double back = 0;
+  int64_t step;
+  double origin;
+  TraceEvent ev;
+
+  if (dump.recs.empty())
+    return;
+
+  later = anchor ? dump.info.frozenStamp : dump.recs.rbegin()->second.stamp;
+  std::vector<std::pair<uint32_t, double> > backs;
+
+  for (auto it = dump.recs.rbegin(); it != dump.recs.rend(); ++it)
+  {
+    step = (int64_t)((later - it->second.stamp) & dump.info.counterMask);
+    if ((uint64_t)step > range / 2)
+      step -= (int64_t)range;
+    back += (double)step * usPerCycle;
+
+    /* The counter stops while the core sleeps, so the time slept lies
+       between an idle record and the one after it on top of the cycles */
+    if (it->second.id == TRACE_IDLE && haveLater)
+      back += (double)it->second.arg32;
+
+    later = it->second.stamp;
+    haveLater = true;
+    backs.push_back(std::make_pair(it->first, back));
+  }
+
+  /* Anchored at the freeze, otherwise from the oldest record */
+  origin = anchor ? (double)dump.info.frozenUs : backs.back().second;
+
+  for (const auto & b : backs)
+  {
+    ev.index = b.first;
+    ev.timeUs = origin - b.second;
+    ev.usPerCycle = usPerCycle;
+    ev.rec = dump.recs.at(b.first);
+    out[ev.index] = ev;
+  }
+}
+
+std::vector<TraceEvent> TraceDecoder::events()
+{
+  std::map<uint32_t, TraceEvent> byIndex;
+  std::vector<TraceEvent> out;
+
+  finishDump();
+
+  for (const auto & dump : dumps_)
+    timeDump(dump, anchored_, byIndex);
+
+  for (const auto & e : byIndex)
+    out.push_back(e.second);
+
+  return out;
+}
@@ -0,0 +1,121 @@
+/**----------------------------------------------------------------------------
+ *
+ *            \file trace_decoder.h
+--                                                                           --
+--              ECEN 5803 Mastering Embedded System Architecture             --
+--                  Project 1 Module 4                                       --
+--                Host Tools                                                 --
+--                      trace_decoder.h                                      --
+--                                                                           --
+-------------------------------------------------------------------------------
+--
+--  Designed for:  University of Colorado at Boulder
+--
+--  Designed by:  Tristan Lennertz, Subhradeep Dutta, & Omkar Prabhu
+--
+--   Functional Description:
+--   Rebuilds the firmware's trace log (../trace.h) from the frames of
+--   monitor command L in a serial capture, or from a RAM dump holding
+--   traceLog, and turns the records into timed, readable events with the
+--   format strings of ../trace_ids.h.
+--
+--   Stamps are unwrapped record to record, taking each step as signed so
+--   an interrupt's record stamped before the one it preempted comes out
+--   right. The counter stops while the core sleeps, so the microseconds
+--   each idle record says were slept are added between it and the record
+--   after it. A dump from the serial port carries the cycle counter and time
+--   since start up at the moment it froze, so its events get times since
+--   start up (to the 100 us tick the anchor was read at, with cycle
+--   resolution between events). A RAM dump has no anchor, and its times
+--   count from its oldest record.
+--
+*/
+
+#ifndef TRACE_DECODER_H
+#define TRACE_DECODER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "trace.h"
+
+/**
+ * @brief One decoded event
+ */
+struct TraceEvent
+{
+  uint32_t index;       /* records written before it since start up */
+  double timeUs;        /* see anchored */
+  double usPerCycle;    /* to turn cycle counts in its arguments into time */
+  traceRec_t rec;
+};
+
+class TraceDecoder
+{
+public:
+  /**
+   * @brief Counts of what has been decoded so far
+   */
+  struct Stats
+  {
+    uint64_t dumps = 0;         /* info frames, or 1 for a RAM dump */
+    uint64_t frames = 0;        /* records frames */
+    uint64_t records = 0;       /* records received, repeats included */
+    uint64_t lost = 0;          /* records a dump announced but did not deliver */
+    uint64_t missed = 0;        /* events the firmware dropped while frozen, as of the last dump */
+    uint64_t orphans = 0;       /* records frames before any info frame */
+  };
+
+  /**
+   * @brief A telemetry payload (TelemetryDecoder's other record handler)
+   *
+   * @return true if it was a trace payload
+   */
+  bool payload(const uint8_t * data, uint16_t len);
+
+  /**
+   * @brief Finds traceLog by its magic anywhere in a RAM dump and loads it
+   *
+   * @return false, with the reason in err, if no valid log was found
+   */
+  bool loadDump(const uint8_t * data, size_t len, std::string & err);
+
+  /**
+   * @brief Every event received, oldest first, each record once however
+   * many dumps held it. Call once the input is done.
+   */
+  std::vector<TraceEvent> events();
+
+  /**
+   * @brief Whether event times count from start up (serial dumps) or
+   * from the oldest record (a RAM dump)
+   */
+  bool anchored() const { return anchored_; }
+
+  const Stats & stats() const { return stats_; }
+
+  /* Dictionary, from trace_ids.h */
+  static const char * name(uint16_t id);
+  static std::string text(const traceRec_t & rec);
+
+private:
+  struct Dump
+  {
+    traceInfo_t info;
+    std::map<uint32_t, traceRec_t> recs;
+  };
+
+  void finishDump();
+  void timeDump(const Dump & dump, bool anchor, std::map<uint32_t, TraceEvent> & out);
+
+  std::vector<Dump> dumps_;
+  bool open_ = false;           /* the last dump may still get records */
+  bool anchored_ = true;
+  Stats stats_;
+};
+
+#endif /* TRACE_DECODER_H */
@@ -0,0 +1,330 @@
+/**----------------------------------------------------------------------------
+ *
+ *            \file trace_json.cpp
+--                                                                           --
+--              ECEN 5803 Mastering Embedded System Architecture             --
+--                  Project 1 Module 4                                       --
+--                Host Tools                                                 --
+--                      trace_json.cpp                                       --
+--                                                                           --
+-------------------------------------------------------------------------------
+--
+--  Designed for:  University of Colorado at Boulder
+--
+--  Designed by:  Tristan Lennertz, Subhradeep Dutta, & Omkar Prabhu
+--
+--   Functional Description:
+--   Converts the firmware's trace log into Chrome trace event JSON, which
+--   chrome://tracing and the Perfetto UI (ui.perfetto.dev) both open, to
+--   see how the 100 us tick, the super loop stages, the sleeps between
+--   them and the serial port interleave. It is the vendor-neutral
+--   counterpart of the Keil Event Recorder view (EventRecorderStub.scvd),
+--   working from the same serial captures or RAM dumps as trace_decode.
+--
+--   One track per source:
+--     timer0        each tick as a slice of its measured length, task
+--                   overruns as instants
+--     super loop    serial, chk_UART_msg, monitor and freq_block as
+--                   slices, and idle for each sleep
+--     UART tx       each DMA burst from its start to its interrupt
+--     UART rx       each byte received, as an instant
+--     frequency     peaks and resets as instants, peak level and
+--                   prominence as counters
+--
+--   Usage:  trace_json [-o trace.json] <capture|dump|->
+--
+--     <capture>       Raw bytes from the serial port holding the frames of
+--                     monitor command L, e.g. an exec_sim -o log
+--     <dump>          RAM read out by a debugger, holding traceLog
+--     -               Standard input
+--     -o <file>       Write the JSON there instead of standard output
+--
+*/
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <string>
+#include <vector>
+
+#include "profile.h"
+#include "telem_decoder.h"
+#include "trace_decoder.h"
+
+/**
+ * @brief Tracks, as Chrome trace thread ids
+ */
+enum
+{
+  TRACK_TIMER0 = 1,
+  TRACK_LOOP,
+  TRACK_UART_TX,
+  TRACK_UART_RX,
+  TRACK_FREQ,
+  TRACK_OTHER
+};
+
+static const char * const trackNames[] =
+{
+  "", "timer0", "super loop", "UART tx", "UART rx", "frequency", "other"
+};
+
+/**
+ * @brief Writes the events, comma separated, as the traceEvents array
+ */
+class JsonWriter
+{
+public:
+  explicit JsonWriter(FILE * fp) : fp_(fp), first_(true) {}
+
+  /* Starts an event; the caller adds its fields and closes the brace */
+  void begin(const char * ph, const char * name, int tid, double ts)
+  {
+    fprintf(fp_, "%s\n{\"ph\":\"%s\",\"name\":\"%s\",\"pid\":1,\"tid\":%d,\"ts\":%.3f",
+            first_ ? "" : ",", ph, name, tid, ts);
+    first_ = false;
+  }
+
+  void slice(const char * name, int tid, double ts, double dur, const std::string & args)
+  {
+    begin("X", name, tid, ts);
+    fprintf(fp_, ",\"dur\":%.3f,\"args\":{%s}}", dur, args.c_str());
+  }
+
+  void instant(const char * name, int tid, double ts, const std::string & args)
+  {
+    begin("i", name, tid, ts);
+    fprintf(fp_, ",\"s\":\"t\",\"args\":{%s}}", args.c_str());
+  }
+
+  void counter(const char * name, double ts, const char * series, uint32_t value)
+  {
+    begin("C", name, TRACK_FREQ, ts);
+    fprintf(fp_, ",\"args\":{\"%s\":%u}}", series, value);
+  }
+
+  void metadata(const char * what, int tid, const char * key, const char * value)
+  {
+    fprintf(fp_, "%s\n{\"ph\":\"M\",\"name\":\"%s\",\"pid\":1,\"tid\":%d,\"args\":{\"%s\":%s}}",
+            first_ ? "" : ",", what, tid, key, value);
+    first_ = false;
+  }
+
+private:
+  FILE * fp_;
+  bool first_;
+};
+
+/**
+ * @brief "key":value pairs for args
+ */
+static std::string arg(const char * key, uint32_t value)
+{
+  char buf[48];
+
+  snprintf(buf, sizeof(buf), "\"%s\":%u", key, value);
+  return buf;
+}
+
+static std::string arg(const char * key, const std::string & value)
+{
+  std::string out = "\"";
+
+  out += key;
+  out += "\":\"";
+  for (char c : value)
+  {
+    if (c == '"' || c == '\\')
+      out += '\\';
+    out += c;
+  }
+  return out + "\"";
+}
+
+static void usage(void)
+{
+  fprintf(stderr, "usage: trace_json [-o trace.json] <capture|dump|->\n");
+}
+
+int main(int argc, char ** argv)
+{
+  const char * inPath = NULL;
+  const char * outPath = NULL;
+  FILE * in;
+  FILE * out = stdout;
+  TelemetryDecoder telem;
+  TraceDecoder trace;
+  std::vector<telemSample_t> samples;
+  std::vector<uint8_t> data;
+  std::string err;
+  uint8_t buf[4096];
+  size_t n;
+  int i;
+
+  for (i = 1; i < argc; i++)
+  {
+    if (strcmp(argv[i], "-o") == 0 && i + 1 < argc)
+      outPath = argv[++i];
+    else if (argv[i][0] == '-' && argv[i][1] != '\0')
+    {
+      usage();
+      return 2;
+    }
+    else
+      inPath = argv[i];
+  }
+
+  if (inPath == NULL)
+  {
+    usage();
+    return 2;
+  }
+
+  in = (strcmp(inPath, "-") == 0) ? stdin : fopen(inPath, "rb");
+  if (in == NULL)
+  {
+    fprintf(stderr, "trace_json: cannot open %s\n", inPath);
+    return 1;
+  }
+
+  while ((n = fread(buf, 1, sizeof(buf), in)) > 0)
+    data.insert(data.end(), buf, buf + n);
+  if (in != stdin)
+    fclose(in);
+
+  /* As trace_decode: a RAM dump by its magic, otherwise a serial capture */
+  if (!trace.loadDump(data.data(), data.size(), err))
+  {
+    telem.setOtherHandler([&trace](const uint8_t * p, uint16_t len)
+                          { return trace.payload(p, len); });
+    telem.feed(data.data(), data.size(), samples);
+  }
+
+  std::vector<TraceEvent> events = trace.events();
+  const TraceDecoder::Stats & st = trace.stats();
+  if (events.empty())
+  {
+    fprintf(stderr, "trace_json: no trace events in %s\n", inPath);
+    return 1;
+  }
+
+  if (outPath != NULL && (out = fopen(outPath, "w")) == NULL)
+  {
+    fprintf(stderr, "trace_json: cannot write %s\n", outPath);
+    return 1;
+  }
+
+  JsonWriter json(out);
+  char quoted[64];
+  double burstStart = 0;
+  bool burstOpen = false;
+  uint64_t unmatched = 0;
+  uint32_t next = events.front().index;
+
+  fprintf(out, "{\"displayTimeUnit\":\"ns\",\n\"otherData\":{\"source\":\"%s\","
+          "\"lost\":%llu,\"missed\":%llu},\n\"traceEvents\":[",
+          trace.anchored() ? "serial capture" : "RAM dump",
+          (unsigned long long)st.lost, (unsigned long long)st.missed);
+
+  json.metadata("process_name", 0, "name", "\"flowmeter\"");
+  for (i = TRACK_TIMER0; i <= TRACK_OTHER; i++)
+  {
+    snprintf(quoted, sizeof(quoted), "\"%s\"", trackNames[i]);
+    json.metadata("thread_name", i, "name", quoted);
+    snprintf(quoted, sizeof(quoted), "%d", i);
+    json.metadata("thread_sort_index", i, "sort_index", quoted);
+  }
+
+  for (const TraceEvent & e : events)
+  {
+    const traceRec_t & r = e.rec;
+
+    /* Records missing between dumps may hold a burst's other end */
+    if (e.index != next && burstOpen)
+    {
+      unmatched++;
+      burstOpen = false;
+    }
+    next = e.index + 1;
+
+    switch (r.id)
+    {
+    case TRACE_TIMER0:
+      json.slice("timer0", TRACK_TIMER0, e.timeUs, r.arg32 * e.usPerCycle,
+                 arg("state", r.arg16) + "," + arg("cycles", r.arg32));
+      break;
+
+    case TRACE_TASK_OVERRUN:
+      json.instant("task overrun", TRACK_TIMER0, e.timeUs,
+                   arg("task", r.arg16) + "," + arg("cycles", r.arg32));
+      break;
+
+    case TRACE_STAGE:
+      json.slice((r.arg16 < PROF_COUNT) ? profNames[r.arg16] : "stage", TRACK_LOOP, e.timeUs,
+                 r.arg32 * e.usPerCycle, arg("stage", r.arg16) + "," + arg("cycles", r.arg32));
+      break;
+
+    case TRACE_IDLE:
+      json.slice("idle", TRACK_LOOP, e.timeUs, r.arg32, arg("us", r.arg32));
+      break;
+
+    /* A burst is a slice once its interrupt is seen; one cut off by
+       either end of the log is dropped */
+    case TRACE_UART_TX_START:
+      if (burstOpen)
+        unmatched++;
+      burstStart = e.timeUs;
+      burstOpen = true;
+      break;
+
+    case TRACE_UART_TX_DONE:
+      if (burstOpen)
+        json.slice("tx burst", TRACK_UART_TX, burstStart, e.timeUs - burstStart,
+                   arg("bytes", r.arg16) + "," + arg("status", r.arg32));
+      else
+        unmatched++;
+      burstOpen = false;
+      break;
+
+    case TRACE_UART_RX:
+      snprintf(quoted, sizeof(quoted), "0x%02X", r.arg16 & 0xFF);
+      json.instant("rx", TRACK_UART_RX, e.timeUs, arg("byte", quoted) + "," + arg("queued", r.arg32));
+      break;
+
+    case TRACE_FREQ_PEAK:
+      json.instant("peak", TRACK_FREQ, e.timeUs,
+                   arg("samples", r.arg16) + "," + arg("level", r.arg32));
+      json.counter("peak level", e.timeUs, "level", r.arg32);
+      break;
+
+    case TRACE_FREQ_RESET:
+      json.instant("reset", TRACK_FREQ, e.timeUs, "");
+      break;
+
+    case TRACE_FREQ_PROMINENCE:
+      json.counter("prominence", e.timeUs, "counts", r.arg16);
+      break;
+
+    default:
+      json.instant(TraceDecoder::name(r.id), TRACK_OTHER, e.timeUs,
+                   arg("text", TraceDecoder::text(r)));
+      break;
+    }
+  }
+
+  fprintf(out, "\n]}\n");
+  if (out != stdout)
+    fclose(out);
+
+  fprintf(stderr, "events:           %llu from %llu dumps, %llu lost, %llu missed while frozen\n",
+          (unsigned long long)events.size(), (unsigned long long)st.dumps,
+          (unsigned long long)st.lost, (unsigned long long)st.missed);
+  if (burstOpen)
+    unmatched++;
+  if (unmatched)
+    fprintf(stderr, "tx bursts:        %llu cut off by the ends of the log, left out\n",
+            (unsigned long long)unmatched);
+
+  return 0;
+}
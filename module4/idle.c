@@ -0,0 +1,131 @@
+/**----------------------------------------------------------------------------
+ *
+ *            \file idle.c
+--                                                                           --
+--              ECEN 5803 Mastering Embedded System Architecture             --
+--                  Project 1 Module 4                                       --
+--                Microcontroller Firmware                                   --
+--                      idle.c                                               --
+--                                                                           --
+-------------------------------------------------------------------------------
+--
+--  Designed for:  University of Colorado at Boulder
+--
+--
+--  Designed by:  Tristan Lennertz, Subhradeep Dutta, & Omkar Prabhu
+--
+-- Version: 2.1
+-- Date of current revision:  2018-02
+-- Target Microcontroller: Freescale MKL25ZVMT4
+-- Tools used:  ARM mbed compiler
+--              ARM mbed SDK
+--              Freescale FRDM-KL25Z Freedom Board
+--
+--
+--   Functional Description:
+--   Idle sleep (see idle.h).
+--
+--   The pending check and WFI are made with interrupts masked. An
+--   interrupt arriving after the check still ends the WFI, because WFI
+--   wakes on any pending interrupt whatever PRIMASK says, and its handler
+--   runs as soon as the mask is lifted; so an event can never be left
+--   waiting for the next tick.
+--
+--   Only the normal sleep mode is used. VLPS and the other stop modes halt
+--   the PLL, and with it TPM1, the ADC clock, DMA and UART0, which all run
+--   from it; the 100 us timer0 tick would also bring the core straight
+--   back out. Sleep stops just the core clock, and the peripherals carry
+--   on sampling and receiving.
+--
+--   Sleep time is measured with the mbed microsecond ticker (PIT), which
+--   keeps counting while the core is stopped; SysTick, run from the core
+--   clock, does not. Each sleep leaves a trace record (trace.h) stamped
+--   when it began, with the time slept, which is the only account of the
+--   sleep the trace has: the next record's stamp follows on from this one
+--   as if no time had passed, and the host decoder adds the time slept in
+--   between.
+--
+*/
+
+#include <stdint.h>
+
+#include "cmsis.h"
+#include "us_ticker_api.h"
+#include "idle.h"
+#include "trace.h"
+
+/**
+ * @brief Time asleep, and number of sleeps, since start up
+ */
+static uint32_t sleptUs = 0;
+static uint32_t sleeps = 0;
+
+/**
+ * @brief Where the current idlePermille() window started
+ */
+static uint32_t windowSleptUs = 0;
+static uint32_t windowStartUs = 0;
+
+/**
+ * @brief Sleeps until the next interrupt, unless there is already work to
+ * do. Called at the end of each pass of the main loop.
+ *
+ * @param workPending returns nonzero if any event source has something for
+ * the loop; it is called with interrupts masked
+ */
+void idleSleep(uint8_t (*workPending)(void))
+{
+	uint32_t start;
+	uint32_t stamp;
+	uint32_t slept;
+
+	__disable_irq();
+
+	if (workPending())
+	{
+		__enable_irq();
+		return;
+	}
+
+	stamp = cycleCountRead();
+	start = us_ticker_read();
+
+	SCB->SCR &= ~SCB_SCR_SLEEPDEEP_Msk;
+	__WFI();
+
+	/* The handler that woke us has not run yet, so it is not counted */
+	slept = us_ticker_read() - start;
+	sleptUs += slept;
+	sleeps++;
+	TRACE_AT(stamp, TRACE_IDLE, sleeps, slept);
+
+	__enable_irq();
+}
+
+/**
+ * @brief Number of times the loop has slept
+ */
+uint32_t idleSleepCount(void)
+{
+	return sleeps;
+}
+
+/**
+ * @brief Fraction of the time spent asleep since the previous call, in
+ * tenths of a percent. Starts a new window.
+ */
+uint32_t idlePermille(void)
+{
+	uint32_t now = us_ticker_read();
+	uint32_t slept = sleptUs;
+	uint32_t elapsed = now - windowStartUs;
+	uint32_t permille = 0;
+
+	if (elapsed != 0)
+		permille = (uint32_t)(((uint64_t)(slept - windowSleptUs) * 1000) / elapsed);
+
+	windowStartUs = now;
+	windowSleptUs = slept;
+
+	return permille;
+}
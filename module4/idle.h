@@ -0,0 +1,50 @@
+/**----------------------------------------------------------------------------
+ *
+ *            \file idle.h
+--                                                                           --
+--              ECEN 5803 Mastering Embedded System Architecture             --
+--                  Project 1 Module 4                                       --
+--                Microcontroller Firmware                                   --
+--                      idle.h                                               --
+--                                                                           --
+-------------------------------------------------------------------------------
+--
+--  Designed for:  University of Colorado at Boulder
+--
+--
+--  Designed by:  Tristan Lennertz, Subhradeep Dutta, & Omkar Prabhu
+--
+-- Version: 2.1
+-- Date of current revision:  2018-02
+-- Target Microcontroller: Freescale MKL25ZVMT4
+-- Tools used:  ARM mbed compiler
+--              ARM mbed SDK
+--              Freescale FRDM-KL25Z Freedom Board
+--
+--
+--   Functional Description:
+--   Idle sleep for the super loop. When the loop has nothing left to do it
+--   waits for the next interrupt in the core's sleep (WAIT) mode instead
+--   of spinning, and the time spent asleep is accumulated so the monitor
+--   can report the idle fraction, i.e. one minus the CPU load.
+--
+*/
+
+#ifndef IDLE_H
+#define IDLE_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void idleSleep(uint8_t (*workPending)(void));  /* sleep unless work is pending */
+uint32_t idleSleepCount(void);                 /* sleeps since start up */
+uint32_t idlePermille(void);                   /* sleep fraction since last call */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* IDLE_H */
@@ -90,61 +90,134 @@ void flip_r()
 	redLED = !redLED;
 }
  
-int main() 
+/**
+ *@brief Latest flow signal frequency and temperature, and the number of
+ * passes through the super loop
+ */
+static float currentFreq = 0; /* Updated from ADC sampling */
+static float currentTemp = 0; /* Updated from internal temp sensor sampling via ADC */
+static float currentFlow = 0; /* Updated from the frequency and temperature */
+static uint32_t loop_count = 0;
+
+/**
+ *@brief Whether the current pass began with work pending. Passes that
+ * began with none leave no stage records, only timer0's and the sleep's,
+ * so the trace ring spans more time.
+ */
+static uint8_t pass_busy = 0;
+
+/**
+ *@brief Whether any event source has work for the super loop: an ADC
+ * block, a timer0 event, serial port traffic or a status display due.
+ * Called by idleSleep() with interrupts masked, and at the start of each
+ * pass to decide whether its stages are traced.
+ */
+static uint8_t work_pending(void)
+{
+	return (ADC_dma_get_block() != NULL) ||
+	       !evqIsEmpty(&timer_events) ||
+	       UART_pending() ||
+	       (display_flag && !pause_flag);
+}
+
+/**
+ *@brief Closes a profiled loop stage and, on a pass with work to do,
+ * leaves it in the trace log stamped when it began
+ */
+static void stage_end(uint8_t stage, uint32_t start)
+{
+	profEnd(stage, start);
+	if (pass_busy)
+		TRACE_AT(start, TRACE_STAGE, stage, cycleCountElapsed(start, cycleCountRead()));
+}
+
+/**
+ *@brief Brings up the hardware, the timer0 scheduler and the serial port,
+ * and prints the banner. Everything the super loop needs before its first
+ * pass.
+ */
+void executive_init(void)
 {
-	float currentFreq = 0; /* Updated from ADC sampling */
-	float currentTemp = 0; /* Updated from internal temp sensor sampling via ADC */
-	
   /* Start with all LEDs off */
 	greenLED = 1; 
 	redLED = 1;
 	blueLED = 1; 
   
+	/* Free running cycle counter for execution time measurements */
+	cycleCountInit();
+	
+	/* Binary trace log, stamped with the cycle counter */
+	traceInit();
+	
+	/* Bring the selected frequency estimator to its starting state */
+	freqReset();
+	
+	/* Timer triggered ADC sampling into DMA ping-pong blocks */
+	ADC_dma_init();
+	
+	/* Build the timer0 task dispatch table */
+	uint8_t schedError = sched_init();
+	
 	/*  Call timer0 function every 100 uS */
 	tick.attach(&timer0, 0.0001);
 
-    pc.printf("Hello World!\n"); 
-    uint32_t  count = 0;   
-    
-  /* initialize serial buffer pointers */
-   rx_in_ptr =  rx_buf; /* pointer to the receive in data */
-   rx_out_ptr = rx_buf; /* pointer to the receive out data*/
-   tx_in_ptr =  tx_buf; /* pointer to the transmit in data*/
-   tx_out_ptr = tx_buf; /*pointer to the transmit out */
-    
-   
-  /* Print the initial banner */ 
-	pc.printf("\r\n*************************************\r\r");
-	pc.printf("\r\nProject by Tristan, Subhradeep, Omkar\r\r");
-	pc.printf("\r\n*************************************\r\r");
-
-  /* send a message to the terminal  */                    
-  UART_direct_msg_put("\r\nSystem Reset\r\nCode ver. ");
-  UART_direct_msg_put( CODE_VERSION );
-  UART_direct_msg_put("\r\n");
-  UART_direct_msg_put( COPYRIGHT );
-  UART_direct_msg_put("\r\n");
-
-  set_display_mode();                                      
-   
-	/* Cyclical Executive Loop */
-  while(1)
-  {
+	pc.baud(UART_BAUD);
+
+  /* From here on the port is driven by interrupt and DMA, not Serial */
+  UART_dma_init();
+
+  /* Banner, start up report and menu, sent by the monitor as the loop
+     runs so no ADC block waits behind the UART */
+  monitor_banner(schedError);
+}
+
+/**
+ *@brief One pass of the cyclical executive: serial port, monitor, ADC
+ * blocks and timer0 events, then sleep until the next interrupt if
+ * nothing is left to do
+ */
+void executive_pass(void)
+{
+    uint32_t  profT;      /* start of the stage being profiled */
+    event_t   ev;         /* event being drained from timer0 */
+    uint8_t   evBatch[EV_TYPE_COUNT]; /* events of each type this pass */
+    uint8_t   evType;
+    uint32_t  evLatency;  /* ticks from posting to handling */
+
     /* counts the number of times through the loop */
-    count++;
+    loop_count++;
+    pass_busy = work_pending();
     __enable_irq();
 
-    serial();             // Polls the serial port
+    /* Each stage is timed for the profiler (monitor command T) and traced */
+    profT = profStart();
+    serial();             // Restarts serial output if nothing else did
+    stage_end(PROF_SERIAL, profT);
+    
+    profT = profStart();
     chk_UART_msg();       // checks for a serial port message received
+    stage_end(PROF_CHK_UART, profT);
+    
+    profT = profStart();
     monitor();            // Sends serial port output messages depending
                           //  on commands received and display mode
+    stage_end(PROF_MONITOR, profT);
 
     /****************      ECEN 5803 add code as indicated   ***************/
-    if (adc_flag)
+    /* Process each block of samples the DMA has completed */
+    const uint16_t * adcBlock = ADC_dma_get_block();
+    if (adcBlock != NULL)
 		{
-		// readADC()
+		profT = profStart();
+		currentFreq = freqProcessBlock(adcBlock, ADC_DMA_BLOCK_SIZE);
+		
+		/* The telemetry record carries statistics of the block itself */
+		if (display_mode == BINARY && !pause_flag)
+			monitor_telemetry(adcBlock, ADC_DMA_BLOCK_SIZE, (uint32_t)currentFreq,
+			                  currentFlow, currentTemp);
+		ADC_dma_release_block();
+		stage_end(PROF_FREQ, profT);
 		
-		currentFreq = calculateFrequency(0);
 		// calculate temperature()
 
     //  calculate flow()
@@ -154,8 +227,6 @@ int main()
     //  Pulse output()   // use TMP0 channel 4  propotional rate to frequency
 
     //  LCD_Display()   // use the SPI port to send flow number
-		
-			adc_flag = 0;
 		}
 
     //  End ECEN 5803 code addition
@@ -167,14 +238,53 @@ int main()
       flip_g();  // Toggle Green LED
     }
     
-    /* Red LED toggle every 0.5 s, based on timer0 setting led_flag */
-		if (led_flag)
+    /* Handle the events timer0 posted since the last pass as one batch.
+       Several of one type in a batch mean the loop ran late; they are
+       acted on once and counted as coalesced. */
+    for (evType = 0; evType < EV_TYPE_COUNT; evType++)
+      evBatch[evType] = 0;
+    
+    while (evqGet(&timer_events, &ev))
+    {
+      evLatency = timer0_ticks() - ev.time;
+      if (evLatency > event_latency_max)
+        event_latency_max = evLatency;
+      
+      if (ev.type < EV_TYPE_COUNT)
+        evBatch[ev.type]++;
+    }
+    
+    for (evType = 0; evType < EV_TYPE_COUNT; evType++)
+    {
+      if (evBatch[evType] > 1)
+        evqCoalesced(&timer_events, evBatch[evType] - 1);
+    }
+    
+    /* Status output is due; monitor() clears the flag once printed */
+    if (evBatch[EV_DISPLAY])
+      display_flag = 1;
+    
+    /* Red LED toggle every 0.5 s, on timer0's heartbeat event */
+		if (evBatch[EV_LED_TOGGLE])
 		{
 		  flip_r();  // Toggle Red LED
-			
-			led_flag = 0; 
 		}
-  } 
-       
+    
+    /* Nothing left to do: sleep until the next interrupt brings some */
+    idleSleep(work_pending);
 }
 
+#ifndef HOST_SIM
+/* The host simulation (host/exec_sim.cpp) provides its own main() and
+   drives the two halves against a virtual clock */
+int main() 
+{
+  executive_init();
+   
+	/* Cyclical Executive Loop */
+  while(1)
+  {
+    executive_pass();
+  } 
+}
+#endif
@@ -0,0 +1,239 @@
+/**----------------------------------------------------------------------------
+ *
+ *            \file numfmt.c
+--                                                                           --
+--              ECEN 5803 Mastering Embedded System Architecture             --
+--                  Project 1 Module 4                                       --
+--                Microcontroller Firmware                                   --
+--                      numfmt.c                                             --
+--                                                                           --
+-------------------------------------------------------------------------------
+--
+--  Designed for:  University of Colorado at Boulder
+--
+--
+--  Designed by:  Tristan Lennertz, Subhradeep Dutta, & Omkar Prabhu
+--
+-- Version: 2.1
+-- Date of current revision:  2018-02
+-- Target Microcontroller: Freescale MKL25ZVMT4
+-- Tools used:  ARM mbed compiler
+--              ARM mbed SDK
+--              Freescale FRDM-KL25Z Freedom Board
+--
+--
+--   Functional Description:
+--   Number to ASCII conversion (see numfmt.h). Digits are produced from
+--   the least significant end into a small buffer and copied out once the
+--   length is known.
+--
+--   Division by 100 is a multiply by a scaled reciprocal and a shift:
+--     v < 43699:  v / 100 == (v * 5243) >> 19, a single 32-bit MULS
+--     otherwise:  v / 100 == (v * 0x51EB851F) >> 37, a 32x32->64 multiply
+--   both exact over their range. At most four of the long form are needed
+--   for a 32-bit value, against a software divide per digit before.
+--
+*/
+
+#include <stdint.h>
+
+#include "numfmt.h"
+
+/**
+ * @brief "00" to "99", two characters each
+ */
+static const char digitPairs[200] =
+{
+	'0','0', '0','1', '0','2', '0','3', '0','4', '0','5', '0','6', '0','7', '0','8', '0','9',
+	'1','0', '1','1', '1','2', '1','3', '1','4', '1','5', '1','6', '1','7', '1','8', '1','9',
+	'2','0', '2','1', '2','2', '2','3', '2','4', '2','5', '2','6', '2','7', '2','8', '2','9',
+	'3','0', '3','1', '3','2', '3','3', '3','4', '3','5', '3','6', '3','7', '3','8', '3','9',
+	'4','0', '4','1', '4','2', '4','3', '4','4', '4','5', '4','6', '4','7', '4','8', '4','9',
+	'5','0', '5','1', '5','2', '5','3', '5','4', '5','5', '5','6', '5','7', '5','8', '5','9',
+	'6','0', '6','1', '6','2', '6','3', '6','4', '6','5', '6','6', '6','7', '6','8', '6','9',
+	'7','0', '7','1', '7','2', '7','3', '7','4', '7','5', '7','6', '7','7', '7','8', '7','9',
+	'8','0', '8','1', '8','2', '8','3', '8','4', '8','5', '8','6', '8','7', '8','8', '8','9',
+	'9','0', '9','1', '9','2', '9','3', '9','4', '9','5', '9','6', '9','7', '9','8', '9','9'
+};
+
+static const char hexDigits[16] =
+{
+	'0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'A', 'B', 'C', 'D', 'E', 'F'
+};
+
+/**
+ * @brief Writes value's decimal digits ending just before end
+ *
+ * @return Where the first digit went
+ */
+static char * decimalDigits(uint32_t value, char * end)
+{
+	uint32_t q;
+	uint32_t r;
+
+	while (value >= 43699)
+	{
+		q = (uint32_t)(((uint64_t)value * 0x51EB851FU) >> 37);
+		r = value - q * 100;
+		end -= 2;
+		end[0] = digitPairs[2 * r];
+		end[1] = digitPairs[2 * r + 1];
+		value = q;
+	}
+
+	while (value >= 100)
+	{
+		q = (value * 5243) >> 19;
+		r = value - q * 100;
+		end -= 2;
+		end[0] = digitPairs[2 * r];
+		end[1] = digitPairs[2 * r + 1];
+		value = q;
+	}
+
+	if (value >= 10)
+	{
+		end -= 2;
+		end[0] = digitPairs[2 * value];
+		end[1] = digitPairs[2 * value + 1];
+	}
+	else
+		*--end = (char)('0' + value);
+
+	return end;
+}
+
+/**
+ * @brief Copies len characters to out and terminates them
+ */
+static uint8_t copyOut(const char * from, uint8_t len, char * out)
+{
+	uint8_t i;
+
+	for (i = 0; i < len; i++)
+		out[i] = from[i];
+	out[len] = '\0';
+
+	return len;
+}
+
+uint8_t fmtU32(uint32_t value, char * out)
+{
+	char buf[10];
+	char * first = decimalDigits(value, buf + sizeof(buf));
+
+	return copyOut(first, (uint8_t)(buf + sizeof(buf) - first), out);
+}
+
+uint8_t fmtI32(int32_t value, char * out)
+{
+	if (value >= 0)
+		return fmtU32((uint32_t)value, out);
+
+	/* Negated unsigned, so INT32_MIN comes out right */
+	*out = '-';
+	return 1 + fmtU32(0u - (uint32_t)value, out + 1);
+}
+
+/**
+ * @brief At least minDigits digits (up to 8), more if value needs them
+ */
+uint8_t fmtHex32(uint32_t value, uint8_t minDigits, char * out)
+{
+	uint8_t digits = 1;
+	uint8_t i;
+
+	while (digits < 8 && (value >> (4 * digits)) != 0)
+		digits++;
+	if (digits < minDigits)
+		digits = (minDigits > 8) ? 8 : minDigits;
+
+	for (i = digits; i > 0; i--)
+	{
+		out[i - 1] = hexDigits[value & 0xF];
+		value >>= 4;
+	}
+	out[digits] = '\0';
+
+	return digits;
+}
+
+/**
+ * @brief Fixed point decimal: value holds the number times 10^decimals,
+ * so fmtFixed(-2345, 2) gives "-23.45" and fmtFixed(5, 3) "0.005".
+ * decimals is at most 9.
+ */
+uint8_t fmtFixed(int32_t value, uint8_t decimals, char * out)
+{
+	char buf[NUMFMT_DEC_LEN];
+	char * end = buf + sizeof(buf);
+	char * first;
+	uint32_t mag = (value < 0) ? 0u - (uint32_t)value : (uint32_t)value;
+	uint8_t len = 0;
+	uint8_t whole;
+	uint8_t i;
+
+	first = decimalDigits(mag, end);
+
+	if (decimals != 0)
+	{
+		/* Leading zeros up to one whole digit */
+		while (end - first < decimals + 1)
+			*--first = '0';
+
+		/* Shift the whole digits one left to open the point */
+		whole = (uint8_t)(end - first - decimals);
+		first--;
+		for (i = 0; i < whole; i++)
+			first[i] = first[i + 1];
+		first[whole] = '.';
+	}
+
+	if (value < 0)
+		out[len++] = '-';
+
+	return len + copyOut(first, (uint8_t)(end - first), out + len);
+}
+
+/**
+ * @brief Any base from 2 to 16. Powers of two take shifts, 10 the table,
+ * the rest a divide per digit. An unsupported base gives "".
+ */
+uint8_t fmtBase(uint32_t value, uint8_t base, char * out)
+{
+	char buf[32];
+	char * end = buf + sizeof(buf);
+	char * first = end;
+	uint8_t shift = 0;
+
+	if (base == 10)
+		return fmtU32(value, out);
+
+	if (base < 2 || base > 16)
+	{
+		*out = '\0';
+		return 0;
+	}
+
+	if ((base & (base - 1)) == 0)
+	{
+		while ((1u << shift) != base)
+			shift++;
+
+		do
+		{
+			*--first = hexDigits[value & (base - 1)];
+			value >>= shift;
+		} while (value != 0);
+	}
+	else
+	{
+		do
+		{
+			*--first = hexDigits[value % base];
+			value /= base;
+		} while (value != 0);
+	}
+
+	return copyOut(first, (uint8_t)(end - first), out);
+}
@@ -0,0 +1,62 @@
+/**----------------------------------------------------------------------------
+ *
+ *            \file numfmt.h
+--                                                                           --
+--              ECEN 5803 Mastering Embedded System Architecture             --
+--                  Project 1 Module 4                                       --
+--                Microcontroller Firmware                                   --
+--                      numfmt.h                                             --
+--                                                                           --
+-------------------------------------------------------------------------------
+--
+--  Designed for:  University of Colorado at Boulder
+--
+--
+--  Designed by:  Tristan Lennertz, Subhradeep Dutta, & Omkar Prabhu
+--
+-- Version: 2.1
+-- Date of current revision:  2018-02
+-- Target Microcontroller: Freescale MKL25ZVMT4
+-- Tools used:  ARM mbed compiler
+--              ARM mbed SDK
+--              Freescale FRDM-KL25Z Freedom Board
+--
+--
+--   Functional Description:
+--   Integer and fixed point to ASCII conversion for the monitor output.
+--   The Cortex-M0+ has no divide instruction, so decimal conversion takes
+--   two digits at a time from a 200 byte table and divides by 100 with a
+--   multiply by its reciprocal. Hex is shifts and masks only.
+--
+--   Each function writes the digits and a terminating NUL to out and
+--   returns the number of characters, not counting the NUL.
+--
+*/
+
+#ifndef NUMFMT_H
+#define NUMFMT_H
+
+#include <stdint.h>
+
+/**
+ * @brief Room needed for any result, NUL included: sign, 10 digits and a
+ * decimal point for base 10, 32 digits for base 2
+ */
+#define NUMFMT_DEC_LEN (13)
+#define NUMFMT_MAX_LEN (33)
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+uint8_t fmtU32(uint32_t value, char * out);                      /* decimal */
+uint8_t fmtI32(int32_t value, char * out);                       /* decimal, signed */
+uint8_t fmtHex32(uint32_t value, uint8_t minDigits, char * out); /* upper case, zero padded */
+uint8_t fmtFixed(int32_t value, uint8_t decimals, char * out);   /* value / 10^decimals */
+uint8_t fmtBase(uint32_t value, uint8_t base, char * out);       /* bases 2 to 16 */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* NUMFMT_H */
@@ -0,0 +1,201 @@
+/**----------------------------------------------------------------------------
+ *
+ *            \file numfmt_bench.c
+--                                                                           --
+--              ECEN 5803 Mastering Embedded System Architecture             --
+--                  Project 1 Module 4                                       --
+--                Microcontroller Firmware                                   --
+--                      numfmt_bench.c                                       --
+--                                                                           --
+-------------------------------------------------------------------------------
+--
+--  Designed for:  University of Colorado at Boulder
+--
+--
+--  Designed by:  Tristan Lennertz, Subhradeep Dutta, & Omkar Prabhu
+--
+-- Version: 2.1
+-- Date of current revision:  2018-02
+-- Target Microcontroller: Freescale MKL25ZVMT4
+-- Tools used:  ARM mbed compiler
+--              ARM mbed SDK
+--              Freescale FRDM-KL25Z Freedom Board
+--
+--
+--   Functional Description:
+--   Benchmark of numfmt.c against the old my_itoa() (see numfmt_bench.h).
+--   Each call is timed on its own, so the figures include reading the
+--   cycle counter, a few cycles on the board. On the board timer0 can
+--   land inside a call, so the minimum is the figure to compare; the
+--   average and maximum show the spread.
+--
+*/
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "numfmt.h"
+#include "numfmt_bench.h"
+
+const char * const numfmtBenchNames[NUMFMT_BENCH_COUNT] =
+{
+	"my_itoa dec (old)", "fmtI32", "my_itoa hex (old)", "fmtHex32", "fmtFixed"
+};
+
+/**
+ * @brief The kind of numbers the monitor prints: counts, cycle figures,
+ * addresses and the odd negative
+ */
+static const int32_t benchValues[] =
+{
+	0, 7, 42, 100, 999, 4800, 65535, 123456,
+	4800000, 16777215, 536870912, 2147483647, -1, -4096, -123456789, -2147483647
+};
+
+#define BENCH_VALUE_COUNT (sizeof(benchValues) / sizeof(benchValues[0]))
+
+/*********************************/
+/*     The replaced my_itoa      */
+/*********************************/
+
+static int64_t legacyToPower(uint32_t base, uint8_t exponent)
+{
+  int64_t accum = 1;
+  size_t i;
+
+  for (i = 0; i < exponent; i++)
+  {
+    accum *= base;
+  }
+
+  return accum;
+}
+
+static uint8_t legacyDigitLookup(int32_t val)
+{
+  static const char digits[] = "0123456789ABCDEF";
+
+  /* A table in place of the original switch; the divides dominate either way */
+  return (val >= 0 && val <= 15) ? digits[val] : '\0';
+}
+
+/**
+ * @brief my_itoa() as it was in Monitor.cpp: the number of digits by
+ * dividing by increasing 64-bit powers of the base, then a divide and a
+ * multiply per digit
+ */
+uint8_t numfmtLegacyItoa(int32_t data, uint8_t * ptr, uint32_t base)
+{
+  /* Intermediate string buffer and associated values for building conversion */
+  uint8_t strBuff[128];
+  uint8_t * strPtr = strBuff;
+  uint8_t strLen = 0;
+
+  /* Ensure the base is within the supported range */
+  if (base >= 2 && base <= 16)
+  {
+    /* One-time check for negative */
+    if (data < 0)
+    {
+      *strPtr++ = '-';
+      strLen++;
+      data *= -1;
+    }
+
+    /* Zero is breaking corner case for algorithm, deal with it specially */
+    if (data == 0)
+    {
+      *strPtr++ = '0';
+      strLen++;
+    }
+    else
+    {
+      uint8_t valMagnitude = 0;
+
+      while ((data / legacyToPower(base, valMagnitude)) > 0)
+        valMagnitude++;
+
+      while (valMagnitude-- > 0)
+      {
+        int32_t currMultiple, currPower;
+
+        currPower = (uint32_t) legacyToPower(base, valMagnitude);
+        currMultiple = data / currPower;
+        data -= currMultiple * currPower;
+
+        *strPtr++ = legacyDigitLookup(currMultiple);
+        strLen++;
+      }
+    }
+  }
+
+  if (ptr != NULL && strLen > 0)
+  {
+    size_t ndx;
+
+    for (ndx = 0; ndx < strLen; ndx++)
+    {
+      *ptr++ = *(strBuff + ndx);
+    }
+
+    *ptr = '\0';
+    strLen++;
+  }
+  else
+  {
+    strLen = 0;
+  }
+
+  return strLen;
+}
+
+/*********************************/
+/*     Measurement               */
+/*********************************/
+
+uint8_t numfmtBench(cycleStats_t stats[NUMFMT_BENCH_COUNT])
+{
+	char oldBuf[NUMFMT_MAX_LEN + 1];
+	char newBuf[NUMFMT_MAX_LEN + 1];
+	uint8_t mismatches = 0;
+	uint32_t start;
+	int32_t v;
+	uint8_t i;
+
+	memset(stats, 0, NUMFMT_BENCH_COUNT * sizeof(cycleStats_t));
+
+	for (i = 0; i < BENCH_VALUE_COUNT; i++)
+	{
+		v = benchValues[i];
+
+		start = cycleCountRead();
+		numfmtLegacyItoa(v, (uint8_t *)oldBuf, 10);
+		cycleStatsUpdate(&stats[NUMFMT_BENCH_OLD_DEC], cycleCountElapsed(start, cycleCountRead()));
+
+		start = cycleCountRead();
+		fmtI32(v, newBuf);
+		cycleStatsUpdate(&stats[NUMFMT_BENCH_DEC], cycleCountElapsed(start, cycleCountRead()));
+
+		if (strcmp(oldBuf, newBuf) != 0)
+			mismatches++;
+
+		/* The old hex was sign and magnitude; compare from the magnitude */
+		start = cycleCountRead();
+		numfmtLegacyItoa(v, (uint8_t *)oldBuf, 16);
+		cycleStatsUpdate(&stats[NUMFMT_BENCH_OLD_HEX], cycleCountElapsed(start, cycleCountRead()));
+
+		start = cycleCountRead();
+		fmtHex32((v < 0) ? 0u - (uint32_t)v : (uint32_t)v, 1, newBuf);
+		cycleStatsUpdate(&stats[NUMFMT_BENCH_HEX], cycleCountElapsed(start, cycleCountRead()));
+
+		if (strcmp(oldBuf + (v < 0), newBuf) != 0)
+			mismatches++;
+
+		start = cycleCountRead();
+		fmtFixed(v, 2, newBuf);
+		cycleStatsUpdate(&stats[NUMFMT_BENCH_FIXED], cycleCountElapsed(start, cycleCountRead()));
+	}
+
+	return mismatches;
+}
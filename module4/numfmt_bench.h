@@ -0,0 +1,71 @@
+/**----------------------------------------------------------------------------
+ *
+ *            \file numfmt_bench.h
+--                                                                           --
+--              ECEN 5803 Mastering Embedded System Architecture             --
+--                  Project 1 Module 4                                       --
+--                Microcontroller Firmware                                   --
+--                      numfmt_bench.h                                       --
+--                                                                           --
+-------------------------------------------------------------------------------
+--
+--  Designed for:  University of Colorado at Boulder
+--
+--
+--  Designed by:  Tristan Lennertz, Subhradeep Dutta, & Omkar Prabhu
+--
+-- Version: 2.1
+-- Date of current revision:  2018-02
+-- Target Microcontroller: Freescale MKL25ZVMT4
+-- Tools used:  ARM mbed compiler
+--              ARM mbed SDK
+--              Freescale FRDM-KL25Z Freedom Board
+--
+--
+--   Functional Description:
+--   Cost of the numfmt.c conversions against the my_itoa() they replaced,
+--   measured with the cycle counter over a fixed set of values. The same
+--   source runs on the board (monitor command F, DEBUG mode) and on the
+--   host (host/fmt_bench).
+--
+*/
+
+#ifndef NUMFMT_BENCH_H
+#define NUMFMT_BENCH_H
+
+#include <stdint.h>
+
+#include "cycle_count.h"
+
+/**
+ * @brief Conversions measured
+ */
+#define NUMFMT_BENCH_OLD_DEC (0)   /* my_itoa(v, buf, 10) as it was */
+#define NUMFMT_BENCH_DEC     (1)   /* fmtI32 */
+#define NUMFMT_BENCH_OLD_HEX (2)   /* my_itoa(v, buf, 16) as it was */
+#define NUMFMT_BENCH_HEX     (3)   /* fmtHex32 */
+#define NUMFMT_BENCH_FIXED   (4)   /* fmtFixed, 2 decimals */
+#define NUMFMT_BENCH_COUNT   (5)
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+extern const char * const numfmtBenchNames[NUMFMT_BENCH_COUNT];
+
+/**
+ * @brief Times every conversion once per test value, folding each call
+ * into stats[], and compares the old and new results
+ *
+ * @return Values on which the old and new conversions disagree
+ */
+uint8_t numfmtBench(cycleStats_t stats[NUMFMT_BENCH_COUNT]);
+
+/* The replaced conversion, kept as the baseline */
+uint8_t numfmtLegacyItoa(int32_t data, uint8_t * ptr, uint32_t base);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* NUMFMT_BENCH_H */
@@ -0,0 +1,108 @@
+/**----------------------------------------------------------------------------
+ *
+ *            \file profile.c
+--                                                                           --
+--              ECEN 5803 Mastering Embedded System Architecture             --
+--                  Project 1 Module 4                                       --
+--                Microcontroller Firmware                                   --
+--                      profile.c                                            --
+--                                                                           --
+-------------------------------------------------------------------------------
+--
+--  Designed for:  University of Colorado at Boulder
+--
+--
+--  Designed by:  Tristan Lennertz, Subhradeep Dutta, & Omkar Prabhu
+--
+-- Version: 2.1
+-- Date of current revision:  2018-02
+-- Target Microcontroller: Freescale MKL25ZVMT4
+-- Tools used:  ARM mbed compiler
+--              ARM mbed SDK
+--              Freescale FRDM-KL25Z Freedom Board
+--
+--
+--   Functional Description:
+--   Execution time profiler records. Each section is written from a single
+--   context (timer0 from its interrupt, the loop stages from main), so no
+--   locking is needed; the monitor reads them as they are and may see a
+--   record mid-update.
+--
+--   Loop stage times are wall clock and include any timer0 interrupts that
+--   land inside them. Intervals beyond 2^24 cycles (~349 ms) wrap, which
+--   only a stage stuck in a long blocking UART write can reach.
+--
+*/
+
+#include <stdint.h>
+#include <string.h>
+
+#include "profile.h"
+
+/**
+ * @brief Records and report names, indexed by PROF_xxx
+ */
+profRecord_t profRecords[PROF_COUNT];
+
+const char * const profNames[PROF_COUNT] =
+{
+	"timer0",
+	"serial",
+	"chk_UART_msg",
+	"monitor",
+	"freq_block",
+};
+
+/**
+ * @brief Histogram bin of an interval. The M0+ has no count leading zeros
+ * instruction, so this is a binary search over the bin limits.
+ */
+static uint8_t profBin(uint32_t cycles)
+{
+	uint8_t bin = 0;
+
+	cycles >>= PROF_HIST_MIN_SHIFT - 1;
+
+	if (cycles >> 16) { cycles >>= 16; bin += 16; }
+	if (cycles >> 8) { cycles >>= 8; bin += 8; }
+	if (cycles >> 4) { cycles >>= 4; bin += 4; }
+	if (cycles >> 2) { cycles >>= 2; bin += 2; }
+	if (cycles >> 1) { bin += 1; }
+
+	return (bin < PROF_HIST_BINS) ? bin : PROF_HIST_BINS - 1;
+}
+
+/**
+ * @brief Closes a profiled section and folds its duration into the record
+ *
+ * @param id PROF_xxx section
+ * @param start Value returned by profStart() at the beginning of the section
+ */
+void profEnd(uint8_t id, uint32_t start)
+{
+	uint32_t cycles = cycleCountElapsed(start, cycleCountRead());
+	profRecord_t * rec = &profRecords[id];
+
+	cycleStatsUpdate(&rec->stats, cycles);
+	rec->hist[profBin(cycles)]++;
+}
+
+/**
+ * @brief Clears every record
+ */
+void profReset(void)
+{
+	memset(profRecords, 0, sizeof(profRecords));
+}
+
+/**
+ * @brief Exclusive upper bound of a histogram bin in cycles, or 0 for the
+ * open ended last bin
+ */
+uint32_t profBinLimit(uint8_t bin)
+{
+	if (bin >= PROF_HIST_BINS - 1)
+		return 0;
+
+	return 1UL << (bin + PROF_HIST_MIN_SHIFT);
+}
@@ -0,0 +1,92 @@
+/**----------------------------------------------------------------------------
+ *
+ *            \file profile.h
+--                                                                           --
+--              ECEN 5803 Mastering Embedded System Architecture             --
+--                  Project 1 Module 4                                       --
+--                Microcontroller Firmware                                   --
+--                      profile.h                                            --
+--                                                                           --
+-------------------------------------------------------------------------------
+--
+--  Designed for:  University of Colorado at Boulder
+--
+--
+--  Designed by:  Tristan Lennertz, Subhradeep Dutta, & Omkar Prabhu
+--
+-- Version: 2.1
+-- Date of current revision:  2018-02
+-- Target Microcontroller: Freescale MKL25ZVMT4
+-- Tools used:  ARM mbed compiler
+--              ARM mbed SDK
+--              Freescale FRDM-KL25Z Freedom Board
+--
+--
+--   Functional Description:
+--   Execution time profiler for timer0() and the super loop stages. Each
+--   profiled section keeps min/max/average cycle counts and a histogram
+--   with power of two bins, so the shape of the distribution (how often a
+--   stage comes near the 100 us tick) is visible as well as its extremes.
+--   Built on the cycle counter in cycle_count.h.
+--
+*/
+
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include <stdint.h>
+
+#include "cycle_count.h"
+
+/**
+ * @brief Profiled sections
+ */
+#define PROF_TIMER0    (0)   /* timer0() interrupt */
+#define PROF_SERIAL    (1)   /* serial() */
+#define PROF_CHK_UART  (2)   /* chk_UART_msg() */
+#define PROF_MONITOR   (3)   /* monitor() */
+#define PROF_FREQ      (4)   /* ADC block through the frequency estimator */
+#define PROF_COUNT     (5)
+
+/**
+ * @brief Histogram bins. Bin 0 counts intervals under 2^PROF_HIST_MIN_SHIFT
+ * cycles, bin k intervals in [2^(k+PROF_HIST_MIN_SHIFT-1), 2^(k+PROF_HIST_MIN_SHIFT)),
+ * and the last bin everything longer: with 16 bins from 32 cycles that is
+ * under 0.67 us up to 10.9 ms and over, at 48 MHz.
+ */
+#define PROF_HIST_BINS      (16)
+#define PROF_HIST_MIN_SHIFT (5)
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Statistics of one profiled section
+ */
+typedef struct
+{
+	cycleStats_t stats;                 /* min/max/average in cycles */
+	uint32_t hist[PROF_HIST_BINS];      /* interval histogram */
+} profRecord_t;
+
+extern profRecord_t profRecords[PROF_COUNT];
+extern const char * const profNames[PROF_COUNT];
+
+/**
+ * @brief Marks the start of a profiled section
+ */
+static __inline uint32_t profStart(void)
+{
+	return cycleCountRead();
+}
+
+void profEnd(uint8_t id, uint32_t start);    /* closes a section begun at start */
+void profReset(void);                        /* clears all records */
+uint32_t profBinLimit(uint8_t bin);          /* upper bound of a bin, cycles */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PROFILE_H */
@@ -0,0 +1,116 @@
+/**----------------------------------------------------------------------------
+ *
+ *            \file pt.h
+--                                                                           --
+--              ECEN 5803 Mastering Embedded System Architecture             --
+--                  Project 1 Module 4                                       --
+--                Microcontroller Firmware                                   --
+--                      pt.h                                                 --
+--                                                                           --
+-------------------------------------------------------------------------------
+--
+--  Designed for:  University of Colorado at Boulder
+--
+--
+--  Designed by:  Tristan Lennertz, Subhradeep Dutta, & Omkar Prabhu
+--
+-- Version: 2.1
+-- Date of current revision:  2018-02
+-- Target Microcontroller: Freescale MKL25ZVMT4
+-- Tools used:  ARM mbed compiler
+--              ARM mbed SDK
+--              Freescale FRDM-KL25Z Freedom Board
+--
+--
+--   Functional Description:
+--   Stackless coroutines (protothreads) for super loop tasks. A task is a
+--   function called once per loop pass that picks up where it last left
+--   off: PT_WAIT_UNTIL() and PT_YIELD() return to the loop, and the next
+--   call jumps back to the same point through a switch on the saved line
+--   number. Each task costs two bytes of state and no stack of its own.
+--
+--   Local variables do not survive a wait or yield; keep anything needed
+--   afterwards in static or task state. A task body may not use a switch
+--   statement of its own around a wait, since the case labels would
+--   collide.
+--
+*/
+
+#ifndef PT_H
+#define PT_H
+
+#include <stdint.h>
+
+/**
+ * @brief Task state: the line the task resumes at, 0 before it starts
+ */
+typedef struct
+{
+	uint16_t lc;
+} pt_t;
+
+/**
+ * @brief Task function results
+ */
+#define PT_WAITING (0)   /* blocked on a condition */
+#define PT_YIELDED (1)   /* gave the loop a turn, more to do */
+#define PT_EXITED  (2)   /* left early with PT_EXIT() */
+#define PT_ENDED   (3)   /* ran to PT_END() */
+
+/**
+ * @brief Whether a task function result means it should be called again
+ */
+#define PT_RUNNING(result) ((result) < PT_EXITED)
+
+/**
+ * @brief Restarts a task from the top on its next call
+ */
+#define PT_INIT(pt) ((pt)->lc = 0)
+
+/**
+ * @brief Marks each resume point's case label as reached on purpose, so
+ * -Wimplicit-fallthrough stays quiet. A comment would do for code written
+ * out, but not inside a macro. Nothing on compilers without the attribute.
+ */
+#if defined(__has_attribute) && !defined(__CC_ARM)
+#if __has_attribute(fallthrough)
+#define PT_FALLTHROUGH __attribute__((fallthrough))
+#endif
+#endif
+#ifndef PT_FALLTHROUGH
+#define PT_FALLTHROUGH ((void)0)
+#endif
+
+/**
+ * @brief Opens the task body. The task function returns char.
+ */
+#define PT_BEGIN(pt) \
+	{ char ptYielded = 1; (void)ptYielded; switch ((pt)->lc) { case 0:
+
+/**
+ * @brief Closes the task body; the next call starts it again
+ */
+#define PT_END(pt) \
+	} ptYielded = 0; PT_INIT(pt); return PT_ENDED; }
+
+/**
+ * @brief Returns to the loop until cond is true, checking it each call
+ */
+#define PT_WAIT_UNTIL(pt, cond) \
+	do { (pt)->lc = __LINE__; PT_FALLTHROUGH; case __LINE__: \
+	     if (!(cond)) return PT_WAITING; } while (0)
+
+/**
+ * @brief Returns to the loop once, resuming here on the next call
+ */
+#define PT_YIELD(pt) \
+	do { ptYielded = 0; (pt)->lc = __LINE__; PT_FALLTHROUGH; case __LINE__: \
+	     if (ptYielded == 0) return PT_YIELDED; } while (0)
+
+/**
+ * @brief Leaves the task; the next call starts it again
+ */
+#define PT_EXIT(pt) \
+	do { PT_INIT(pt); return PT_EXITED; } while (0)
+
+#endif /* PT_H */
@@ -0,0 +1,343 @@
+/**----------------------------------------------------------------------------
+ *
+ *            \file ring.h
+--                                                                           --
+--              ECEN 5803 Mastering Embedded System Architecture             --
+--                  Project 1 Module 4                                       --
+--                Microcontroller Firmware                                   --
+--                      ring.h                                               --
+--                                                                           --
+-------------------------------------------------------------------------------
+--
+--  Designed for:  University of Colorado at Boulder
+--
+--
+--  Designed by:  Tristan Lennertz, Subhradeep Dutta, & Omkar Prabhu
+--
+-- Version: 2.1
+-- Date of current revision:  2018-02
+-- Target Microcontroller: Freescale MKL25ZVMT4
+-- Tools used:  ARM mbed compiler
+--              ARM mbed SDK
+--              Freescale FRDM-KL25Z Freedom Board
+--
+--
+--   Functional Description:
+--   Single producer, single consumer ring buffer template, the byte stream
+--   counterpart of event_queue.c. One side may be an interrupt handler and
+--   the other the main loop; neither ever masks interrupts.
+--
+--   The capacity N is a power of two fixed at compile time, so a slot is
+--   found by masking a free running 16-bit index. head is written only by
+--   the producer and tail only by the consumer; each is a single halfword
+--   store, and their difference is the fill level. The producer stores the
+--   data before publishing it by advancing head, and the consumer reads it
+--   before releasing the slots by advancing tail, with a barrier between.
+--
+--   What push does when the ring is full is the POLICY parameter:
+--     RING_DROP_NEW  the new items are discarded and counted
+--     RING_DROP_OLD  the oldest items are overwritten and counted. The
+--                    producer must be an interrupt handler, so it can never
+--                    be preempted by the consumer mid-push; a pop that was
+--                    interrupted by an overwrite notices and reads again.
+--     RING_BLOCK     push waits for room, counting each wait. Only for a
+--                    producer in the main loop whose consumer runs in an
+--                    interrupt, or it waits forever.
+--
+--   writeSpan()/commit() and readSpan()/consume() expose the contiguous run
+--   of free or filled slots at head or tail, for bulk copies and DMA. They
+--   are not for RING_DROP_OLD rings, whose producer may reclaim slots
+--   the consumer is still reading.
+--
+*/
+
+#ifndef RING_H
+#define RING_H
+
+#include <stdint.h>
+#include <string.h>
+
+#include "cmsis.h"
+
+/**
+ * @brief Overflow policies
+ */
+#define RING_DROP_NEW (0)
+#define RING_DROP_OLD (1)
+#define RING_BLOCK    (2)
+
+template <typename T, uint16_t N, uint8_t POLICY>
+class Ring
+{
+public:
+	Ring() : head_(0), tail_(0), pushed_(0), dropped_(0), waits_(0)
+	{
+	}
+
+	/*********************************/
+	/*     Producer side             */
+	/*********************************/
+
+	/**
+	 * @brief Adds one item
+	 *
+	 * @return 1 if stored, 0 if it was dropped (RING_DROP_NEW only)
+	 */
+	uint8_t push(const T & item)
+	{
+		uint16_t head = head_;
+
+		if ((uint16_t)(head - tail_) >= N)
+		{
+			if (POLICY == RING_DROP_NEW)
+			{
+				dropped_++;
+				return 0;
+			}
+			else if (POLICY == RING_DROP_OLD)
+				dropped_++;             /* the oldest goes; the consumer skips it */
+			else
+				waitForSpace(head, 1);
+		}
+
+		buf_[head & (N - 1)] = item;
+
+		/* Publish only once the slot is complete */
+		__DMB();
+		head_ = head + 1;
+		pushed_++;
+
+		return 1;
+	}
+
+	/**
+	 * @brief Adds up to count items in order, in at most two copies
+	 *
+	 * @return Items stored. Less than count only for RING_DROP_NEW, which
+	 * drops the ones that did not fit.
+	 */
+	uint16_t push(const T * items, uint16_t count)
+	{
+		uint16_t stored = 0;
+		uint16_t run;
+		T * span;
+
+		if (POLICY == RING_DROP_OLD)
+		{
+			for (; stored < count; stored++)
+				push(items[stored]);
+			return stored;
+		}
+
+		while (stored < count)
+		{
+			run = writeSpan(&span);
+
+			if (run == 0)
+			{
+				if (POLICY == RING_DROP_NEW)
+				{
+					dropped_ += count - stored;
+					break;
+				}
+				waitForSpace(head_, 1);
+				continue;
+			}
+
+			if (run > count - stored)
+				run = count - stored;
+
+			memcpy(span, items + stored, run * sizeof(T));
+			commit(run);
+			stored += run;
+		}
+
+		return stored;
+	}
+
+	/**
+	 * @brief Free slots from head to the end of the storage or to tail
+	 *
+	 * @return Slots that can be written at *span before calling commit()
+	 */
+	uint16_t writeSpan(T ** span)
+	{
+		uint16_t head = head_;
+		uint16_t avail = N - (uint16_t)(head - tail_);
+		uint16_t toEnd = N - (head & (N - 1));
+
+		*span = &buf_[head & (N - 1)];
+
+		return (avail < toEnd) ? avail : toEnd;
+	}
+
+	/**
+	 * @brief Publishes count items written through writeSpan()
+	 */
+	void commit(uint16_t count)
+	{
+		__DMB();
+		head_ = head_ + count;
+		pushed_ += count;
+	}
+
+	/**
+	 * @brief Items that can be pushed without a drop or a wait
+	 */
+	uint16_t space(void) const
+	{
+		return N - (uint16_t)(head_ - tail_);
+	}
+
+	/*********************************/
+	/*     Consumer side             */
+	/*********************************/
+
+	/**
+	 * @brief Takes the oldest item
+	 *
+	 * @return 1 if an item was copied to *item, 0 if the ring was empty
+	 */
+	uint8_t pop(T * item)
+	{
+		uint16_t tail;
+
+		do
+		{
+			tail = catchUp();
+			if (head_ == tail)
+				return 0;
+
+			*item = buf_[tail & (N - 1)];
+			__DMB();
+		} while (POLICY == RING_DROP_OLD && (uint16_t)(head_ - tail) > N);
+
+		/* Release the slot only once it has been copied */
+		tail_ = tail + 1;
+
+		return 1;
+	}
+
+	/**
+	 * @brief Takes up to count of the oldest items
+	 *
+	 * @return Items copied to items
+	 */
+	uint16_t pop(T * items, uint16_t count)
+	{
+		uint16_t taken = 0;
+		uint16_t run;
+		const T * span;
+
+		if (POLICY == RING_DROP_OLD)
+		{
+			while (taken < count && pop(&items[taken]))
+				taken++;
+			return taken;
+		}
+
+		while (taken < count && (run = readSpan(&span)) != 0)
+		{
+			if (run > count - taken)
+				run = count - taken;
+
+			memcpy(items + taken, span, run * sizeof(T));
+			consume(run);
+			taken += run;
+		}
+
+		return taken;
+	}
+
+	/**
+	 * @brief Filled slots from tail to the end of the storage or to head
+	 *
+	 * @return Items that can be read at *span before calling consume()
+	 */
+	uint16_t readSpan(const T ** span)
+	{
+		uint16_t tail = tail_;
+		uint16_t fill = (uint16_t)(head_ - tail);
+		uint16_t toEnd = N - (tail & (N - 1));
+
+		*span = &buf_[tail & (N - 1)];
+
+		/* Reads of the span must not start before head was seen */
+		__DMB();
+
+		return (fill < toEnd) ? fill : toEnd;
+	}
+
+	/**
+	 * @brief Releases count items read through readSpan()
+	 */
+	void consume(uint16_t count)
+	{
+		__DMB();
+		tail_ = tail_ + count;
+	}
+
+	/**
+	 * @brief Items waiting to be taken
+	 */
+	uint16_t size(void) const
+	{
+		uint16_t fill = (uint16_t)(head_ - tail_);
+
+		return (fill > N) ? N : fill;
+	}
+
+	uint8_t empty(void) const
+	{
+		return head_ == tail_;
+	}
+
+	/*********************************/
+	/*     Statistics                */
+	/*********************************/
+
+	uint32_t pushed(void) const { return pushed_; }     /* items stored */
+	uint32_t dropped(void) const { return dropped_; }   /* items lost to a full ring */
+	uint32_t waits(void) const { return waits_; }       /* pushes that waited (RING_BLOCK) */
+
+private:
+	/* The capacity must be a power of two the 16-bit indices can cover */
+	typedef char capacityCheck[(N != 0 && (N & (N - 1)) == 0 && N <= 32768) ? 1 : -1];
+
+	/**
+	 * @brief RING_BLOCK: spins until count slots are free
+	 */
+	void waitForSpace(uint16_t head, uint16_t count)
+	{
+		waits_++;
+		while ((uint16_t)(N - (uint16_t)(head - tail_)) < count)
+			;
+	}
+
+	/**
+	 * @brief RING_DROP_OLD: moves tail past anything the producer has
+	 * overwritten
+	 */
+	uint16_t catchUp(void)
+	{
+		uint16_t tail = tail_;
+		uint16_t head = head_;
+
+		if (POLICY == RING_DROP_OLD && (uint16_t)(head - tail) > N)
+		{
+			tail = head - N;
+			tail_ = tail;
+		}
+
+		return tail;
+	}
+
+	T buf_[N];
+	volatile uint16_t head_;        /* producer: next slot to fill */
+	volatile uint16_t tail_;        /* consumer: next slot to read */
+	volatile uint32_t pushed_;      /* producer */
+	volatile uint32_t dropped_;     /* producer */
+	volatile uint32_t waits_;       /* producer */
+};
+
+#endif /* RING_H */
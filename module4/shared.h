@@ -29,6 +29,21 @@
 */              
                           
 #include "mbed.h"  
+#include "freq.h"
+#include "cycle_count.h"
+#include "adc_dma.h"
+#include "adc_cal.h"
+#include "profile.h"
+#include "event_queue.h"
+#include "timer_wheel.h"
+#include "idle.h"
+#include "timebase.h"
+#include "uart_dma.h"
+#include "ring.h"
+#include "telemetry.h"
+#include "trace.h"
+#include "numfmt.h"
+#include "fmt.h"
  
  /*****************************************************************************
 * #defines available to all modules included here
@@ -46,15 +61,19 @@
 #define T2S    (2 * SEC)
                               
 #define LED_FLASH_PERIOD .5     /* in seconds */
-#define LED_TOGGLE_TICKS (78)   /* How many ticks at 6.4 ms per tick it takes to get */
+#define LED_TOGGLE_TICKS (5000) /* timer0 ticks between LED toggles, giving a */
 																/* 1 second flashing period for LED */
+#define DISPLAY_TICKS (16384)   /* timer0 ticks between status displays, 1.6384 s */
  
+#define SCHED_SLOTS 64      /* timer states in the longest task period, power of 2 */
+#define SCHED_NONE 0xFF     /* no task in this timer state */
+
 #define CLOCK_FREQUENCY_MHZ 8
 #define CODE_VERSION "2.1 2018/02/21"   /*   YYYY/MM/DD  */
 #define COPYRIGHT "Copyright (c) University of Colorado" 
      
  enum boolean { FALSE, TRUE };         /// \enum boolean  
- enum dmode {QUIET, NORMAL, DEBUG, VERSION};      /// \enum dmode 
+ enum dmode {QUIET, NORMAL, DEBUG, VERSION, BINARY};      /// \enum dmode 
  
  typedef unsigned char UCHAR;
  typedef unsigned char bit;
@@ -65,26 +84,39 @@
 extern "C" {
 #endif
  
+/**
+ * @brief One entry of the timer0 task table
+ */
+typedef struct
+{
+   const char * name;      /* short name for reports */
+   uint8_t period;         /* ticks between runs, power of 2 <= SCHED_SLOTS */
+   uint8_t phase;          /* tick within the period the task runs on */
+   void (*fn)(void);       /* the task, run from the timer interrupt */
+   uint32_t budget;        /* allowed execution time, core clock cycles */
+} schedTask_t;
+
 /************************************************************************/
 /*             Global Variable declarations                             */
 /************************************************************************/
  
  extern unsigned char Error_status;          // Variable for debugging use
- extern UCHAR  display_timer;   // 1 second software timer for display   
- extern UCHAR  display_flag;    // flag between timer interrupt and monitor.c, like
-                                // a binary semaphore
+ extern UCHAR  display_flag;    // set by main on an EV_DISPLAY event, cleared by
+                                // monitor.c once the status has been printed
+
+ extern eventQueue_t timer_events;   // events from timer0 to the main loop
+ extern uint32_t event_latency_max;  // longest post-to-handle delay, timer0 ticks
 	
- extern UCHAR  adc_flag;  // flag which times ADC sampling using the timer 
-                          // interrupt semaphore to main
-                          
  extern UCHAR tx_in_progress;                
  
- extern UCHAR *rx_in_ptr; /* pointer to the receive in data */
- extern UCHAR *rx_out_ptr; /* pointer to the receive out data*/
- extern UCHAR *tx_in_ptr; /* pointer to the transmit in data*/
- extern UCHAR *tx_out_ptr; /*pointer to the transmit out */                       
-#define RX_BUF_SIZE 10            /* size of receive buffer in bytes */
-#define TX_BUF_SIZE 40           /* size of transmit buffer in bytes */
+#define RX_BUF_SIZE 32            /* size of receive buffer in bytes, power of 2 */
+#define TX_BUF_SIZE 128          /* size of transmit buffer in bytes, power of 2 */
+
+ typedef Ring<UCHAR, RX_BUF_SIZE, RING_DROP_NEW> rxRing_t;
+ typedef Ring<UCHAR, TX_BUF_SIZE, RING_DROP_NEW> txRing_t;
+
+ extern rxRing_t rx_ring;   // filled by the UART0 interrupt, read by main
+ extern txRing_t tx_ring;   // filled by main, sent by transmit DMA
                                                                     
 /******************************************************************************
 * Some variable definitions are done in the module main.c and are externed in 
@@ -94,23 +126,19 @@ extern "C" {
 
  enum dmode display_mode = QUIET;
  
-UCHAR  adc_flag = 0;
- 
 UCHAR pause_flag = 0;           /* When set, halts automatic serial outputs */
 
 UCHAR serial_flag = 0;
 
-UCHAR led_flag = 0; 						/* set by the timer when LED should toggle */
-																/* will only be cleared by manually doing so */
+UCHAR display_flag = 0;         /* main owned, see the extern above */
+
+eventQueue_t timer_events;      /* written by timer0, drained by main */
+uint32_t event_latency_max = 0; /* longest post-to-handle delay, ticks */
  
  UCHAR tx_in_progress; 
- UCHAR *rx_in_ptr; /* pointer to the receive in data */
- UCHAR *rx_out_ptr; /* pointer to the receive out data*/
- UCHAR *tx_in_ptr; /* pointer to the transmit in data*/
- UCHAR *tx_out_ptr; /*pointer to the transmit out */        
     
- UCHAR  rx_buf[RX_BUF_SIZE];      /* define the storage */
- UCHAR  tx_buf[TX_BUF_SIZE];      /* define the storage */
+ rxRing_t rx_ring;                /* define the storage */
+ txRing_t tx_ring;                /* define the storage */
 
 #define MSG_BUF_SIZE 10
  UCHAR msg_buf[MSG_BUF_SIZE]; // define the storage for UART received messages
@@ -127,26 +155,14 @@ UCHAR led_flag = 0; 						/* set by the timer when LED should toggle */
 /*   Declarations     */
 /**********************/
 
-   extern volatile     UCHAR swtimer0;
-   extern volatile     UCHAR swtimer1;
-   extern volatile     UCHAR swtimer2;
-   extern volatile     UCHAR swtimer3; 
-   extern volatile     UCHAR swtimer4;    
-   extern volatile     UCHAR swtimer5;    
-   extern volatile     UCHAR swtimer6;    
-   extern volatile     UCHAR swtimer7;    
   
   extern UCHAR serial_flag;
-  extern UCHAR led_flag;
   extern UCHAR pause_flag; 
     
   extern enum dmode display_mode;
   
   extern UCHAR error_count;							/* UART error count */
   
-  extern UCHAR  rx_buf[];      /* declare the storage */
-  extern UCHAR  tx_buf[];      /* declare the storage */
-
 #define MSG_BUF_SIZE 10    
   extern  UCHAR msg_buf[MSG_BUF_SIZE]; // declare the storage for UART received messages
   extern  UCHAR msg_buf_idx;         // index into the received message buffer
@@ -157,16 +173,30 @@ UCHAR led_flag = 0; 						/* set by the timer when LED should toggle */
 * All function prototypes are externed in all the modules.
 *************************************************************************************************************/
 extern void monitor(void);  /* located in module monitor.c */
+extern void executive_init(void);   /* located in module main.c */
+extern void executive_pass(void);   /* located in module main.c */
 extern void timer0(void);   /* located in module timer0.c */
+extern uint32_t timer0_ticks(void);           /* located in module timer0.c */
+extern uint8_t sched_init(void);              /* located in module timer0.c */
+extern void display_restart(void);            /* located in module timer0.c */
+extern const schedTask_t schedTasks[];       /* located in module timer0.c */
+extern const uint8_t schedTaskCount;         /* located in module timer0.c */
+extern cycleStats_t schedStats[];            /* located in module timer0.c */
+extern uint32_t schedOverruns[];             /* located in module timer0.c */
 extern void serial(void);   /* located in module UART.c */
 
 extern void UART_put(UCHAR);                   /* located in module UART.c */
 extern UCHAR UART_get(void);                   /* located in module UART.c */
 extern UCHAR UART_input(void);                 /* located in module UART.c */
+extern UCHAR UART_pending(void);               /* located in module UART.c */
+extern UCHAR UART_tx_space(void);              /* located in module UART.c */
 extern void UART_direct_msg_put(const char *);
                                                /* located in module UART.c */
 extern void UART_msg_put(const char *); 
                                                /* located in module UART.c */
+extern UCHAR UART_msg_try(const char *);       /* located in module UART.c */
+extern UCHAR UART_block_try(const UCHAR *, uint16_t);
+                                               /* located in module UART.c */
 extern void UART_direct_hex_put(UCHAR);        /* located in module UART.c */
 extern void UART_direct_put(UCHAR);            /* located in module UART.c */
 extern void UART_hex_put(UCHAR);               /* located in module UART.c */
@@ -175,9 +205,9 @@ extern void UART_high_nibble_put(UCHAR);       /* located in module UART.c */
 extern void chk_UART_msg(void);               /* located in module monitor.c */
 extern void UART_msg_process(void);          /* located in module monitors.c */
 extern void status_report(void);             /* located in module monitor.c */  
-extern void set_display_mode(void);          /* located in module monitor.c */
-
-extern uint32_t calculateFrequency(uint16_t latestValue); /* located in freq.c */
+extern void monitor_banner(uint8_t);         /* located in module monitor.c */
+extern void monitor_telemetry(const uint16_t *, uint16_t, uint32_t, float, float);
+                                             /* located in module monitor.c */
 
 #ifdef __cplusplus
 }
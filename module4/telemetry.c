@@ -0,0 +1,228 @@
+/**----------------------------------------------------------------------------
+ *
+ *            \file telemetry.c
+--                                                                           --
+--              ECEN 5803 Mastering Embedded System Architecture             --
+--                  Project 1 Module 4                                       --
+--                Microcontroller Firmware                                   --
+--                      telemetry.c                                          --
+--                                                                           --
+-------------------------------------------------------------------------------
+--
+--  Designed for:  University of Colorado at Boulder
+--
+--
+--  Designed by:  Tristan Lennertz, Subhradeep Dutta, & Omkar Prabhu
+--
+-- Version: 2.1
+-- Date of current revision:  2018-02
+-- Target Microcontroller: Freescale MKL25ZVMT4
+-- Tools used:  ARM mbed compiler
+--              ARM mbed SDK
+--              Freescale FRDM-KL25Z Freedom Board
+--
+--
+--   Functional Description:
+--   Framing of the binary telemetry stream (see telemetry.h): CRC-16, COBS
+--   and the sample record layout. Target independent, so the host decoder
+--   is built from this same source.
+--
+--   The CRC uses a 16 entry table, a nibble at a time: 32 bytes of flash
+--   instead of 512, at about a microsecond per frame byte on the M0+.
+--
+*/
+
+#include <stdint.h>
+#include <string.h>
+
+#include "telemetry.h"
+
+/**
+ * @brief CRC-16/CCITT-FALSE of each nibble value
+ */
+static const uint16_t crcNibble[16] =
+{
+	0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+	0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF
+};
+
+/**
+ * @brief Runs len bytes through the CRC. Start with crc = 0xFFFF; the
+ * CRC of "123456789" is 0x29B1.
+ */
+uint16_t telemCrc16(const uint8_t * data, uint16_t len, uint16_t crc)
+{
+	while (len--)
+	{
+		crc = (uint16_t)((crc << 4) ^ crcNibble[(crc >> 12) ^ (*data >> 4)]);
+		crc = (uint16_t)((crc << 4) ^ crcNibble[(crc >> 12) ^ (*data & 0x0F)]);
+		data++;
+	}
+
+	return crc;
+}
+
+/**
+ * @brief COBS encodes len bytes. out needs len + len / 254 + 1 bytes; the
+ * terminating zero is not added.
+ *
+ * @return Encoded length
+ */
+uint16_t telemCobsEncode(const uint8_t * in, uint16_t len, uint8_t * out)
+{
+	uint16_t codeAt = 0;       /* where the current block's code byte goes */
+	uint16_t o = 1;
+	uint8_t code = 1;          /* block length so far, plus one */
+	uint16_t i;
+
+	for (i = 0; i < len; i++)
+	{
+		if (in[i] != 0)
+		{
+			out[o++] = in[i];
+			code++;
+		}
+
+		/* A zero, or a full block of 254 non-zero bytes, closes the block */
+		if (in[i] == 0 || code == 0xFF)
+		{
+			out[codeAt] = code;
+			codeAt = o++;
+			code = 1;
+		}
+	}
+	out[codeAt] = code;
+
+	return o;
+}
+
+/**
+ * @brief Decodes one COBS frame, without its terminating zero. out needs
+ * len bytes.
+ *
+ * @return Decoded length, or 0 if the frame is malformed
+ */
+uint16_t telemCobsDecode(const uint8_t * in, uint16_t len, uint8_t * out)
+{
+	uint16_t i = 0;
+	uint16_t o = 0;
+	uint8_t code;
+	uint8_t n;
+
+	while (i < len)
+	{
+		code = in[i++];
+		if (code == 0 || (uint16_t)(i + code - 1) > len)
+			return 0;
+
+		for (n = 1; n < code; n++)
+		{
+			if (in[i] == 0)
+				return 0;
+			out[o++] = in[i++];
+		}
+
+		/* Every block but a full one stands for a zero, except the last */
+		if (code != 0xFF && i < len)
+			out[o++] = 0;
+	}
+
+	return o;
+}
+
+/**
+ * @brief Little endian field stores and loads, shared with the trace
+ * frames (trace.c) so the wire format has one implementation
+ */
+void telemPut16(uint8_t * p, uint16_t v)
+{
+	p[0] = (uint8_t)v;
+	p[1] = (uint8_t)(v >> 8);
+}
+
+void telemPut32(uint8_t * p, uint32_t v)
+{
+	telemPut16(p, (uint16_t)v);
+	telemPut16(p + 2, (uint16_t)(v >> 16));
+}
+
+uint16_t telemGet16(const uint8_t * p)
+{
+	return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+uint32_t telemGet32(const uint8_t * p)
+{
+	return telemGet16(p) | ((uint32_t)telemGet16(p + 2) << 16);
+}
+
+/**
+ * @brief CRC, COBS and the delimiter around a payload of len bytes, which
+ * must have room for the 2 byte CRC after it. out needs len + 2 bytes plus
+ * the COBS overhead and the delimiter.
+ */
+uint16_t telemFrame(uint8_t * payload, uint16_t len, uint8_t * out)
+{
+	uint16_t n;
+
+	telemPut16(payload + len, telemCrc16(payload, len, 0xFFFF));
+	n = telemCobsEncode(payload, (uint16_t)(len + 2), out);
+	out[n++] = 0;
+
+	return n;
+}
+
+void telemPackSample(const telemSample_t * rec, uint8_t * payload)
+{
+	uint32_t bits;
+
+	payload[0] = TELEM_REC_SAMPLE;
+	telemPut16(payload + 1, rec->seq);
+	telemPut32(payload + 3, (uint32_t)rec->timeUs);
+	telemPut32(payload + 7, (uint32_t)(rec->timeUs >> 32));
+	telemPut32(payload + 11, rec->freqHz);
+	memcpy(&bits, &rec->flow, sizeof(bits));
+	telemPut32(payload + 15, bits);
+	memcpy(&bits, &rec->temp, sizeof(bits));
+	telemPut32(payload + 19, bits);
+	telemPut16(payload + 23, rec->adcMin);
+	telemPut16(payload + 25, rec->adcMax);
+	telemPut16(payload + 27, rec->adcMean);
+}
+
+/**
+ * @return 1 if payload holds a sample record, 0 if not
+ */
+uint8_t telemUnpackSample(const uint8_t * payload, uint16_t len, telemSample_t * rec)
+{
+	uint32_t bits;
+
+	if (len != TELEM_SAMPLE_LEN || payload[0] != TELEM_REC_SAMPLE)
+		return 0;
+
+	rec->seq = telemGet16(payload + 1);
+	rec->timeUs = telemGet32(payload + 3) | ((uint64_t)telemGet32(payload + 7) << 32);
+	rec->freqHz = telemGet32(payload + 11);
+	bits = telemGet32(payload + 15);
+	memcpy(&rec->flow, &bits, sizeof(bits));
+	bits = telemGet32(payload + 19);
+	memcpy(&rec->temp, &bits, sizeof(bits));
+	rec->adcMin = telemGet16(payload + 23);
+	rec->adcMax = telemGet16(payload + 25);
+	rec->adcMean = telemGet16(payload + 27);
+
+	return 1;
+}
+
+/**
+ * @brief Builds the complete frame for a sample record. frame needs
+ * TELEM_FRAME_MAX bytes.
+ */
+uint16_t telemFrameSample(const telemSample_t * rec, uint8_t * frame)
+{
+	uint8_t raw[TELEM_SAMPLE_LEN + 2];
+
+	telemPackSample(rec, raw);
+
+	return telemFrame(raw, TELEM_SAMPLE_LEN, frame);
+}
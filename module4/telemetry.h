@@ -0,0 +1,134 @@
+/**----------------------------------------------------------------------------
+ *
+ *            \file telemetry.h
+--                                                                           --
+--              ECEN 5803 Mastering Embedded System Architecture             --
+--                  Project 1 Module 4                                       --
+--                Microcontroller Firmware                                   --
+--                      telemetry.h                                          --
+--                                                                           --
+-------------------------------------------------------------------------------
+--
+--  Designed for:  University of Colorado at Boulder
+--
+--
+--  Designed by:  Tristan Lennertz, Subhradeep Dutta, & Omkar Prabhu
+--
+-- Version: 2.1
+-- Date of current revision:  2018-02
+-- Target Microcontroller: Freescale MKL25ZVMT4
+-- Tools used:  ARM mbed compiler
+--              ARM mbed SDK
+--              Freescale FRDM-KL25Z Freedom Board
+--
+--
+--   Functional Description:
+--   Wire format of the binary telemetry stream (display mode BINARY). The
+--   firmware sends one sample record per ADC block, 156.25 a second, and
+--   the host tools in host/ decode them; both build this file unchanged.
+--
+--   A record is packed little endian into a fixed payload and followed by
+--   its CRC-16/CCITT-FALSE (polynomial 0x1021, initial value 0xFFFF, sent
+--   low byte first). Payload and CRC are COBS encoded, which leaves no zero
+--   byte in them, and a 0x00 ends the frame. A receiver that starts mid
+--   stream, or loses bytes, resynchronises at the next zero; any text the
+--   monitor sends in between fails the CRC and is skipped.
+--
+--   Sample record payload, TELEM_SAMPLE_LEN bytes:
+--     0  uint8   record type, TELEM_REC_SAMPLE
+--     1  uint16  sequence number, one per record sent or dropped
+--     3  uint64  timestamp, microseconds since start up (timebase.h)
+--    11  uint32  frequency estimate, Hz
+--    15  float   flow (IEEE 754 single)
+--    19  float   temperature, degrees C (IEEE 754 single)
+--    23  uint16  lowest ADC count in the block
+--    25  uint16  highest ADC count in the block
+--    27  uint16  mean ADC count of the block
+--
+--   The trace log dump (monitor command L, trace.h) uses the same framing
+--   with record types TELEM_REC_TRACE_INFO and TELEM_REC_TRACE.
+--
+*/
+
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <stdint.h>
+
+/**
+ * @brief Record types, the first payload byte
+ */
+#define TELEM_REC_SAMPLE     (1)
+#define TELEM_REC_TRACE      (2)   /* trace records, trace.h */
+#define TELEM_REC_TRACE_INFO (3)   /* trace dump header, trace.h */
+
+/**
+ * @brief Payload length of a sample record, without the CRC
+ */
+#define TELEM_SAMPLE_LEN (29)
+
+/**
+ * @brief Longest frame on the wire: payload, CRC, one COBS code byte per
+ * 254 bytes (one here) and the terminating zero
+ */
+#define TELEM_FRAME_MAX (TELEM_SAMPLE_LEN + 2 + 1 + 1)
+
+/**
+ * @brief Longest frame of any record type, for receivers. No frame may
+ * be longer than the transmit ring, as it is queued whole.
+ */
+#define TELEM_FRAME_LIMIT (128)
+
+/**
+ * @brief ADC blocks per record sent, so 1 gives 156.25 records a second.
+ * Each frame is 33 bytes, 45% of the link at 115200 baud.
+ */
+#ifndef TELEM_BLOCKS_PER_RECORD
+#define TELEM_BLOCKS_PER_RECORD (1)
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief One sample record, unpacked
+ */
+typedef struct
+{
+	uint16_t seq;           /* sequence number, wraps at 65536 */
+	uint64_t timeUs;        /* microseconds since start up */
+	uint32_t freqHz;        /* frequency estimate */
+	float flow;
+	float temp;             /* degrees C */
+	uint16_t adcMin;        /* ADC block statistics, counts */
+	uint16_t adcMax;
+	uint16_t adcMean;
+} telemSample_t;
+
+uint16_t telemCrc16(const uint8_t * data, uint16_t len, uint16_t crc);
+uint16_t telemCobsEncode(const uint8_t * in, uint16_t len, uint8_t * out);
+uint16_t telemCobsDecode(const uint8_t * in, uint16_t len, uint8_t * out);
+
+/* Little endian fields, as every record type lays them out */
+void telemPut16(uint8_t * p, uint16_t v);
+void telemPut32(uint8_t * p, uint32_t v);
+uint16_t telemGet16(const uint8_t * p);
+uint32_t telemGet32(const uint8_t * p);
+
+/* Payload of len bytes (with 2 spare after it) -> CRC, COBS, terminating
+   zero. Returns the frame length. */
+uint16_t telemFrame(uint8_t * payload, uint16_t len, uint8_t * out);
+
+/* Sample record <-> payload, without the CRC */
+void telemPackSample(const telemSample_t * rec, uint8_t * payload);
+uint8_t telemUnpackSample(const uint8_t * payload, uint16_t len, telemSample_t * rec);
+
+/* Whole frame: payload + CRC, COBS, terminating zero. Returns its length. */
+uint16_t telemFrameSample(const telemSample_t * rec, uint8_t * frame);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TELEMETRY_H */
@@ -0,0 +1,60 @@
+/**----------------------------------------------------------------------------
+ *
+ *            \file timebase.h
+--                                                                           --
+--              ECEN 5803 Mastering Embedded System Architecture             --
+--                  Project 1 Module 4                                       --
+--                Microcontroller Firmware                                   --
+--                      timebase.h                                           --
+--                                                                           --
+-------------------------------------------------------------------------------
+--
+--  Designed for:  University of Colorado at Boulder
+--
+--
+--  Designed by:  Tristan Lennertz, Subhradeep Dutta, & Omkar Prabhu
+--
+-- Version: 2.1
+-- Date of current revision:  2018-02
+-- Target Microcontroller: Freescale MKL25ZVMT4
+-- Tools used:  ARM mbed compiler
+--              ARM mbed SDK
+--              Freescale FRDM-KL25Z Freedom Board
+--
+--
+--   Functional Description:
+--   Monotonic 64-bit time since start up, counted in timer0 ticks. At
+--   100 us a tick it does not wrap for 58 million years, so timestamps
+--   can be compared and subtracted without wrap handling.
+--
+--   The count is kept in timer0.cpp as two 32-bit halves. Readers take
+--   high, low, high and retry if the high half moved, so a read needs no
+--   critical section and costs a few loads. This is safe from the main
+--   loop and from interrupts of timer0's priority or lower; a higher
+--   priority interrupt landing inside the carry could see the old high
+--   half with the new low half.
+--
+*/
+
+#ifndef TIMEBASE_H
+#define TIMEBASE_H
+
+#include <stdint.h>
+
+/**
+ * @brief Length of one timer0 tick
+ */
+#define TIMEBASE_US_PER_TICK (100)
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+uint64_t timebaseTicks(void);     /* timer0 ticks since start up */
+uint64_t timebaseUs(void);        /* the same in microseconds */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TIMEBASE_H */
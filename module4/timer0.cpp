@@ -31,37 +31,42 @@
    The System Timer interrupt acts as the real time scheduler for the firmware.
    Each time the interrupt occurs, different tasks are done based on critical 
    timing requirement for each task.  
-   There are 256 timer states (an 8-bit counter that rolls over) so the 
-   period of the scheduler is 25.6 ms.  However, some tasks are executed every
-   other time (the 200 us group) and some every 4th time (the 400 us group) and
-   so on.  Some high priority tasks are executed every time.  The code for the
-   tasks is divided up into the groups which define how often the task is 
-   executed.  The structure of the code is shown below:
-    
-   I.  Entry and timer state calculation
-   II. 100 us group
-      A.  Fast Software timers
-      B.  Read Sensors
-      C.  Update 
-   III. 200 us group
-      A. 
-      B.
-   IV.  400 us group
-      A.  Medium Software timers
-      B. 
-    V.   800 us group
-      A.  Set 420 PWM Period
-   VI   1.6 ms group
-      A. Display timer and flag
-      B. Heartbeat/ LED outputs
-   VII  3.2 ms group
-      A. Slow Software Timers   
-    VIII 6.4 ms group A
-      A. Very Slow Software Timers
-   IX.  Long time group
-      A. Determine Mode
-      B. Heartbeat/ LED outputs       
-   X.  Exit
+
+   Software timers are kept on a timing wheel (timer_wheel.c), advanced by
+   the every tick task. Arming one costs the same however long the delay,
+   and a tick only touches the timers expiring in it, so there is no per
+   timer countdown here any more. timer0's own periodic work, the display
+   and LED heartbeat, runs from wheel timers armed in sched_init().
+
+   The tasks are listed in schedTasks[], each with a period (a power of two
+   number of ticks, up to SCHED_SLOTS), the phase within that period it runs
+   on, the function, and a cycle budget. Period 1 tasks run every tick. For
+   the rest, sched_init() builds a SCHED_SLOTS entry lookup from timer_state
+   to the one task due in that tick, so timer0() dispatches in constant time
+   however many tasks there are.
+
+   The phases follow the original group layout: a task of period 2^n runs on
+   phase 2^(n-1), so the 200 us, 400 us, ... 3.2 ms groups land on timer
+   states whose lowest set bit differs, and the 6.4 ms groups share the
+   remaining states between them. No two slow tasks ever run in the same
+   tick; sched_init() rejects a table that would make them.
+
+      timer states          period    phase   task
+      every                 100 us      -     Timer wheel
+      1,3,5,7,...           200 us      1     (free)
+      2,6,10,14,...         400 us      2     (free)
+      4,12,20,28,...        800 us      4     (free)
+      8,24,40,56,...        1.6 ms      8     (free)
+      16,48,80,112,...      3.2 ms     16     (free)
+      32,96,160,224         6.4 ms     32     (free)
+      0,64,128,192          6.4 ms      0     (free)
+
+   The old long time group (every 51.2 ms) had no work in it and is gone;
+   a task slower than SCHED_SLOTS ticks can count its own 6.4 ms runs.
+
+   Every task run is timed with the cycle counter into schedStats[] and
+   counted in schedOverruns[] when it takes longer than its budget. Each
+   tick and each overrun also leaves a record in the trace log (trace.h).
    
 -- 
 --      Copyright (c) 2015 Tim Scherr  All rights reserved.
@@ -90,196 +95,234 @@ extern "C" {
 
 	 DigitalOut BugMe(PTB9);
 	
-   volatile    UCHAR swtimer0 = 0;
-   volatile    UCHAR swtimer1 = 0;
-   volatile    UCHAR swtimer2 = 0;
-   volatile    UCHAR swtimer3 = 0; 
-   volatile    UCHAR swtimer4 = 0;    
-   volatile    UCHAR swtimer5 = 0;    
-   volatile    UCHAR swtimer6 = 0;    
-   volatile    UCHAR swtimer7 = 0; 
-
   volatile uint16_t SwTimerIsrCounter = 0U;
-  UCHAR  display_timer = 0;  // 1 second software timer for display   
-  UCHAR  display_flag = 0;   // flag between timer interrupt and monitor.c, like
-                             // a binary semaphore      
  
-   static   uint32_t System_Timer_count = 0; // 32 bits, counts for 
+   static   volatile uint32_t System_Timer_count = 0; // 32 bits, counts for 
                                                   // 119 hours at 100 us period
+   static   volatile uint32_t System_Timer_count_hi = 0; // carries out of
+                                                  // System_Timer_count, see timebase.h
    static   uint16_t timer0_count = 0; // 16 bits, counts for 
                                           // 6.5 seconds at 100 us period                                                  
    static   UCHAR timer_state = 0;   
-   static   UCHAR long_time_state = 0; 
-       //  variable which splits timer_states into groups
-      //  tasks are run in their assigned group times
+       //  variable which splits ticks into the task slots
 //    DigitalOut BugMe (PTB9);   // debugging information out on PTB9      
 #ifdef __cplusplus
 }
 #endif
             
 /*********************************/
-/*     Start of Code             */
+/*     Task Functions            */
 /*********************************/
-// I. Entry and Timer State Calculation
 
-void timer0(void)
+//  Timer wheel, every 100 us: runs the callbacks of expired software timers
+static void task_timer_wheel(void)
 {
- 
-  BugMe = 1;  // debugging signal high during Timer0 interrupt on PTB9
-  
-/************************************************/    
-//  Determine Timer0 state and task groups
-/************************************************/   
-   timer_state++;          // increment timer_state each time
-   if (timer_state == 0)   
-   {
-      long_time_state++;   // increment long time state every 25.6 ms
+   twTick();
 
-   }
+//    Update Sensors
+//   ADC0 is triggered by TPM1 and emptied by DMA (adc_dma.cpp); main
+//   is handed whole blocks, so there is nothing to do here per sample
+}
 
-/*******************************************************************/
-/*      100 us Group                                                 */
-/*******************************************************************/
-//  II.  100 us Group
+/*********************************/
+/*     Software Timers           */
+/*********************************/
 
-//     A. Update Fast Software timers 
-   if (swtimer0 > 0)     // if not yet expired, 
-      (swtimer0)--;        // then decrement fast timer (1 ms to 256 ms)
-   if (swtimer1 > 0)     // if not yet expired, 
-      (swtimer1)--;        // then decrement fast timer (1 ms to 256 ms)
-  
-//    B.   Update Sensors
+static twTimer_t displayTimer;   // status display period
+static twTimer_t ledTimer;       // red LED heartbeat
 
-   /****************      ECEN 5803 add code as indicated   ***************/
-   adc_flag = 1;   // time to sample the ADC in main
+//  Display period elapsed, every 1.6384 s: now OK to display
+static void display_expired(void * arg)
+{
+   (void)arg;
+   evqPost(&timer_events, EV_DISPLAY, System_Timer_count);
+}
 
-/*******************************************************************/
-/*      200 us Group                                                 */
-/*******************************************************************/   
+/**
+ * @brief Starts a fresh display period, so the first status after a mode
+ * change comes a full period later
+ */
+void display_restart(void)
+{
+   twArm(&displayTimer, DISPLAY_TICKS, DISPLAY_TICKS);
+}
 
-   if ((timer_state & 0x01) != 0)  // 2 ms group, odds only
-   {
-      ;                           
-   } // end  2 ms group
+//  Heartbeat, every 0.5 s: toggle the red LED
+static void led_expired(void * arg)
+{
+   (void)arg;
+   evqPost(&timer_events, EV_LED_TOGGLE, System_Timer_count);
+}
 
-/*******************************************************************/
-/*      400 us Group                                                 */
-/*******************************************************************/   
-   else if ((timer_state & 0x02) != 0)
-   {
-//   IV.  400 us group  
-//           timer states 2,6,10,14,18,22,...254 
+/*********************************/
+/*     Task Table                */
+/*********************************/
 
-//      A.  Medium Software timers
-      if (swtimer2 > 0)  // if not yet expired, every other time 
-         (swtimer2)--;     // then decrement med timer  (4 ms to 1024 ms)
-      if (swtimer3 > 0) // if not yet expired, every other time 
-         (swtimer3)--;        // then decrement med timer  (4 ms to 1024 ms)
+/**
+ * @brief The scheduled tasks. Budgets are in core clock cycles (48 per us);
+ * the whole tick has 4800.
+ */
+const schedTask_t schedTasks[] =
+{
+   /* name          period phase  function                 budget */
+   { "timer_wheel",      1,   0,  task_timer_wheel,          480 },
+};
 
-//      B.  
-   } // end 400 us group
-   
-/*******************************************************************/
-/*      800 us Group                                                 */
-/*******************************************************************/   
-   else if ((timer_state & 0x04) != 0)
-   {
-//   V.   8 ms group
-//           timer states 4, 12, 20, 28 ... 252   every 1/8
+const uint8_t schedTaskCount = sizeof(schedTasks) / sizeof(schedTasks[0]);
 
-//     A.  Set 
-   }   // end 800 us group
-   
-/*******************************************************************/
-/*      1.6 ms Group                                                 */
-/*******************************************************************/   
-   else if ((timer_state & 0x08) != 0)
-   {
-// VI   1.6 ms group
-//           timer states 8, 24, 40, 56, .... 248  every 1/16
+/**
+ * @brief Measured execution time and budget overruns of each task, indexed
+ * as schedTasks[]
+ */
+cycleStats_t schedStats[sizeof(schedTasks) / sizeof(schedTasks[0])];
+uint32_t schedOverruns[sizeof(schedTasks) / sizeof(schedTasks[0])];
 
-   }   // end 1.6 ms group
-   
-/*******************************************************************/
-/*      3.2 ms Group                                                 */
-/*******************************************************************/   
-   else if ((timer_state & 0x10) != 0)
+/**
+ * @brief Every tick tasks, and the slow task due in each slot (or
+ * SCHED_NONE), built by sched_init()
+ */
+static uint8_t schedEveryTick[sizeof(schedTasks) / sizeof(schedTasks[0])];
+static uint8_t schedEveryTickCount = 0;
+static uint8_t schedSlots[SCHED_SLOTS];
+
+/**
+ * @brief Builds the dispatch lookup from schedTasks[], empties the timer
+ * wheel and arms timer0's periodic timers. Must be called before timer0
+ * is attached.
+ *
+ * @return 0 if the table is valid, otherwise 1 + the index of the first
+ * task with a bad period or phase, or whose slots collide with another task
+ */
+uint8_t sched_init(void)
+{
+   uint8_t i, slot;
+
+   twInit();
+   twTimerInit(&displayTimer, display_expired, 0);
+   twArm(&displayTimer, DISPLAY_TICKS, DISPLAY_TICKS);
+   twTimerInit(&ledTimer, led_expired, 0);
+   twArm(&ledTimer, LED_TOGGLE_TICKS, LED_TOGGLE_TICKS);
+
+   schedEveryTickCount = 0;
+   for (slot = 0; slot < SCHED_SLOTS; slot++)
+      schedSlots[slot] = SCHED_NONE;
+
+   for (i = 0; i < schedTaskCount; i++)
    {
-// VII  3.2 ms group
-//          timer states 16, 48, 80, 112, 144, 176, 208, 240
-
-//    A. Slow Software Timers
-      if (swtimer4 > 0)  // if not yet expired, every 32nd time
-         (swtimer4)--;        // then decrement slow timer (32 ms to 8 s)
-      if (swtimer5 > 0) // if not yet expired, every 32nd time
-         (swtimer5)--;        // then decrement slow timer (32 ms to 8 s)
-         
-//    B.  Update
-    
-   }   // end 3.2 ms group
-   
-/*******************************************************************/
-/*      6.4 ms Group A                                              */
-/*******************************************************************/   
-   else if ((timer_state & 0x20) != 0)
+      const schedTask_t * task = &schedTasks[i];
+
+      if (task->period == 0 || task->period > SCHED_SLOTS ||
+          (task->period & (task->period - 1)) != 0 || task->phase >= task->period)
+         return i + 1;
+
+      if (task->period == 1)
+      {
+         schedEveryTick[schedEveryTickCount++] = i;
+         continue;
+      }
+
+      for (slot = task->phase; slot < SCHED_SLOTS; slot += task->period)
+      {
+         if (schedSlots[slot] != SCHED_NONE)
+            return i + 1;
+         schedSlots[slot] = i;
+      }
+   }
+
+   return 0;
+}
+
+/**
+ * @brief Runs one task, timing it against its budget
+ */
+static void sched_run(uint8_t i)
+{
+   uint32_t cycStart = cycleCountRead();
+   uint32_t cycles;
+
+   schedTasks[i].fn();
+
+   cycles = cycleCountElapsed(cycStart, cycleCountRead());
+   cycleStatsUpdate(&schedStats[i], cycles);
+   if (cycles > schedTasks[i].budget)
    {
-// VIII 6.4 ms group A
-//           timer states 32, 96, 160, 224 
+      schedOverruns[i]++;
+      TRACE_AT(cycStart, TRACE_TASK_OVERRUN, i, cycles);
+   }
+}
 
-//    A. Very Slow Software Timers
-      if (swtimer6 > 0)  // if not yet expired, every 64th 
-                                            // time 
-         (swtimer6)--;        // then decrement very slow timer (6.4 ms to 1.6s)
+/**
+ * @brief timer0 ticks (100 us) since start up, the time base of events
+ */
+uint32_t timer0_ticks(void)
+{
+   return System_Timer_count;
+}
 
-//    B.  Update
+/**
+ * @brief Ticks since start up, all 64 bits. Retries if a carry into the
+ * high half lands between the reads (see timebase.h).
+ */
+uint64_t timebaseTicks(void)
+{
+   uint32_t hi, lo;
 
-   }   // end 6.4 ms group A
-   
-/*******************************************************************/
-/*      6.4 ms Group B                                              */
-/*******************************************************************/   
-   else 
+   do
    {
-// IX.  6.4 ms group B
-//       timer states 0, 64, 128, 192
+      hi = System_Timer_count_hi;
+      lo = System_Timer_count;
+   } while (hi != System_Timer_count_hi);
 
-//    A.  Update
+   return ((uint64_t)hi << 32) | lo;
+}
 
-//    A. Display timer and flag
-      display_timer--; // decrement display timer every 6.4 ms.  Total time is      
-                      // 256*6.4ms = 1.6384 seconds. 
-      if (display_timer == 1)
-         display_flag = 1;     // every 1.6384 seconds, now OK to display
+/**
+ * @brief Microseconds since start up, to the nearest tick
+ */
+uint64_t timebaseUs(void)
+{
+   return timebaseTicks() * TIMEBASE_US_PER_TICK;
+}
 
+/*********************************/
+/*     Start of Code             */
+/*********************************/
+// I. Entry and Timer State Calculation
 
-//    B. Heartbeat/ LED outputs
-//   Generate Outputs  ************************************
+void timer0(void)
+{
+  uint8_t i, slot;
  
-    // Create an 0.5 second RED LED heartbeat here. 
-    if (swtimer7 > 0)   // if not yet expired, every 64th time
-      (swtimer7)--;     // then decrement very slow timer (6.4 ms to 1.6s)
-    else
-    {
-      led_flag = 1; 
-      swtimer7 = LED_TOGGLE_TICKS; 
-    }
-
-   }   // end 6.4 ms group B
-   
-/*******************************************************************/
-/*      Long Time Group                                            */
-/*******************************************************************/      
-   if (((long_time_state & 0x01) != 0) && (timer_state == 0))  
-                              // every other long time, every 51.2 ms
-   {
-// X.   Long time group
-    }
+  uint32_t profT = profStart();  // execution time, see profile.c
+  
+  BugMe = 1;  // debugging signal high during Timer0 interrupt on PTB9
+  
+/************************************************/    
+//  Determine Timer0 state and task groups
+/************************************************/   
+   timer_state++;          // increment timer_state each time
+
+/************************************************/    
+//  Dispatch the tasks due in this timer state
+/************************************************/   
+   for (i = 0; i < schedEveryTickCount; i++)
+      sched_run(schedEveryTick[i]);
+
+   slot = schedSlots[timer_state & (SCHED_SLOTS - 1)];
+   if (slot != SCHED_NONE)
+      sched_run(slot);
 
-   System_Timer_count++;  
+   if (++System_Timer_count == 0)  // low half wrapped, every 119 hours
+      System_Timer_count_hi++;
    timer0_count++;
    SwTimerIsrCounter++;
    
    BugMe = 0;  // debugging signal high during Timer0 interrupt on PTB9
+   
+   profEnd(PROF_TIMER0, profT);
+
+   // One record a tick, stamped at entry, so the trace has the tick grid
+   TRACE_AT(profT, TRACE_TIMER0, timer_state, cycleCountElapsed(profT, cycleCountRead()));
 }
 
 
@@ -0,0 +1,310 @@
+/**----------------------------------------------------------------------------
+ *
+ *            \file timer_wheel.c
+--                                                                           --
+--              ECEN 5803 Mastering Embedded System Architecture             --
+--                  Project 1 Module 4                                       --
+--                Microcontroller Firmware                                   --
+--                      timer_wheel.c                                        --
+--                                                                           --
+-------------------------------------------------------------------------------
+--
+--  Designed for:  University of Colorado at Boulder
+--
+--
+--  Designed by:  Tristan Lennertz, Subhradeep Dutta, & Omkar Prabhu
+--
+-- Version: 2.1
+-- Date of current revision:  2018-02
+-- Target Microcontroller: Freescale MKL25ZVMT4
+-- Tools used:  ARM mbed compiler
+--              ARM mbed SDK
+--              Freescale FRDM-KL25Z Freedom Board
+--
+--
+--   Functional Description:
+--   Hierarchical timing wheel (see timer_wheel.h).
+--
+--   A timer due in d ticks goes into level n, the smallest with
+--   d < TW_SLOTS^(n+1), in the slot selected by bits n*TW_SLOT_BITS and up
+--   of its expiry tick. Whenever the level n index wraps to zero, the next
+--   level n+1 slot is emptied and its timers placed again; by then they
+--   are due within TW_SLOTS^(n+1) ticks and land in level n or below.
+--   Level 0 slots hold only timers due on exactly that tick.
+--
+--   The wheel may be changed from the main loop and from any interrupt,
+--   so every list change is made with interrupts masked. Callbacks run
+--   from twTick() with the mask restored, and may arm or cancel any
+--   timer, including their own.
+--
+*/
+
+#include <stdint.h>
+
+#include "cmsis.h"
+#include "timer_wheel.h"
+
+/**
+ * @brief Slot list heads, one circular list per slot
+ */
+static twLink_t wheel[TW_LEVELS][TW_SLOTS];
+
+/**
+ * @brief Wheel time, ticks since twInit()
+ */
+static uint32_t twNow = 0;
+
+/**
+ * @brief Statistics, for the monitor
+ */
+static uint32_t armedTimers = 0;
+static uint32_t firedTimers = 0;
+static uint32_t cascadedTimers = 0;
+
+/**
+ * @brief Masks interrupts, returning the previous mask for twLeave()
+ */
+static uint32_t twEnter(void)
+{
+	uint32_t primask = __get_PRIMASK();
+
+	__disable_irq();
+	return primask;
+}
+
+static void twLeave(uint32_t primask)
+{
+	__set_PRIMASK(primask);
+}
+
+static void listInit(twLink_t * head)
+{
+	head->next = head;
+	head->prev = head;
+}
+
+static void listAppend(twLink_t * head, twLink_t * link)
+{
+	link->prev = head->prev;
+	link->next = head;
+	head->prev->next = link;
+	head->prev = link;
+}
+
+static void listRemove(twLink_t * link)
+{
+	link->prev->next = link->next;
+	link->next->prev = link->prev;
+	listInit(link);
+}
+
+/**
+ * @brief Links a timer into the slot for its expiry tick. Interrupts must
+ * be masked.
+ */
+static void twPlace(twTimer_t * t)
+{
+	uint32_t delta = t->expires - twNow;
+	uint32_t when = t->expires;
+	uint8_t level = 0;
+
+	/* Too far out for the wheel: park it at the far end */
+	if (delta > TW_MAX_DELAY)
+	{
+		delta = TW_MAX_DELAY;
+		when = twNow + TW_MAX_DELAY;
+	}
+
+	while (level < TW_LEVELS - 1 && delta >= (1UL << (TW_SLOT_BITS * (level + 1))))
+		level++;
+
+	listAppend(&wheel[level][(when >> (TW_SLOT_BITS * level)) & (TW_SLOTS - 1)], &t->link);
+}
+
+/**
+ * @brief Empties one slot of a coarser level into the finer ones
+ */
+static void twCascade(uint8_t level)
+{
+	twLink_t * head = &wheel[level][(twNow >> (TW_SLOT_BITS * level)) & (TW_SLOTS - 1)];
+	twLink_t pending;
+	uint32_t primask = twEnter();
+
+	/* Detach the whole slot first; placing may append to the same slot */
+	if (head->next == head)
+	{
+		twLeave(primask);
+		return;
+	}
+	pending.next = head->next;
+	pending.prev = head->prev;
+	pending.next->prev = &pending;
+	pending.prev->next = &pending;
+	listInit(head);
+
+	while (pending.next != &pending)
+	{
+		twTimer_t * t = (twTimer_t *)pending.next;
+
+		listRemove(&t->link);
+		twPlace(t);
+		cascadedTimers++;
+	}
+
+	twLeave(primask);
+}
+
+/**
+ * @brief Empties every slot. Timers that were armed are forgotten, so call
+ * it once at start up, before arming anything.
+ */
+void twInit(void)
+{
+	uint8_t level, slot;
+
+	for (level = 0; level < TW_LEVELS; level++)
+		for (slot = 0; slot < TW_SLOTS; slot++)
+			listInit(&wheel[level][slot]);
+
+	twNow = 0;
+	armedTimers = 0;
+}
+
+/**
+ * @brief Prepares a timer for use. It starts unarmed.
+ */
+void twTimerInit(twTimer_t * t, void (*callback)(void *), void * arg)
+{
+	listInit(&t->link);
+	t->expires = 0;
+	t->period = 0;
+	t->callback = callback;
+	t->arg = arg;
+}
+
+/**
+ * @brief Arms a timer, or re-arms it if it is already running
+ *
+ * @param ticks  timer0 ticks until the callback runs; 0 is taken as 1
+ * @param period ticks between later runs, or 0 to run only once
+ */
+void twArm(twTimer_t * t, uint32_t ticks, uint32_t period)
+{
+	uint32_t primask = twEnter();
+
+	if (t->link.next != &t->link)
+		listRemove(&t->link);
+	else
+		armedTimers++;
+
+	if (ticks == 0)
+		ticks = 1;
+
+	t->expires = twNow + ticks;
+	t->period = period;
+	twPlace(t);
+
+	twLeave(primask);
+}
+
+/**
+ * @brief Stops a timer. Harmless if it is not armed.
+ */
+void twCancel(twTimer_t * t)
+{
+	uint32_t primask = twEnter();
+
+	if (t->link.next != &t->link)
+	{
+		listRemove(&t->link);
+		armedTimers--;
+	}
+
+	twLeave(primask);
+}
+
+/**
+ * @brief Whether a timer is waiting to expire
+ */
+uint8_t twIsArmed(const twTimer_t * t)
+{
+	return t->link.next != &t->link;
+}
+
+/**
+ * @brief Advances the wheel one tick and runs the callbacks due. Called by
+ * timer0() every 100 us, and nowhere else.
+ */
+void twTick(void)
+{
+	twLink_t * head;
+	uint8_t level;
+	uint32_t primask;
+
+	twNow++;
+
+	/* Each wrap of a level pulls the next slot down from the one above */
+	for (level = 1; level < TW_LEVELS; level++)
+	{
+		if ((twNow & ((1UL << (TW_SLOT_BITS * level)) - 1)) != 0)
+			break;
+		twCascade(level);
+	}
+
+	head = &wheel[0][twNow & (TW_SLOTS - 1)];
+
+	primask = twEnter();
+	while (head->next != head)
+	{
+		twTimer_t * t = (twTimer_t *)head->next;
+
+		listRemove(&t->link);
+
+		/* A parked long timer that has not arrived yet */
+		if (t->expires != twNow)
+		{
+			twPlace(t);
+			continue;
+		}
+
+		/* Periodic timers reload from their due tick so they never drift */
+		if (t->period != 0)
+		{
+			t->expires += t->period;
+			twPlace(t);
+		}
+		else
+			armedTimers--;
+
+		firedTimers++;
+
+		twLeave(primask);
+		t->callback(t->arg);
+		primask = twEnter();
+	}
+	twLeave(primask);
+}
+
+/**
+ * @brief Number of timers currently armed
+ */
+uint32_t twArmedCount(void)
+{
+	return armedTimers;
+}
+
+/**
+ * @brief Number of callbacks run since start up
+ */
+uint32_t twFiredCount(void)
+{
+	return firedTimers;
+}
+
+/**
+ * @brief Number of times a timer was moved to a finer wheel
+ */
+uint32_t twCascadedCount(void)
+{
+	return cascadedTimers;
+}
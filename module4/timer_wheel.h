@@ -0,0 +1,99 @@
+/**----------------------------------------------------------------------------
+ *
+ *            \file timer_wheel.h
+--                                                                           --
+--              ECEN 5803 Mastering Embedded System Architecture             --
+--                  Project 1 Module 4                                       --
+--                Microcontroller Firmware                                   --
+--                      timer_wheel.h                                        --
+--                                                                           --
+-------------------------------------------------------------------------------
+--
+--  Designed for:  University of Colorado at Boulder
+--
+--
+--  Designed by:  Tristan Lennertz, Subhradeep Dutta, & Omkar Prabhu
+--
+-- Version: 2.1
+-- Date of current revision:  2018-02
+-- Target Microcontroller: Freescale MKL25ZVMT4
+-- Tools used:  ARM mbed compiler
+--              ARM mbed SDK
+--              Freescale FRDM-KL25Z Freedom Board
+--
+--
+--   Functional Description:
+--   Software timers on a hierarchical timing wheel, advanced once per
+--   timer0 tick (100 us). Timers are caller owned structures linked into
+--   the wheel while armed, so any number can be armed; each one runs a
+--   callback from timer0 when it expires, once or periodically.
+--
+--   TW_LEVELS wheels of TW_SLOTS slots each cover 1 tick, TW_SLOTS ticks,
+--   TW_SLOTS^2 ticks, ... per slot. A timer sits in the finest wheel that
+--   can hold its remaining time and is moved down a level each time the
+--   coarser slot it is in comes round, so a tick only touches the timers
+--   expiring in it plus, once every TW_SLOTS ticks, one coarser slot.
+--
+*/
+
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#include <stdint.h>
+
+/**
+ * @brief Slots per wheel (a power of two) and the number of wheels. Four
+ * wheels of 64 slots reach 2^24 ticks, about 28 minutes.
+ */
+#define TW_SLOT_BITS (6)
+#define TW_SLOTS     (1 << TW_SLOT_BITS)
+#define TW_LEVELS    (4)
+
+/**
+ * @brief Longest delay the wheel holds directly, in ticks. Longer delays
+ * are parked at this distance and placed again when they reach it.
+ */
+#define TW_MAX_DELAY ((1UL << (TW_SLOT_BITS * TW_LEVELS)) - 1)
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief List links, first member of every timer and the head of every
+ * slot. Lists are circular; an unarmed timer points at itself.
+ */
+typedef struct twLink
+{
+	struct twLink * next;
+	struct twLink * prev;
+} twLink_t;
+
+/**
+ * @brief One software timer. Initialise with twTimerInit() and leave the
+ * fields to the wheel.
+ */
+typedef struct
+{
+	twLink_t link;              /* slot list membership, must be first */
+	uint32_t expires;           /* wheel tick it is due on */
+	uint32_t period;            /* reload in ticks, 0 for one shot */
+	void (*callback)(void * arg);
+	void * arg;
+} twTimer_t;
+
+void twInit(void);                                    /* empty the wheel */
+void twTimerInit(twTimer_t * t, void (*callback)(void *), void * arg);
+void twArm(twTimer_t * t, uint32_t ticks, uint32_t period);
+void twCancel(twTimer_t * t);
+uint8_t twIsArmed(const twTimer_t * t);
+void twTick(void);                                    /* from timer0 only */
+uint32_t twArmedCount(void);                          /* timers in the wheel */
+uint32_t twFiredCount(void);                          /* callbacks run */
+uint32_t twCascadedCount(void);                       /* moves to a finer wheel */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TIMER_WHEEL_H */
@@ -0,0 +1,162 @@
+/**----------------------------------------------------------------------------
+ *
+ *            \file trace.c
+--                                                                           --
+--              ECEN 5803 Mastering Embedded System Architecture             --
+--                  Project 1 Module 4                                       --
+--                Microcontroller Firmware                                   --
+--                      trace.c                                              --
+--                                                                           --
+-------------------------------------------------------------------------------
+--
+--  Designed for:  University of Colorado at Boulder
+--
+--
+--  Designed by:  Tristan Lennertz, Subhradeep Dutta, & Omkar Prabhu
+--
+-- Version: 2.1
+-- Date of current revision:  2018-02
+-- Target Microcontroller: Freescale MKL25ZVMT4
+-- Tools used:  ARM mbed compiler
+--              ARM mbed SDK
+--              Freescale FRDM-KL25Z Freedom Board
+--
+--
+--   Functional Description:
+--   Storage of the trace log and its dump frames (see trace.h). Recording
+--   itself is inline in trace.h; this file is only reached by start up and
+--   the monitor's dump, and by the host tools to unpack frames.
+--
+*/
+
+#include <stdint.h>
+
+#include "trace.h"
+#include "telemetry.h"
+
+#if TRACE_FRAME_MAX > TELEM_FRAME_LIMIT
+#error "TRACE_FRAME_RECORDS makes a frame longer than TELEM_FRAME_LIMIT"
+#endif
+
+traceLog_t traceLog;
+
+/**
+ * @brief Fills in the header; the ring starts empty. Call once the cycle
+ * counter runs and before the first TRACE().
+ */
+void traceInit(void)
+{
+	traceLog.magic = TRACE_MAGIC;
+	traceLog.version = TRACE_VERSION;
+	traceLog.capacity = TRACE_RECORDS;
+	traceLog.counterMask = CYCLE_COUNT_MASK;
+#if TRACE_ENABLE
+	traceLog.clockHz = SystemCoreClock;
+#endif
+	traceLog.head = 0;
+	traceLog.missed = 0;
+	traceLog.frozen = 0;
+}
+
+/**
+ * @brief While frozen, events are counted as missed instead of stored, so
+ * the ring holds still for a dump
+ */
+void traceFreeze(uint8_t freeze)
+{
+	traceLog.frozen = freeze;
+}
+
+uint16_t traceFrameInfo(uint32_t frozenStamp, uint64_t frozenUs, uint8_t * out)
+{
+	uint8_t raw[TRACE_INFO_LEN + 2];
+
+	raw[0] = TELEM_REC_TRACE_INFO;
+	raw[1] = TRACE_VERSION;
+	telemPut16(raw + 2, traceLog.capacity);
+	telemPut32(raw + 4, traceLog.counterMask);
+	telemPut32(raw + 8, traceLog.clockHz);
+	telemPut32(raw + 12, traceLog.head);
+	telemPut32(raw + 16, traceLog.missed);
+	telemPut32(raw + 20, frozenStamp);
+	telemPut32(raw + 24, (uint32_t)frozenUs);
+	telemPut32(raw + 28, (uint32_t)(frozenUs >> 32));
+
+	return telemFrame(raw, TRACE_INFO_LEN, out);
+}
+
+/**
+ * @brief Frames count records (at most TRACE_FRAME_RECORDS) starting at
+ * index first. The ring should be frozen.
+ */
+uint16_t traceFrameRecords(uint32_t first, uint8_t count, uint8_t * out)
+{
+	uint8_t raw[TRACE_RECORDS_LEN + 2];
+	uint8_t * p = raw + 6;
+	const traceRec_t * rec;
+	uint8_t i;
+
+	if (count > TRACE_FRAME_RECORDS)
+		count = TRACE_FRAME_RECORDS;
+
+	raw[0] = TELEM_REC_TRACE;
+	raw[1] = count;
+	telemPut32(raw + 2, first);
+
+	for (i = 0; i < count; i++, p += TRACE_REC_LEN)
+	{
+		rec = &traceLog.rec[(first + i) & (TRACE_RECORDS - 1)];
+		telemPut32(p, rec->stamp);
+		telemPut16(p + 4, rec->id);
+		telemPut16(p + 6, rec->arg16);
+		telemPut32(p + 8, rec->arg32);
+	}
+
+	return telemFrame(raw, (uint16_t)(p - raw), out);
+}
+
+uint8_t traceUnpackInfo(const uint8_t * payload, uint16_t len, traceInfo_t * info)
+{
+	if (len != TRACE_INFO_LEN || payload[0] != TELEM_REC_TRACE_INFO ||
+	    payload[1] != TRACE_VERSION)
+		return 0;
+
+	info->capacity = telemGet16(payload + 2);
+	info->counterMask = telemGet32(payload + 4);
+	info->clockHz = telemGet32(payload + 8);
+	info->head = telemGet32(payload + 12);
+	info->missed = telemGet32(payload + 16);
+	info->frozenStamp = telemGet32(payload + 20);
+	info->frozenUs = telemGet32(payload + 24) | ((uint64_t)telemGet32(payload + 28) << 32);
+
+	return 1;
+}
+
+/**
+ * @return Records unpacked, 0 if payload is not a trace records payload
+ */
+uint8_t traceUnpackRecords(const uint8_t * payload, uint16_t len, uint32_t * first,
+                           traceRec_t recs[TRACE_FRAME_RECORDS])
+{
+	const uint8_t * p = payload + 6;
+	uint8_t count;
+	uint8_t i;
+
+	if (len < 6 || payload[0] != TELEM_REC_TRACE)
+		return 0;
+
+	count = payload[1];
+	if (count == 0 || count > TRACE_FRAME_RECORDS || len != 6 + count * TRACE_REC_LEN)
+		return 0;
+
+	*first = telemGet32(payload + 2);
+	for (i = 0; i < count; i++, p += TRACE_REC_LEN)
+	{
+		recs[i].stamp = telemGet32(p);
+		recs[i].id = telemGet16(p + 4);
+		recs[i].arg16 = telemGet16(p + 6);
+		recs[i].arg32 = telemGet32(p + 8);
+	}
+
+	return count;
+}
@@ -0,0 +1,243 @@
+/**----------------------------------------------------------------------------
+ *
+ *            \file trace.h
+--                                                                           --
+--              ECEN 5803 Mastering Embedded System Architecture             --
+--                  Project 1 Module 4                                       --
+--                Microcontroller Firmware                                   --
+--                      trace.h                                              --
+--                                                                           --
+-------------------------------------------------------------------------------
+--
+--  Designed for:  University of Colorado at Boulder
+--
+--
+--  Designed by:  Tristan Lennertz, Subhradeep Dutta, & Omkar Prabhu
+--
+-- Version: 2.1
+-- Date of current revision:  2018-02
+-- Target Microcontroller: Freescale MKL25ZVMT4
+-- Tools used:  ARM mbed compiler
+--              ARM mbed SDK
+--              Freescale FRDM-KL25Z Freedom Board
+--
+--
+--   Functional Description:
+--   Binary trace log with the formatting deferred to the host. TRACE()
+--   stores an event id from trace_ids.h, two raw arguments and the cycle
+--   counter in a RAM ring, with interrupts masked for the few stores that
+--   takes, so it is safe from timer0(), other interrupts and the main loop
+--   alike. No text is built on the board; host/trace_decode turns the
+--   records back into readable lines with the format strings of
+--   trace_ids.h.
+--
+--   The ring keeps the newest TRACE_RECORDS events, overwriting the
+--   oldest. It gets off the board two ways:
+--     - monitor command L freezes it and sends it as frames in the
+--       telemetry framing (telemetry.h), record types TELEM_REC_TRACE_INFO
+--       then TELEM_REC_TRACE; events while frozen are counted as missed
+--     - a debugger dump of RAM holding traceLog, which starts with
+--       TRACE_MAGIC so the host can find it in a larger dump
+--
+--   Stamps are the raw cycle counter (cycle_count.h), which on the board
+--   wraps every 2^24 cycles, 349 ms. The host unwraps them from record to
+--   record; timer0 leaves a record every tick, so consecutive records are
+--   never a wrap apart. SysTick stops with the core clock in sleep, so the
+--   stamps leave out the time asleep; each TRACE_IDLE record carries the
+--   microseconds slept after its stamp (idle.c), and the host adds them
+--   back to put the sleeps on the timeline.
+--
+--   Trace info payload, TRACE_INFO_LEN bytes, little endian:
+--     0  uint8   record type, TELEM_REC_TRACE_INFO
+--     1  uint8   TRACE_VERSION
+--     2  uint16  ring capacity, records
+--     4  uint32  cycle counter mask (CYCLE_COUNT_MASK)
+--     8  uint32  cycle counter clock, Hz
+--    12  uint32  records written since start up (index after the newest)
+--    16  uint32  events missed while frozen
+--    20  uint32  cycle counter when frozen
+--    24  uint64  microseconds since start up when frozen (timebase.h)
+--
+--   Trace records payload, 6 + 12 per record:
+--     0  uint8   record type, TELEM_REC_TRACE
+--     1  uint8   records in this frame, 1 to TRACE_FRAME_RECORDS
+--     2  uint32  index of the first (records written before it)
+--     6  records of
+--          uint32  cycle counter
+--          uint16  id
+--          uint16  arg16
+--          uint32  arg32
+--
+*/
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdint.h>
+
+#include "cycle_count.h"
+#include "trace_ids.h"
+
+/**
+ * @brief Tracing is compiled in on the board and in the executive
+ * simulation. Plain host builds (freq_replay, the benchmarks) leave it
+ * out so their measurements are of the algorithms alone.
+ */
+#ifndef TRACE_ENABLE
+#if defined(TARGET_KL25Z) || defined(HOST_SIM)
+#define TRACE_ENABLE (1)
+#else
+#define TRACE_ENABLE (0)
+#endif
+#endif
+
+#if TRACE_ENABLE
+#include "cmsis.h"
+#endif
+
+/**
+ * @brief Ring capacity in records, a power of two. 3 KB of RAM. Every
+ * 100 us tick leaves timer0's record and the sleep's after the pass it
+ * wakes; the loop stages are only recorded on passes that had work
+ * (main.cpp), four records more on an ADC block pass. With the port
+ * quiet that is about 130 records per 6.4 ms block, so the ring holds
+ * the last 12 ms, the latest one or two blocks; serial traffic, which
+ * makes more passes busy, shortens it.
+ */
+#ifndef TRACE_RECORDS
+#define TRACE_RECORDS (256)
+#endif
+
+#if (TRACE_RECORDS & (TRACE_RECORDS - 1)) != 0 || TRACE_RECORDS > 65535
+#error "TRACE_RECORDS must be a power of two below 65536"
+#endif
+
+/**
+ * @brief "TRC1" in memory, the start of traceLog
+ */
+#define TRACE_MAGIC   (0x31435254UL)
+#define TRACE_VERSION (1)
+
+/**
+ * @brief Wire sizes. A records frame holds TRACE_FRAME_RECORDS so that
+ * the whole frame, TRACE_FRAME_MAX bytes, fits the transmit ring.
+ */
+#define TRACE_REC_LEN       (12)
+#define TRACE_INFO_LEN      (32)
+#define TRACE_FRAME_RECORDS (8)
+#define TRACE_RECORDS_LEN   (6 + TRACE_FRAME_RECORDS * TRACE_REC_LEN)
+#define TRACE_FRAME_MAX     (TRACE_RECORDS_LEN + 2 + 1 + 1)
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Event ids, from trace_ids.h
+ */
+#define TRACE_ENUM(id, format) id,
+enum traceId
+{
+	TRACE_EVENTS(TRACE_ENUM)
+	TRACE_ID_COUNT
+};
+#undef TRACE_ENUM
+
+/**
+ * @brief One event
+ */
+typedef struct
+{
+	uint32_t stamp;        /* cycle counter */
+	uint16_t id;           /* TRACE_ id */
+	uint16_t arg16;
+	uint32_t arg32;
+} traceRec_t;
+
+/**
+ * @brief The log as it sits in RAM, header first so a dump describes itself
+ */
+typedef struct
+{
+	uint32_t magic;              /* TRACE_MAGIC */
+	uint16_t version;            /* TRACE_VERSION */
+	uint16_t capacity;           /* TRACE_RECORDS */
+	uint32_t counterMask;        /* CYCLE_COUNT_MASK */
+	uint32_t clockHz;            /* cycle counter clock */
+	volatile uint32_t head;      /* records written, the next goes to head % capacity */
+	volatile uint32_t missed;    /* events dropped while frozen */
+	volatile uint8_t frozen;     /* set while a dump is reading the ring */
+	traceRec_t rec[TRACE_RECORDS];
+} traceLog_t;
+
+extern traceLog_t traceLog;
+
+/**
+ * @brief Unpacked trace info payload
+ */
+typedef struct
+{
+	uint16_t capacity;
+	uint32_t counterMask;
+	uint32_t clockHz;
+	uint32_t head;
+	uint32_t missed;
+	uint32_t frozenStamp;
+	uint64_t frozenUs;
+} traceInfo_t;
+
+void traceInit(void);
+void traceFreeze(uint8_t freeze);
+
+/* Dump frames, built from the frozen ring. frame needs TRACE_FRAME_MAX bytes. */
+uint16_t traceFrameInfo(uint32_t frozenStamp, uint64_t frozenUs, uint8_t * frame);
+uint16_t traceFrameRecords(uint32_t first, uint8_t count, uint8_t * frame);
+
+/* Payloads back to records, for the host. 0 if payload is not of the type. */
+uint8_t traceUnpackInfo(const uint8_t * payload, uint16_t len, traceInfo_t * info);
+uint8_t traceUnpackRecords(const uint8_t * payload, uint16_t len, uint32_t * first,
+                           traceRec_t recs[TRACE_FRAME_RECORDS]);
+
+#if TRACE_ENABLE
+
+/**
+ * @brief Records an event stamped at a cycle count taken earlier, so a
+ * section can be logged once at its end with its start time
+ */
+static __inline void traceAt(uint32_t stamp, uint16_t id, uint16_t arg16, uint32_t arg32)
+{
+	uint32_t primask = __get_PRIMASK();
+	traceRec_t * rec;
+
+	__disable_irq();
+	if (traceLog.frozen)
+		traceLog.missed++;
+	else
+	{
+		rec = &traceLog.rec[traceLog.head & (TRACE_RECORDS - 1)];
+		rec->stamp = stamp;
+		rec->id = id;
+		rec->arg16 = arg16;
+		rec->arg32 = arg32;
+		traceLog.head++;
+	}
+	__set_PRIMASK(primask);
+}
+
+#define TRACE(id, arg16, arg32) \
+	traceAt(cycleCountRead(), (uint16_t)(id), (uint16_t)(arg16), (uint32_t)(arg32))
+#define TRACE_AT(stamp, id, arg16, arg32) \
+	traceAt((stamp), (uint16_t)(id), (uint16_t)(arg16), (uint32_t)(arg32))
+
+#else
+
+#define TRACE(id, arg16, arg32) ((void)0)
+#define TRACE_AT(stamp, id, arg16, arg32) ((void)0)
+
+#endif /* TRACE_ENABLE */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TRACE_H */
@@ -0,0 +1,54 @@
+/**----------------------------------------------------------------------------
+ *
+ *            \file trace_ids.h
+--                                                                           --
+--              ECEN 5803 Mastering Embedded System Architecture             --
+--                  Project 1 Module 4                                       --
+--                Microcontroller Firmware                                   --
+--                      trace_ids.h                                          --
+--                                                                           --
+-------------------------------------------------------------------------------
+--
+--  Designed for:  University of Colorado at Boulder
+--
+--
+--  Designed by:  Tristan Lennertz, Subhradeep Dutta, & Omkar Prabhu
+--
+-- Version: 2.1
+-- Date of current revision:  2018-02
+-- Target Microcontroller: Freescale MKL25ZVMT4
+-- Tools used:  ARM mbed compiler
+--              ARM mbed SDK
+--              Freescale FRDM-KL25Z Freedom Board
+--
+--
+--   Functional Description:
+--   The trace events (see trace.h), each with the text the host prints
+--   for it. The firmware expands this list to the TRACE_ ids only, so the
+--   strings never reach its flash; host/trace_decoder.cpp expands it to
+--   its dictionary, so ids and formats cannot drift apart.
+--
+--   The format takes the record's two arguments in order, arg16 then
+--   arg32, with printf conversions for unsigned values (%u, %X...).
+--   Add new events at the end: a dump decodes with the dictionary it was
+--   built with.
+--
+*/
+
+#ifndef TRACE_IDS_H
+#define TRACE_IDS_H
+
+/*   X(id,                   format) */
+#define TRACE_EVENTS(X) \
+	X(TRACE_TIMER0,           "timer0 state %u, %u cycles") \
+	X(TRACE_TASK_OVERRUN,     "task %u over budget, %u cycles") \
+	X(TRACE_FREQ_PEAK,        "peak after %u samples, level %u") \
+	X(TRACE_FREQ_RESET,       "frequency pipeline reset") \
+	X(TRACE_FREQ_PROMINENCE,  "peak prominence %u counts") \
+	X(TRACE_STAGE,            "loop stage %u, %u cycles") \
+	X(TRACE_IDLE,             "idle %u, slept %u us") \
+	X(TRACE_UART_TX_START,    "tx burst of %u bytes, burst %u") \
+	X(TRACE_UART_TX_DONE,     "tx burst of %u bytes done, status 0x%X") \
+	X(TRACE_UART_RX,          "rx byte 0x%02X, %u in rx ring")
+
+#endif /* TRACE_IDS_H */
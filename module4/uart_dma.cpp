@@ -0,0 +1,255 @@
+/**----------------------------------------------------------------------------
+ *
+ *            \file uart_dma.cpp
+--                                                                           --
+--              ECEN 5803 Mastering Embedded System Architecture             --
+--                  Project 1 Module 4                                       --
+--                Microcontroller Firmware                                   --
+--                      uart_dma.cpp                                         --
+--                                                                           --
+-------------------------------------------------------------------------------
+--
+--  Designed for:  University of Colorado at Boulder
+--
+--
+--  Designed by:  Tristan Lennertz, Subhradeep Dutta, & Omkar Prabhu
+--
+-- Version: 2.1
+-- Date of current revision:  2018-02
+-- Target Microcontroller: Freescale MKL25ZVMT4
+-- Tools used:  ARM mbed compiler
+--              ARM mbed SDK
+--              Freescale FRDM-KL25Z Freedom Board
+--
+--
+--   Functional Description:
+--   Interrupt driven receive and DMA driven transmit for UART0.
+--
+--   Receive: RIE raises the UART0 interrupt for every byte, which goes
+--   straight into rx_ring. Overrun, framing, noise and parity errors are
+--   cleared there and counted in error_count as serial() used to. A byte
+--   that finds rx_ring full is dropped and counted, rather than overwriting
+--   input the main loop has not read yet.
+--
+--   Transmit: with TIE and TDMAE both set, TDRE is a DMA request (UART0
+--   transmit is DMAMUX source 3) instead of an interrupt. A burst is the
+--   contiguous run of unsent bytes at the tail of tx_ring (its readSpan);
+--   DMA channel 1 feeds it to the data register a byte per TDRE and drops
+--   its request when done (D_REQ). The channel interrupt then consumes the
+--   burst from the ring and starts the next one, if any.
+--
+--   Only the main loop and the channel interrupt start bursts, and the
+--   interrupt only runs while one is in progress, so neither needs to mask
+--   interrupts to decide whether to start one.
+--
+--   UART_direct_msg_put() bypasses the buffer, for fault reports. It lets
+--   the buffered output drain and holds off new bursts until it is done,
+--   so the two never interleave on the wire and come out in the order they
+--   were written.
+--
+--   The start and end of each burst and every byte received leave a trace
+--   record (trace.h), so a trace shows the port's activity against the
+--   loop and the tick.
+--
+*/
+
+#include "mbed.h"
+#include "shared.h"
+#include "uart_dma.h"
+
+/**
+ * @brief DMAMUX request source number of UART0 transmit
+ */
+#define DMAMUX_SOURCE_UART0_TX (3)
+
+/**
+ * @brief DMA channel used for transmit; channel 0 belongs to adc_dma.cpp
+ */
+#define UART_DMA_CHANNEL (1)
+
+/**
+ * @brief UART0 receive errors. All four are cleared by writing them back.
+ */
+#define UART_RX_ERRORS (UARTLP_S1_OR_MASK | UARTLP_S1_NF_MASK | \
+                        UARTLP_S1_FE_MASK | UARTLP_S1_PF_MASK)
+
+/**
+ * @brief Bytes in the burst DMA is sending, 0 when idle. Set by
+ * UART_dma_kick(), cleared by the channel interrupt.
+ */
+static volatile uint32_t txBurst = 0;
+
+/**
+ * @brief Set while direct output owns the data register
+ */
+static volatile uint8_t txHold = 0;
+
+static uint32_t burstCount = 0;
+
+/**
+ * @brief UART0 interrupt: one received byte, or a receive error
+ */
+static void UART_dma_rx_isr(void)
+{
+	uint8_t status = UART0->S1;
+	UCHAR c;
+
+	if (status & UART_RX_ERRORS)
+	{
+		error_count++;
+		UART0->S1 = status & UART_RX_ERRORS;
+	}
+
+	if (status & UARTLP_S1_RDRF_MASK)
+	{
+		c = UART0->D;             /* reading D clears RDRF */
+
+		if (status & UARTLP_S1_FE_MASK)
+			return;                 /* garbled, already counted */
+
+		rx_ring.push(c);          /* dropped and counted if the loop is behind */
+		TRACE(TRACE_UART_RX, c, rx_ring.size());
+	}
+}
+
+/**
+ * @brief DMA channel 1 interrupt, once per completed burst (or on error)
+ */
+static void UART_dma_tx_isr(void)
+{
+	uint32_t status = DMA0->DMA[UART_DMA_CHANNEL].DSR_BCR;
+
+	/* Writing DONE clears it along with the error flags */
+	DMA0->DMA[UART_DMA_CHANNEL].DSR_BCR = DMA_DSR_BCR_DONE_MASK;
+
+	/* A failed burst is not retried; its bytes are lost like an overrun */
+	if (status & (DMA_DSR_BCR_CE_MASK | DMA_DSR_BCR_BES_MASK | DMA_DSR_BCR_BED_MASK))
+		error_count++;
+	TRACE(TRACE_UART_TX_DONE, txBurst,
+	      status & (DMA_DSR_BCR_CE_MASK | DMA_DSR_BCR_BES_MASK | DMA_DSR_BCR_BED_MASK));
+
+	tx_ring.consume(txBurst);
+	txBurst = 0;
+	tx_in_progress = NO;
+
+	UART_dma_kick();
+}
+
+/**
+ * @brief Enables the receive interrupt and sets DMA channel 1 up for
+ * transmit. The Serial object must already have set the baud rate, and
+ * the buffer pointers must be initialised.
+ */
+void UART_dma_init(void)
+{
+	SIM->SCGC6 |= SIM_SCGC6_DMAMUX_MASK;
+	SIM->SCGC7 |= SIM_SCGC7_DMA_MASK;
+
+	/* Stop anything left running */
+	DMAMUX0->CHCFG[UART_DMA_CHANNEL] = 0;
+	DMA0->DMA[UART_DMA_CHANNEL].DSR_BCR = DMA_DSR_BCR_DONE_MASK;
+	txBurst = 0;
+	txHold = 0;
+
+	/* Bytes from tx_ring to the data register, one per request; ERQ is set
+	 * per burst and cleared by the hardware at the end of it */
+	DMA0->DMA[UART_DMA_CHANNEL].DAR = (uint32_t)&UART0->D;
+	DMA0->DMA[UART_DMA_CHANNEL].DCR = DMA_DCR_EINT_MASK | DMA_DCR_CS_MASK | DMA_DCR_D_REQ_MASK |
+	                                  DMA_DCR_SINC_MASK | DMA_DCR_SSIZE(1) | DMA_DCR_DSIZE(1);
+
+	/* Below the ADC block swap, which has a sample period to finish in */
+	NVIC_SetVector(DMA1_IRQn, (uint32_t)&UART_dma_tx_isr);
+	NVIC_SetPriority(DMA1_IRQn, 1);
+	NVIC_EnableIRQ(DMA1_IRQn);
+
+	NVIC_SetVector(UART0_IRQn, (uint32_t)&UART_dma_rx_isr);
+	NVIC_SetPriority(UART0_IRQn, 1);
+	NVIC_EnableIRQ(UART0_IRQn);
+
+	DMAMUX0->CHCFG[UART_DMA_CHANNEL] = DMAMUX_CHCFG_ENBL_MASK |
+	                                   DMAMUX_CHCFG_SOURCE(DMAMUX_SOURCE_UART0_TX);
+
+	UART0->C5 |= UARTLP_C5_TDMAE_MASK;
+	UART0->C2 |= UARTLP_C2_TIE_MASK | UARTLP_C2_RIE_MASK;
+}
+
+/**
+ * @brief Starts a burst with the unsent output, unless one is already
+ * running or direct output holds the port. Called
+ * after anything is queued, and from the channel interrupt.
+ */
+void UART_dma_kick(void)
+{
+	const UCHAR * span;
+	uint16_t count;
+
+	if (txBurst != 0 || txHold)
+		return;
+
+	/* Up to the newest byte, or to the end of the storage if it has wrapped */
+	count = tx_ring.readSpan(&span);
+	if (count == 0)
+		return;
+
+	/* txBurst first: the channel interrupt must see it */
+	txBurst = count;
+	DMA0->DMA[UART_DMA_CHANNEL].SAR = (uint32_t)span;
+	DMA0->DMA[UART_DMA_CHANNEL].DSR_BCR = DMA_DSR_BCR_BCR(count);
+	DMA0->DMA[UART_DMA_CHANNEL].DCR |= DMA_DCR_ERQ_MASK;
+
+	burstCount++;
+	tx_in_progress = YES;
+	TRACE(TRACE_UART_TX_START, count, burstCount);
+}
+
+/**
+ * @brief Whether DMA is still sending a burst. Reads the channel itself,
+ * so it is right even with interrupts masked.
+ */
+uint8_t UART_dma_busy(void)
+{
+	return (txBurst != 0) &&
+	       !(DMA0->DMA[UART_DMA_CHANNEL].DSR_BCR & DMA_DSR_BCR_DONE_MASK);
+}
+
+/**
+ * @brief Waits until everything buffered has been sent. With interrupts
+ * masked (a fault report) the channel interrupt cannot start the next
+ * burst, so then it only waits out the burst in progress.
+ */
+void UART_dma_flush(void)
+{
+	if (__get_PRIMASK())
+	{
+		while (UART_dma_busy())
+			;
+		return;
+	}
+
+	do
+	{
+		UART_dma_kick();
+	} while (txBurst != 0);
+}
+
+/**
+ * @brief While held no new burst starts. Releasing sends anything queued
+ * in the meantime.
+ */
+void UART_dma_hold(uint8_t hold)
+{
+	txHold = hold;
+
+	if (!hold)
+		UART_dma_kick();
+}
+
+uint32_t UART_dma_bursts(void)
+{
+	return burstCount;
+}
+
+uint32_t UART_dma_rx_dropped(void)
+{
+	return rx_ring.dropped();
+}